@@ -0,0 +1,210 @@
+/*
+ * *****************************************************************************
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2018-2024 Gavin D. Howard and contributors.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *****************************************************************************
+ *
+ * A benchmark for contexts with arenas in bcl(3). It runs request-like
+ * batches of work, each of which creates many numbers and then drops them all
+ * with bcl_ctxt_freeNums(), in a regular context and in one with an arena.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <bcl.h>
+
+/// The number of requests.
+#define ARENA_REQUESTS (2048)
+
+/// The number of line items in each request.
+#define ARENA_ITEMS (256)
+
+/**
+ * Takes an error code and aborts if it actually is an error.
+ * @param e  The error code.
+ */
+static void
+err(BclError e)
+{
+	if (e != BCL_ERROR_NONE) abort();
+}
+
+/**
+ * Returns the current time in seconds.
+ * @return  The current time in seconds.
+ */
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double) ts.tv_sec + (double) ts.tv_nsec / 1000000000.0;
+}
+
+/**
+ * Compares two doubles for qsort().
+ * @param a  The first double.
+ * @param b  The second double.
+ * @return   Less than, equal to, or greater than 0 if @a a is less than, equal
+ *           to, or greater than @a b, respectively.
+ */
+static int
+cmp(const void* a, const void* b)
+{
+	double x = *((const double*) a);
+	double y = *((const double*) b);
+
+	return (x > y) - (x < y);
+}
+
+/**
+ * Runs one request: it totals line items with tax, creating a few numbers per
+ * item without freeing any of them, and then frees them all at once.
+ * @param ctxt  The context.
+ * @param r     The number of the request.
+ * @param buf   The buffer for the total of the request. It must be at least 64
+ *              bytes.
+ */
+static void
+request(BclContext ctxt, size_t r, char* buf)
+{
+	BclNumber total, tax, price, qty, line;
+	size_t i;
+	char str[64];
+
+	tax = bcl_parse("1.0825");
+	err(bcl_err(tax));
+
+	total = bcl_num_create();
+	err(bcl_err(total));
+
+	for (i = 0; i < ARENA_ITEMS; ++i)
+	{
+		snprintf(str, sizeof(str), "%zu.%02zu", (r * 31 + i * 7919) % 10000,
+		         (r + i) % 100);
+		price = bcl_parse(str);
+		err(bcl_err(price));
+
+		qty = bcl_bigdig2num((BclBigDig) (i % 12 + 1));
+		err(bcl_err(qty));
+
+		line = bcl_mul_keep(bcl_mul_keep(price, qty), tax);
+		err(bcl_err(line));
+
+		total = bcl_add_keep(total, line);
+		err(bcl_err(total));
+	}
+
+	err(bcl_string_into(total, buf, 64, NULL));
+
+	bcl_ctxt_freeNums(ctxt);
+}
+
+/**
+ * Runs all of the requests in a context and prints the latencies.
+ * @param name    The name of the benchmark.
+ * @param ctxt    The context.
+ * @param totals  An array of buffers for the totals, one per request.
+ */
+static void
+run(const char* name, BclContext ctxt, char (*totals)[64])
+{
+	double* times;
+	double start, sum = 0;
+	size_t r;
+
+	times = malloc(ARENA_REQUESTS * sizeof(double));
+	if (times == NULL) err(BCL_ERROR_FATAL_ALLOC_ERR);
+
+	err(bcl_pushContext(ctxt));
+	bcl_ctxt_setScale(ctxt, 4);
+
+	for (r = 0; r < ARENA_REQUESTS; ++r)
+	{
+		start = now();
+		request(ctxt, r, totals[r]);
+		times[r] = now() - start;
+		sum += times[r];
+	}
+
+	bcl_popContext();
+
+	qsort(times, ARENA_REQUESTS, sizeof(double), cmp);
+
+	printf("%-8s mean %8.2f us  p50 %8.2f us  p99 %8.2f us\n", name,
+	       sum * 1e6 / ARENA_REQUESTS, times[ARENA_REQUESTS / 2] * 1e6,
+	       times[ARENA_REQUESTS * 99 / 100] * 1e6);
+
+	free(times);
+}
+
+int
+main(void)
+{
+	BclContext ctxt, arena;
+	char (*totals1)[64];
+	char (*totals2)[64];
+
+	err(bcl_start());
+	err(bcl_init());
+
+	ctxt = bcl_ctxt_create();
+	if (ctxt == NULL) err(BCL_ERROR_FATAL_ALLOC_ERR);
+
+	arena = bcl_ctxt_create_arena(0);
+	if (arena == NULL) err(BCL_ERROR_FATAL_ALLOC_ERR);
+
+	totals1 = malloc(ARENA_REQUESTS * sizeof(*totals1));
+	totals2 = malloc(ARENA_REQUESTS * sizeof(*totals2));
+	if (totals1 == NULL || totals2 == NULL) err(BCL_ERROR_FATAL_ALLOC_ERR);
+
+	run("regular", ctxt, totals1);
+	run("arena", arena, totals2);
+
+	if (memcmp(totals1, totals2, ARENA_REQUESTS * sizeof(*totals1)))
+	{
+		err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	}
+
+	free(totals1);
+	free(totals2);
+
+	bcl_ctxt_free(ctxt);
+	bcl_ctxt_free(arena);
+
+	bcl_free();
+	bcl_end();
+
+	return 0;
+}
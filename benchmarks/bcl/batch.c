@@ -0,0 +1,275 @@
+/*
+ * *****************************************************************************
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2018-2024 Gavin D. Howard and contributors.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *****************************************************************************
+ *
+ * A benchmark for the batch functions in bcl(3). It compares them against
+ * doing the same operations one call at a time.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <bcl.h>
+
+/// The number of elements in each array.
+#define BATCH_LEN (4096)
+
+/// The number of times each operation is done over the arrays.
+#define BATCH_ROUNDS (64)
+
+/**
+ * Takes an error code and aborts if it actually is an error.
+ * @param e  The error code.
+ */
+static void
+err(BclError e)
+{
+	if (e != BCL_ERROR_NONE) abort();
+}
+
+/**
+ * Returns the current time in seconds.
+ * @return  The current time in seconds.
+ */
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double) ts.tv_sec + (double) ts.tv_nsec / 1000000000.0;
+}
+
+/**
+ * Prints the result of one benchmark.
+ * @param name   The name of the benchmark.
+ * @param start  The start time.
+ */
+static void
+report(const char* name, double start)
+{
+	double secs = now() - start;
+	double ops = (double) BATCH_LEN * BATCH_ROUNDS;
+
+	printf("%-24s %10.6f s  %8.1f ns/op\n", name, secs, secs * 1e9 / ops);
+}
+
+/**
+ * Checks that two numbers are equal, and aborts if they are not.
+ * @param a  The first number.
+ * @param b  The second number.
+ */
+static void
+check(BclNumber a, BclNumber b)
+{
+	if (bcl_cmp(a, b)) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+}
+
+int
+main(void)
+{
+	BclContext ctxt;
+	BclNumber* a;
+	BclNumber* b;
+	BclNumber* d;
+	BclNumber s, r, r2;
+	char buf[64];
+	size_t i, j;
+	double start;
+
+	err(bcl_start());
+	err(bcl_init());
+
+	ctxt = bcl_ctxt_create();
+	err(bcl_pushContext(ctxt));
+	bcl_ctxt_setScale(ctxt, 10);
+
+	a = malloc(BATCH_LEN * sizeof(BclNumber));
+	b = malloc(BATCH_LEN * sizeof(BclNumber));
+	d = malloc(BATCH_LEN * sizeof(BclNumber));
+	if (a == NULL || b == NULL || d == NULL) err(BCL_ERROR_FATAL_ALLOC_ERR);
+
+	for (i = 0; i < BATCH_LEN; ++i)
+	{
+		snprintf(buf, sizeof(buf), "%zu.%03zu", i * 7919 % 100000, i % 1000);
+		a[i] = bcl_parse(buf);
+		err(bcl_err(a[i]));
+
+		snprintf(buf, sizeof(buf), "-%zu.%02zu", i * 104729 % 1000, i % 100);
+		b[i] = bcl_parse(buf);
+		err(bcl_err(b[i]));
+
+		d[i] = bcl_num_create();
+		err(bcl_err(d[i]));
+	}
+
+	s = bcl_parse("1.0001");
+	err(bcl_err(s));
+
+	// Addition, one call at a time, making a new number every time.
+	start = now();
+
+	for (j = 0; j < BATCH_ROUNDS; ++j)
+	{
+		for (i = 0; i < BATCH_LEN; ++i)
+		{
+			r = bcl_add_keep(a[i], b[i]);
+			err(bcl_err(r));
+			bcl_num_free(r);
+		}
+	}
+
+	report("add_keep loop", start);
+
+	// Addition, one call at a time, into existing numbers.
+	start = now();
+
+	for (j = 0; j < BATCH_ROUNDS; ++j)
+	{
+		for (i = 0; i < BATCH_LEN; ++i)
+		{
+			err(bcl_add_into(d[i], a[i], b[i]));
+		}
+	}
+
+	report("add_into loop", start);
+
+	// Addition, all in one call.
+	start = now();
+
+	for (j = 0; j < BATCH_ROUNDS; ++j)
+	{
+		err(bcl_add_n(d, a, b, BATCH_LEN));
+	}
+
+	report("add_n", start);
+
+	// Multiplication by a scalar, one call at a time.
+	start = now();
+
+	for (j = 0; j < BATCH_ROUNDS; ++j)
+	{
+		for (i = 0; i < BATCH_LEN; ++i)
+		{
+			err(bcl_mul_into(d[i], a[i], s));
+		}
+	}
+
+	report("mul_into loop", start);
+
+	// Multiplication by a scalar, all in one call.
+	start = now();
+
+	for (j = 0; j < BATCH_ROUNDS; ++j)
+	{
+		err(bcl_mul_scalar_n(d, a, s, BATCH_LEN));
+	}
+
+	report("mul_scalar_n", start);
+
+	// Summing, one call at a time.
+	r = bcl_num_create();
+	err(bcl_err(r));
+
+	start = now();
+
+	for (j = 0; j < BATCH_ROUNDS; ++j)
+	{
+		bcl_zero(r);
+
+		for (i = 0; i < BATCH_LEN; ++i)
+		{
+			err(bcl_add_into(r, r, a[i]));
+		}
+	}
+
+	report("add_into sum loop", start);
+
+	// Summing, all in one call.
+	start = now();
+
+	for (j = 0; j < BATCH_ROUNDS; ++j)
+	{
+		r2 = bcl_sum(a, BATCH_LEN);
+		err(bcl_err(r2));
+		if (j + 1 < BATCH_ROUNDS) bcl_num_free(r2);
+	}
+
+	report("sum", start);
+
+	check(r, r2);
+	bcl_num_free(r2);
+
+	// The dot product, one call at a time.
+	start = now();
+
+	for (j = 0; j < BATCH_ROUNDS; ++j)
+	{
+		bcl_zero(r);
+
+		for (i = 0; i < BATCH_LEN; ++i)
+		{
+			err(bcl_mul_into(d[i], a[i], b[i]));
+			err(bcl_add_into(r, r, d[i]));
+		}
+	}
+
+	report("mul/add_into dot loop", start);
+
+	// The dot product, all in one call.
+	start = now();
+
+	for (j = 0; j < BATCH_ROUNDS; ++j)
+	{
+		r2 = bcl_dot(a, b, BATCH_LEN);
+		err(bcl_err(r2));
+		if (j + 1 < BATCH_ROUNDS) bcl_num_free(r2);
+	}
+
+	report("dot", start);
+
+	check(r, r2);
+
+	free(a);
+	free(b);
+	free(d);
+
+	bcl_popContext();
+	bcl_ctxt_free(ctxt);
+
+	bcl_free();
+	bcl_end();
+
+	return 0;
+}
@@ -0,0 +1,214 @@
+/*
+ * *****************************************************************************
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2018-2024 Gavin D. Howard and contributors.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *****************************************************************************
+ *
+ * A benchmark for the fixed-scale mode of bcl(3). It runs a ledger-like
+ * workload at scale 8, with and without the mode, and checks that the results
+ * are the same.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <bcl.h>
+
+/// The number of amounts.
+#define FIXED_LEN (4096)
+
+/// The number of times each operation is done over the amounts.
+#define FIXED_ROUNDS (64)
+
+/**
+ * Takes an error code and aborts if it actually is an error.
+ * @param e  The error code.
+ */
+static void
+err(BclError e)
+{
+	if (e != BCL_ERROR_NONE) abort();
+}
+
+/**
+ * Returns the current time in seconds.
+ * @return  The current time in seconds.
+ */
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double) ts.tv_sec + (double) ts.tv_nsec / 1000000000.0;
+}
+
+/**
+ * Prints the result of one benchmark.
+ * @param name   The name of the benchmark.
+ * @param fixed  Whether the fixed-scale mode was on.
+ * @param start  The start time.
+ */
+static void
+report(const char* name, bool fixed, double start)
+{
+	double secs = now() - start;
+	double ops = (double) FIXED_LEN * FIXED_ROUNDS;
+
+	printf("%-10s %-8s %10.6f s  %8.1f ns/op\n", name,
+	       fixed ? "fixed" : "regular", secs, secs * 1e9 / ops);
+}
+
+/**
+ * Runs the workload once.
+ * @param ctxt   The context.
+ * @param fixed  Whether to turn on the fixed-scale mode.
+ * @param a      The amounts.
+ * @param rate   The rate to multiply the amounts by.
+ * @param d      The destinations.
+ * @return       The total of the last round, as a string.
+ */
+static char*
+run(BclContext ctxt, bool fixed, BclNumber* a, BclNumber rate, BclNumber* d)
+{
+	BclNumber total;
+	size_t i, j;
+	double start;
+
+	bcl_ctxt_setFixed(ctxt, fixed);
+
+	total = bcl_num_create();
+	err(bcl_err(total));
+
+	// Applying a rate to every amount.
+	start = now();
+
+	for (j = 0; j < FIXED_ROUNDS; ++j)
+	{
+		for (i = 0; i < FIXED_LEN; ++i)
+		{
+			err(bcl_mul_into(d[i], a[i], rate));
+		}
+	}
+
+	report("mul_into", fixed, start);
+
+	// Splitting every amount.
+	start = now();
+
+	for (j = 0; j < FIXED_ROUNDS; ++j)
+	{
+		for (i = 0; i < FIXED_LEN; ++i)
+		{
+			err(bcl_div_into(d[i], d[i], rate));
+		}
+	}
+
+	report("div_into", fixed, start);
+
+	// Totaling.
+	start = now();
+
+	for (j = 0; j < FIXED_ROUNDS; ++j)
+	{
+		bcl_zero(total);
+
+		for (i = 0; i < FIXED_LEN; ++i)
+		{
+			err(bcl_add_into(total, total, d[i]));
+			err(bcl_sub_into(total, total, a[i]));
+		}
+	}
+
+	report("add/sub", fixed, start);
+
+	return bcl_string(total);
+}
+
+int
+main(void)
+{
+	BclContext ctxt;
+	BclNumber* a;
+	BclNumber* d;
+	BclNumber rate;
+	char buf[64];
+	char* s1;
+	char* s2;
+	size_t i;
+
+	err(bcl_start());
+	err(bcl_init());
+
+	ctxt = bcl_ctxt_create();
+	err(bcl_pushContext(ctxt));
+	bcl_ctxt_setScale(ctxt, 8);
+
+	a = malloc(FIXED_LEN * sizeof(BclNumber));
+	d = malloc(FIXED_LEN * sizeof(BclNumber));
+	if (a == NULL || d == NULL) err(BCL_ERROR_FATAL_ALLOC_ERR);
+
+	for (i = 0; i < FIXED_LEN; ++i)
+	{
+		snprintf(buf, sizeof(buf), "%s%zu.%08zu", i % 3 ? "" : "-",
+		         i * 7919 % 10000000, i * 104729 % 100000000);
+		a[i] = bcl_parse(buf);
+		err(bcl_err(a[i]));
+
+		d[i] = bcl_num_create();
+		err(bcl_err(d[i]));
+	}
+
+	rate = bcl_parse("1.03125");
+	err(bcl_err(rate));
+
+	s1 = run(ctxt, false, a, rate, d);
+	s2 = run(ctxt, true, a, rate, d);
+
+	if (s1 == NULL || s2 == NULL || strcmp(s1, s2))
+	{
+		err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	}
+
+	free(s1);
+	free(s2);
+	free(a);
+	free(d);
+
+	bcl_popContext();
+	bcl_ctxt_free(ctxt);
+
+	bcl_free();
+	bcl_end();
+
+	return 0;
+}
@@ -0,0 +1,169 @@
+/*
+ * *****************************************************************************
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2018-2024 Gavin D. Howard and contributors.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *****************************************************************************
+ *
+ * A benchmark for jobs in bcl(3). It does a number of big multiplications and
+ * square roots, first one call at a time and then by submitting them all as
+ * jobs and waiting for them, and it checks that the results are the same.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <bcl.h>
+
+/// The number of each kind of operation.
+#define JOBS_COUNT (16)
+
+/// The number of decimal digits in the operands.
+#define JOBS_DIGITS (20000)
+
+/**
+ * Takes an error code and aborts if it actually is an error.
+ * @param e  The error code.
+ */
+static void
+err(BclError e)
+{
+	if (e != BCL_ERROR_NONE) abort();
+}
+
+/**
+ * Returns the current time in seconds.
+ * @return  The current time in seconds.
+ */
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double) ts.tv_sec + (double) ts.tv_nsec / 1000000000.0;
+}
+
+int
+main(void)
+{
+	BclContext ctxt;
+	BclNumber nums[JOBS_COUNT];
+	BclNumber sync[JOBS_COUNT * 2];
+	BclNumber args[2];
+	BclJob jobs[JOBS_COUNT * 2];
+	char* str;
+	size_t i, j;
+	double start, secs;
+
+	err(bcl_start());
+	err(bcl_init());
+
+	ctxt = bcl_ctxt_create();
+	if (ctxt == NULL) err(BCL_ERROR_FATAL_ALLOC_ERR);
+	err(bcl_pushContext(ctxt));
+	bcl_ctxt_setScale(ctxt, 100);
+
+	str = malloc(JOBS_DIGITS + 1);
+	if (str == NULL) err(BCL_ERROR_FATAL_ALLOC_ERR);
+
+	for (i = 0; i < JOBS_COUNT; ++i)
+	{
+		for (j = 0; j < JOBS_DIGITS; ++j)
+		{
+			str[j] = (char) ('1' + (i * 7 + j * 13) % 9);
+		}
+
+		str[JOBS_DIGITS] = '\0';
+
+		nums[i] = bcl_parse(str);
+		err(bcl_err(nums[i]));
+	}
+
+	free(str);
+
+	// One call at a time.
+	start = now();
+
+	for (i = 0; i < JOBS_COUNT; ++i)
+	{
+		sync[2 * i] = bcl_mul_keep(nums[i], nums[(i + 1) % JOBS_COUNT]);
+		err(bcl_err(sync[2 * i]));
+
+		sync[2 * i + 1] = bcl_sqrt_keep(nums[i]);
+		err(bcl_err(sync[2 * i + 1]));
+	}
+
+	secs = now() - start;
+
+	printf("%-12s %10.6f s\n", "calls", secs);
+
+	// All of them at once. This includes starting the workers.
+	start = now();
+
+	for (i = 0; i < JOBS_COUNT; ++i)
+	{
+		args[0] = nums[i];
+		args[1] = nums[(i + 1) % JOBS_COUNT];
+
+		jobs[2 * i] = bcl_submit(BCL_JOB_MUL, args);
+		if (jobs[2 * i] == NULL) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+		jobs[2 * i + 1] = bcl_submit(BCL_JOB_SQRT, args);
+		if (jobs[2 * i + 1] == NULL) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	}
+
+	// This is how long the caller was blocked.
+	printf("%-12s %10.6f s\n", "submit", now() - start);
+
+	for (i = 0; i < JOBS_COUNT * 2; ++i)
+	{
+		BclNumber r = bcl_job_wait(jobs[i]);
+
+		err(bcl_err(r));
+
+		if (bcl_cmp(r, sync[i])) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+		bcl_num_free(r);
+	}
+
+	secs = now() - start;
+
+	printf("%-12s %10.6f s\n", "jobs", secs);
+
+	bcl_popContext();
+	bcl_ctxt_free(ctxt);
+
+	bcl_free();
+	bcl_end();
+
+	return 0;
+}
@@ -0,0 +1,194 @@
+/*
+ * *****************************************************************************
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2018-2024 Gavin D. Howard and contributors.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *****************************************************************************
+ *
+ * A benchmark for bcl(3) in multiple threads. It runs the same work in 1 to N
+ * threads, each with its own context, and prints the throughput for each
+ * number of threads.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include <bcl.h>
+
+/// The number of iterations each thread does. Each iteration is
+/// THREADS_ITER_OPS operations.
+#define THREADS_ITERS (200000)
+
+/// The number of bcl operations in each iteration.
+#define THREADS_ITER_OPS (4)
+
+/**
+ * Takes an error code and aborts if it actually is an error.
+ * @param e  The error code.
+ */
+static void
+err(BclError e)
+{
+	if (e != BCL_ERROR_NONE) abort();
+}
+
+/**
+ * Returns the current time in seconds.
+ * @return  The current time in seconds.
+ */
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double) ts.tv_sec + (double) ts.tv_nsec / 1000000000.0;
+}
+
+/**
+ * The work for one thread. It does a mix of operations that make new numbers
+ * and operations that reuse them.
+ * @param arg  Unused.
+ * @return     NULL.
+ */
+static void*
+work(void* arg)
+{
+	BclContext ctxt;
+	BclNumber a, b, d, r;
+	size_t i;
+
+	(void) arg;
+
+	err(bcl_init());
+
+	ctxt = bcl_ctxt_create();
+	if (ctxt == NULL) err(BCL_ERROR_FATAL_ALLOC_ERR);
+	err(bcl_pushContext(ctxt));
+	bcl_ctxt_setScale(ctxt, 10);
+
+	a = bcl_parse("12345.6789");
+	err(bcl_err(a));
+	b = bcl_parse("-987.654321");
+	err(bcl_err(b));
+	d = bcl_num_create();
+	err(bcl_err(d));
+
+	for (i = 0; i < THREADS_ITERS; ++i)
+	{
+		r = bcl_add_keep(a, b);
+		err(bcl_err(r));
+		bcl_num_free(r);
+
+		err(bcl_mul_into(d, a, b));
+		err(bcl_sub_into(d, d, a));
+		if (bcl_cmp(d, a) >= 0) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	}
+
+	bcl_popContext();
+	bcl_ctxt_free(ctxt);
+
+	bcl_free();
+
+	return NULL;
+}
+
+/**
+ * Runs the work in a number of threads at once and prints the throughput.
+ * @param nthreads  The number of threads.
+ */
+static void
+run(size_t nthreads)
+{
+	pthread_t* threads;
+	size_t i;
+	double start, secs, ops;
+
+	threads = malloc(nthreads * sizeof(pthread_t));
+	if (threads == NULL) err(BCL_ERROR_FATAL_ALLOC_ERR);
+
+	start = now();
+
+	for (i = 0; i < nthreads; ++i)
+	{
+		if (pthread_create(threads + i, NULL, work, NULL))
+		{
+			err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+		}
+	}
+
+	for (i = 0; i < nthreads; ++i)
+	{
+		if (pthread_join(threads[i], NULL)) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	}
+
+	secs = now() - start;
+	ops = (double) nthreads * THREADS_ITERS * THREADS_ITER_OPS;
+
+	printf("%4zu threads  %10.6f s  %12.0f ops/s  %12.0f ops/s/thread\n",
+	       nthreads, secs, ops / secs, ops / secs / (double) nthreads);
+
+	free(threads);
+}
+
+int
+main(int argc, char* argv[])
+{
+	size_t max, n;
+	long cpus;
+
+	// The default is the number of CPUs.
+	if (argc > 1) max = (size_t) strtoul(argv[1], NULL, 10);
+	else
+	{
+		cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		max = cpus > 0 ? (size_t) cpus : 1;
+	}
+
+	if (!max) max = 1;
+
+	err(bcl_start());
+
+	// Double the number of threads each time, and make sure to end on max.
+	for (n = 1; n < max; n *= 2)
+	{
+		run(n);
+	}
+
+	run(max);
+
+	bcl_end();
+
+	return 0;
+}
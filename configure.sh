@@ -60,7 +60,10 @@ usage() {
 	printf '       [--disable-history --disable-man-pages --disable-nls --disable-strip] \\\n'
 	printf '       [--enable-editline] [--enable-readline] [--enable-internal-history]   \\\n'
 	printf '       [--disable-problematic-tests] [--install-all-locales]                 \\\n'
+	printf '       [--disable-lib-image]                                                 \\\n'
 	printf '       [--opt=OPT_LEVEL] [--karatsuba-len=KARATSUBA_LEN]                     \\\n'
+	printf '       [--output-buffer-size=OUTPUT_BUFFER_SIZE]                             \\\n'
+	printf '       [--parse-ahead=PARSE_AHEAD]                                           \\\n'
 	printf '       [--set-default-on=SETTING] [--set-default-off=SETTING]                \\\n'
 	printf '       [--predefined-build-type=TYPE]                                        \\\n'
 	printf '       [--prefix=PREFIX] [--bindir=BINDIR] [--datarootdir=DATAROOTDIR]       \\\n'
@@ -181,6 +184,20 @@ usage() {
 	printf '        Enable a build appropriate for valgrind. For development only.\n'
 	printf '    -z, --enable-fuzz-mode\n'
 	printf '        Enable fuzzing mode. THIS IS FOR DEVELOPMENT ONLY.\n'
+	printf '    --disable-lib-image\n'
+	printf '        Disable the precompiled images of the math libraries. The images are\n'
+	printf '        generated by running a program built with $CC, so they are disabled\n'
+	printf '        automatically when cross compiling (HOSTCC is not CC) or if GEN_HOST\n'
+	printf '        is "0".\n'
+	printf '    --output-buffer-size OUTPUT_BUFFER_SIZE\n'
+	printf '        Set the size of the buffer for stdout, in bytes, to OUTPUT_BUFFER_SIZE\n'
+	printf '        (default is 65536). It is an error if OUTPUT_BUFFER_SIZE is not a\n'
+	printf '        number or is less than 256.\n'
+	printf '    --parse-ahead PARSE_AHEAD\n'
+	printf '        Set the number of statements that bc parses before it runs them when\n'
+	printf '        it is not interactive to PARSE_AHEAD (default is 64). 1 runs every\n'
+	printf '        statement as soon as it is parsed. It is an error if PARSE_AHEAD is\n'
+	printf '        not a number or is less than 1.\n'
 	printf '    --prefix PREFIX\n'
 	printf '        The prefix to install to. Overrides "$PREFIX" if it exists.\n'
 	printf '        If PREFIX is "/usr", install path will be "/usr/bin".\n'
@@ -875,6 +892,9 @@ bc_only=0
 dc_only=0
 coverage=0
 karatsuba_len=32
+output_buffer_size=65536
+parse_ahead=64
+lib_image=1
 debug=0
 hist=1
 hist_impl="internal"
@@ -1020,6 +1040,20 @@ while getopts "abBcdDeEfgGhHik:lMmNO:p:PrS:s:tTvz-" opt; do
 					MAN3DIR="$2"
 					shift ;;
 				karatsuba-len=?*) karatsuba_len="$LONG_OPTARG" ;;
+				output-buffer-size=?*) output_buffer_size="$LONG_OPTARG" ;;
+				output-buffer-size)
+					if [ "$#" -lt 2 ]; then
+						usage "No argument given for '--$arg' option"
+					fi
+					output_buffer_size="$2"
+					shift ;;
+				parse-ahead=?*) parse_ahead="$LONG_OPTARG" ;;
+				parse-ahead)
+					if [ "$#" -lt 2 ]; then
+						usage "No argument given for '--$arg' option"
+					fi
+					parse_ahead="$2"
+					shift ;;
 				karatsuba-len)
 					if [ "$#" -lt 2 ]; then
 						usage "No argument given for '--$arg' option"
@@ -1060,6 +1094,7 @@ while getopts "abBcdDeEfgGhHik:lMmNO:p:PrS:s:tTvz-" opt; do
 				disable-extra-math) extra_math=0 ;;
 				disable-generated-tests) generate_tests=0 ;;
 				disable-history) hist=0 ;;
+				disable-lib-image) lib_image=0 ;;
 				disable-man-pages) install_manpages=0 ;;
 				disable-nls) nls=0 ;;
 				disable-strip) strip_bin=0 ;;
@@ -1080,6 +1115,8 @@ while getopts "abBcdDeEfgGhHik:lMmNO:p:PrS:s:tTvz-" opt; do
 					usage "No arg allowed for --$arg option" ;;
 				disable-generated-tests* | disable-history*)
 					usage "No arg allowed for --$arg option" ;;
+				disable-lib-image*)
+					usage "No arg allowed for --$arg option" ;;
 				disable-man-pages* | disable-nls* | disable-strip*)
 					usage "No arg allowed for --$arg option" ;;
 				disable-problematic-tests*)
@@ -1133,6 +1170,26 @@ if [ "$karatsuba_len" -lt 16 ]; then
 	usage "KARATSUBA_LEN is less than 16"
 fi
 
+# OUTPUT_BUFFER_SIZE must be an integer and must be 256 or greater.
+case $output_buffer_size in
+	(*[!0-9]*|'') usage "OUTPUT_BUFFER_SIZE is not a number" ;;
+	(*) ;;
+esac
+
+if [ "$output_buffer_size" -lt 256 ]; then
+	usage "OUTPUT_BUFFER_SIZE is less than 256"
+fi
+
+# PARSE_AHEAD must be an integer and must be 1 or greater.
+case $parse_ahead in
+	(*[!0-9]*|'') usage "PARSE_AHEAD is not a number" ;;
+	(*) ;;
+esac
+
+if [ "$parse_ahead" -lt 1 ]; then
+	usage "PARSE_AHEAD is less than 1"
+fi
+
 set -e
 
 if [ -z "${LONG_BIT+set}" ]; then
@@ -1754,6 +1811,15 @@ else
 	fi
 fi
 
+# The math library images are generated by running a program built by $CC, so
+# they can only be used when that program can run here. They also only exist
+# for bc itself, not the library.
+if [ "$bc" -eq 0 ] || [ "$library" -ne 0 ] || [ "$GEN_HOST" -eq 0 ]; then
+	lib_image=0
+elif [ "$HOSTCC" != "$CC" ]; then
+	lib_image=0
+fi
+
 manpage_args=""
 unneeded=""
 headers="\$(HEADERS)"
@@ -1884,11 +1950,14 @@ fi
 printf '\n'
 printf 'BC_ENABLE_LIBRARY=%s\n\n' "$library"
 printf 'BC_ENABLE_HISTORY=%s\n' "$hist"
+printf 'BC_ENABLE_LIB_IMAGE=%s\n' "$lib_image"
 printf 'BC_ENABLE_EXTRA_MATH=%s\n' "$extra_math"
 printf 'BC_ENABLE_NLS=%s\n\n' "$nls"
 printf 'BC_ENABLE_AFL=%s\n' "$fuzz"
 printf '\n'
 printf 'BC_NUM_KARATSUBA_LEN=%s\n' "$karatsuba_len"
+printf 'BC_VM_STDOUT_BUF_SIZE=%s\n' "$output_buffer_size"
+printf 'BC_VM_PARSE_AHEAD=%s\n' "$parse_ahead"
 printf '\n'
 printf 'CC=%s\n' "$CC"
 printf 'CFLAGS=%s\n' "$CFLAGS"
@@ -1970,6 +2039,23 @@ SRC_TARGETS=""
 # added the library.
 src_files=$(find_src_files $unneeded)
 
+# The program that generates the math library images links with everything but
+# main.c.
+if [ "$lib_image" -ne 0 ]; then
+
+	BC_LIB_IMG_O="\$(GEN_DIR)/lib_img.o"
+	BC_LIB_IMG_GEN_OBJ=""
+
+	for f in $(find_src_files $unneeded main.c); do
+		o=$(replace_ext "$f" "c" "o")
+		BC_LIB_IMG_GEN_OBJ="$BC_LIB_IMG_GEN_OBJ src/$(basename "$o")"
+	done
+
+else
+	BC_LIB_IMG_O=""
+	BC_LIB_IMG_GEN_OBJ=""
+fi
+
 for f in $src_files; do
 	o=$(replace_ext "$f" "c" "o")
 	o=$(basename "$o")
@@ -2017,7 +2103,12 @@ contents=$(replace "$contents" "BC_LIB_O" "$bc_lib")
 contents=$(replace "$contents" "BC_HELP_O" "$bc_help")
 contents=$(replace "$contents" "DC_HELP_O" "$dc_help")
 contents=$(replace "$contents" "BC_LIB2_O" "$BC_LIB2_O")
+contents=$(replace "$contents" "BC_LIB_IMG_O" "$BC_LIB_IMG_O")
+contents=$(replace "$contents" "BC_LIB_IMG_GEN_OBJ" "$BC_LIB_IMG_GEN_OBJ")
+contents=$(replace "$contents" "LIB_IMAGE" "$lib_image")
 contents=$(replace "$contents" "KARATSUBA_LEN" "$karatsuba_len")
+contents=$(replace "$contents" "OUTPUT_BUFFER_SIZE" "$output_buffer_size")
+contents=$(replace "$contents" "PARSE_AHEAD" "$parse_ahead")
 
 contents=$(replace "$contents" "NLSPATH" "$NLSPATH")
 contents=$(replace "$contents" "DESTDIR" "$destdir")
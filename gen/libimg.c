@@ -0,0 +1,533 @@
+/*
+ * *****************************************************************************
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2018-2024 Gavin D. Howard and contributors.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *****************************************************************************
+ *
+ *
+ * Generates the images of the math libraries. This is linked with bc itself,
+ * parses the libraries the way bc would, and writes out what the parser left in
+ * the BcProgram as C source.
+ *
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <setjmp.h>
+
+#include <status.h>
+#include <vector.h>
+#include <lang.h>
+#include <program.h>
+#include <parse.h>
+#include <bc.h>
+#include <file.h>
+#include <vm.h>
+
+// clang-format off
+
+// The usage help.
+static const char* const bc_img_usage = "usage: %s output\n";
+
+// The license header and the includes of the generated C source file.
+static const char* const bc_img_header =
+	"// Copyright (c) 2018-2024 Gavin D. Howard and contributors.\n"
+	"// Licensed under the 2-clause BSD license.\n"
+	"// *** AUTOMATICALLY GENERATED BY gen/libimg.c. DO NOT MODIFY. ***\n\n"
+	"#include <program.h>\n\n";
+// clang-format on
+
+// Error codes. We can't use 0 because these are used as exit statuses, and 0
+// as an exit status is not an error.
+#define IO_ERR (1)
+#define INVALID_PARAMS (2)
+#define PARSE_ERR (3)
+
+// This is the max width to print items to the screen. This is to ensure that
+// lines don't go much over 80 characters.
+#define MAX_WIDTH (72)
+
+// bc itself links with these, so they have to exist, but this program never
+// uses them.
+const BcImage bc_lib_img;
+#if BC_ENABLE_EXTRA_MATH
+const BcImage bc_lib2_img;
+#endif // BC_ENABLE_EXTRA_MATH
+
+/// A snapshot of the lengths of the vectors in a BcProgram. It marks where a
+/// library starts.
+typedef struct BcImgMark
+{
+	/// The number of functions.
+	size_t fns;
+
+	/// The number of variables.
+	size_t vars;
+
+	/// The number of arrays.
+	size_t arrs;
+
+	/// The number of strings.
+	size_t strs;
+
+	/// The number of constants.
+	size_t consts;
+
+	/// The length of the code of the main function.
+	size_t code;
+
+	/// The number of labels of the main function.
+	size_t labels;
+
+} BcImgMark;
+
+/**
+ * Takes a snapshot of the lengths of the vectors in the program.
+ * @param m  The snapshot to fill.
+ */
+static void
+bc_img_mark(BcImgMark* m)
+{
+	BcFunc* f = bc_vec_item(&vm->prog.fns, BC_PROG_MAIN);
+
+	m->fns = vm->prog.fns.len;
+	m->vars = vm->prog.vars.len;
+	m->arrs = vm->prog.arrs.len;
+	m->strs = vm->prog.strs.len;
+	m->consts = vm->prog.consts.len;
+	m->code = f->code.len;
+	m->labels = f->labels.len;
+}
+
+/**
+ * Outputs a string as a C string literal. Everything that is not printable is
+ * escaped.
+ * @param out  The file to output to.
+ * @param str  The string.
+ */
+static void
+bc_img_str(FILE* out, const char* str)
+{
+	fputc('"', out);
+
+	for (; *str; ++str)
+	{
+		uchar c = (uchar) *str;
+
+		if (c == '"' || c == '\\') fprintf(out, "\\%c", c);
+		else if (c < ' ' || c > '~') fprintf(out, "\\%03o", (unsigned int) c);
+		else fputc(c, out);
+	}
+
+	fputc('"', out);
+}
+
+/**
+ * Outputs an array of names, given by a map, for items with indices in a range.
+ * @param out    The file to output to.
+ * @param map    The map to find the names in.
+ * @param label  The name of the array.
+ * @param start  The first index.
+ * @param end    One past the last index.
+ */
+static void
+bc_img_names(FILE* out, const BcMap* map, const char* label, size_t start,
+             size_t end)
+{
+	size_t i, j;
+
+	if (start == end) return;
+
+	fprintf(out, "static const char* const %s[] = {\n", label);
+
+	// The map is unordered, so find the name of each index.
+	for (i = start; i < end; ++i)
+	{
+		for (j = 0; j < map->ids.len; ++j)
+		{
+			const BcId* id = bc_vec_item(&map->ids, j);
+			if (id->idx != i) continue;
+
+			fputc('\t', out);
+			bc_img_str(out, id->name);
+			fputs(",\n", out);
+
+			break;
+		}
+	}
+
+	fputs("};\n\n", out);
+}
+
+/**
+ * Outputs an array of strings, given by a vector of char pointers, for items
+ * with indices in a range.
+ * @param out    The file to output to.
+ * @param v      The vector.
+ * @param label  The name of the array.
+ * @param start  The first index.
+ * @param end    One past the last index.
+ */
+static void
+bc_img_strs(FILE* out, const BcVec* v, const char* label, size_t start,
+            size_t end)
+{
+	size_t i;
+
+	if (start == end) return;
+
+	fprintf(out, "static const char* const %s[] = {\n", label);
+
+	for (i = start; i < end; ++i)
+	{
+		// Both strings and constants start with a char pointer.
+		fputc('\t', out);
+		bc_img_str(out, *((char**) bc_vec_item(v, i)));
+		fputs(",\n", out);
+	}
+
+	fputs("};\n\n", out);
+}
+
+/**
+ * Outputs an array of numbers from a vector of uchar or size_t, starting at an
+ * index.
+ * @param out    The file to output to.
+ * @param v      The vector.
+ * @param type   The C type of the array.
+ * @param label  The name of the array.
+ * @param start  The index of the first item.
+ */
+static void
+bc_img_nums(FILE* out, const BcVec* v, const char* type, const char* label,
+            size_t start)
+{
+	size_t i, width;
+
+	fprintf(out, "static const %s %s[] = {\n\t", type, label);
+
+	for (i = start, width = 0; i < v->len; ++i)
+	{
+		size_t n;
+
+		if (v->size == sizeof(uchar)) n = (size_t) v->v[i];
+		else n = *((size_t*) bc_vec_item(v, i));
+
+		width += (size_t) fprintf(out, "%zu,", n);
+
+		if (width > MAX_WIDTH && i + 1 < v->len)
+		{
+			fputs("\n\t", out);
+			width = 0;
+		}
+	}
+
+	fputs("\n};\n\n", out);
+}
+
+/**
+ * Outputs the arrays of a function.
+ * @param out     The file to output to.
+ * @param f       The function.
+ * @param label   The prefix of the names of the arrays.
+ * @param code    The index of the first instruction.
+ * @param labels  The index of the first label.
+ */
+static void
+bc_img_funcArrays(FILE* out, const BcFunc* f, const char* label, size_t code,
+                  size_t labels)
+{
+	char name[80];
+	size_t i;
+
+	if (code < f->code.len)
+	{
+		snprintf(name, sizeof(name), "%s_code", label);
+		bc_img_nums(out, &f->code, "uchar", name, code);
+	}
+
+	if (labels < f->labels.len)
+	{
+		snprintf(name, sizeof(name), "%s_labels", label);
+		bc_img_nums(out, &f->labels, "size_t", name, labels);
+	}
+
+	if (f->autos.len)
+	{
+		fprintf(out, "static const BcAuto %s_autos[] = {\n", label);
+
+		for (i = 0; i < f->autos.len; ++i)
+		{
+			BcAuto* a = bc_vec_item(&f->autos, i);
+			fprintf(out, "\t{ %zu, %d },\n", a->idx, (int) a->type);
+		}
+
+		fputs("};\n\n", out);
+	}
+}
+
+/**
+ * Outputs the initializer for a BcImageFunc. This must match the arrays output
+ * by bc_img_funcArrays().
+ * @param out     The file to output to.
+ * @param f       The function.
+ * @param label   The prefix of the names of the arrays.
+ * @param code    The index of the first instruction.
+ * @param labels  The index of the first label.
+ * @param indent  The indentation.
+ */
+static void
+bc_img_func(FILE* out, const BcFunc* f, const char* label, size_t code,
+            size_t labels, const char* indent)
+{
+	fprintf(out, "%s{\n%s\t", indent, indent);
+
+	bc_img_str(out, f->name);
+
+	if (code < f->code.len)
+	{
+		fprintf(out, ",\n%s\t%s_code, %zu,\n", indent, label, f->code.len - code);
+	}
+	else fprintf(out, ",\n%s\tNULL, 0,\n", indent);
+
+	if (labels < f->labels.len)
+	{
+		fprintf(out, "%s\t%s_labels, %zu,\n", indent, label,
+		        f->labels.len - labels);
+	}
+	else fprintf(out, "%s\tNULL, 0,\n", indent);
+
+	if (f->autos.len)
+	{
+		fprintf(out, "%s\t%s_autos, %zu,\n", indent, label, f->autos.len);
+	}
+	else fprintf(out, "%s\tNULL, 0,\n", indent);
+
+	fprintf(out, "%s\t%zu, %s\n%s}", indent, f->nparams,
+	        f->voidfn ? "true" : "false", indent);
+}
+
+/**
+ * Outputs the image of a library, which is everything that was added to the
+ * program between two snapshots.
+ * @param out    The file to output to.
+ * @param name   The name of the image.
+ * @param start  The snapshot before the library was parsed.
+ * @param end    The snapshot after the library was parsed.
+ */
+static void
+bc_img_output(FILE* out, const char* name, const BcImgMark* start,
+              const BcImgMark* end)
+{
+	BcProgram* p = &vm->prog;
+	BcFunc* main_fn = bc_vec_item(&p->fns, BC_PROG_MAIN);
+	char label[64];
+	size_t i;
+
+	for (i = start->fns; i < end->fns; ++i)
+	{
+		snprintf(label, sizeof(label), "%s_fn%zu", name, i);
+		bc_img_funcArrays(out, bc_vec_item(&p->fns, i), label, 0, 0);
+	}
+
+	snprintf(label, sizeof(label), "%s_main", name);
+
+	// The main function has no autos, so only the new code and labels matter.
+	bc_img_funcArrays(out, main_fn, label, start->code, start->labels);
+
+	if (start->fns < end->fns)
+	{
+		fprintf(out, "static const BcImageFunc %s_fns[] = {\n", name);
+
+		for (i = start->fns; i < end->fns; ++i)
+		{
+			snprintf(label, sizeof(label), "%s_fn%zu", name, i);
+			bc_img_func(out, bc_vec_item(&p->fns, i), label, 0, 0, "\t");
+			fputs(",\n", out);
+		}
+
+		fputs("};\n\n", out);
+	}
+
+	snprintf(label, sizeof(label), "%s_vars", name);
+	bc_img_names(out, &p->var_map, label, start->vars, end->vars);
+
+	snprintf(label, sizeof(label), "%s_arrs", name);
+	bc_img_names(out, &p->arr_map, label, start->arrs, end->arrs);
+
+	snprintf(label, sizeof(label), "%s_strs", name);
+	bc_img_strs(out, &p->strs, label, start->strs, end->strs);
+
+	snprintf(label, sizeof(label), "%s_consts", name);
+	bc_img_strs(out, &p->consts, label, start->consts, end->consts);
+
+	fprintf(out, "const BcImage %s = {\n", name);
+
+	if (start->fns < end->fns)
+	{
+		fprintf(out, "\t%s_fns, %zu,\n", name, end->fns - start->fns);
+	}
+	else fputs("\tNULL, 0,\n", out);
+
+	snprintf(label, sizeof(label), "%s_main", name);
+	bc_img_func(out, main_fn, label, start->code, start->labels, "\t");
+	fputs(",\n", out);
+
+	if (start->vars < end->vars)
+	{
+		fprintf(out, "\t%s_vars, %zu,\n", name, end->vars - start->vars);
+	}
+	else fputs("\tNULL, 0,\n", out);
+
+	if (start->arrs < end->arrs)
+	{
+		fprintf(out, "\t%s_arrs, %zu,\n", name, end->arrs - start->arrs);
+	}
+	else fputs("\tNULL, 0,\n", out);
+
+	if (start->strs < end->strs)
+	{
+		fprintf(out, "\t%s_strs, %zu,\n", name, end->strs - start->strs);
+	}
+	else fputs("\tNULL, 0,\n", out);
+
+	if (start->consts < end->consts)
+	{
+		fprintf(out, "\t%s_consts, %zu,\n", name, end->consts - start->consts);
+	}
+	else fputs("\tNULL, 0,\n", out);
+
+	fputs("};\n\n", out);
+}
+
+/**
+ * Sets up just enough of the BcVm global to parse the math libraries. This
+ * mirrors bc_main() and bc_vm_boot().
+ */
+static void
+bc_img_init(void)
+{
+#if !BC_ENABLE_LINE_LIB
+	static char bufs[BC_VM_STDERR_BUF_SIZE];
+#endif // !BC_ENABLE_LINE_LIB
+	size_t i;
+
+	BC_SIG_ASSERT_LOCKED;
+
+	vm->name = "bc";
+
+	vm->next = bc_lex_token;
+	vm->parse = bc_parse_parse;
+	vm->expr = bc_parse_expr;
+
+	bc_vm_init();
+
+	// Errors should never happen, but if they do, they need to be printed.
+	for (i = 0; i < BC_ERR_IDX_NELEMS + BC_ENABLED; ++i)
+	{
+		vm->err_ids[i] = bc_errs[i];
+	}
+
+	for (i = 0; i < BC_ERR_NELEMS; ++i)
+	{
+		vm->err_msgs[i] = bc_err_msgs[i];
+	}
+
+#if BC_ENABLE_LINE_LIB
+	bc_file_init(&vm->ferr, stderr, true);
+#else // BC_ENABLE_LINE_LIB
+	bc_file_init(&vm->ferr, STDERR_FILENO, bufs, sizeof(bufs), true);
+#endif // BC_ENABLE_LINE_LIB
+
+	bc_slabvec_init(&vm->slabs);
+
+	bc_program_init(&vm->prog);
+	bc_parse_init(&vm->prs, &vm->prog, BC_PROG_MAIN);
+
+	// Can't allow redefinitions in the builtin library.
+	vm->no_redefine = true;
+}
+
+int
+main(int argc, char* argv[])
+{
+	FILE* out;
+	BcImgMark start, lib;
+#if BC_ENABLE_EXTRA_MATH
+	BcImgMark lib2;
+#endif // BC_ENABLE_EXTRA_MATH
+
+	if (argc != 2)
+	{
+		fprintf(stderr, bc_img_usage, argv[0]);
+		return INVALID_PARAMS;
+	}
+
+	BC_SIG_LOCK;
+
+	bc_vec_init(&vm->jmp_bufs, sizeof(sigjmp_buf), BC_DTOR_NONE);
+
+	BC_SETJMP_LOCKED(vm, err);
+
+	bc_img_init();
+
+	bc_img_mark(&start);
+
+	BC_SIG_UNLOCK;
+
+	bc_vm_load(bc_lib_name, bc_lib);
+	bc_img_mark(&lib);
+
+#if BC_ENABLE_EXTRA_MATH
+	bc_vm_load(bc_lib2_name, bc_lib2);
+	bc_img_mark(&lib2);
+#endif // BC_ENABLE_EXTRA_MATH
+
+	BC_SIG_LOCK;
+
+	out = fopen(argv[1], "w");
+	if (out == NULL) return IO_ERR;
+
+	fputs(bc_img_header, out);
+
+	bc_img_output(out, "bc_lib_img", &start, &lib);
+
+#if BC_ENABLE_EXTRA_MATH
+	bc_img_output(out, "bc_lib2_img", &lib, &lib2);
+#endif // BC_ENABLE_EXTRA_MATH
+
+	if (fclose(out)) return IO_ERR;
+
+	return 0;
+
+err:
+	return PARSE_ERR;
+}
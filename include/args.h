@@ -78,6 +78,34 @@ bc_args(int argc, char* argv[], bool exit_exprs, BcBigDig* scale,
 
 #endif // BC_ENABLED
 
+#if BC_ENABLE_IMAGES
+
+/// The value of the option to save a program image. Options without a short
+/// option have values that no char can have.
+#define BC_ARGS_SAVE_IMAGE (UCHAR_MAX + 1)
+
+/// The value of the option to load a program image.
+#define BC_ARGS_LOAD_IMAGE (UCHAR_MAX + 2)
+
+#endif // BC_ENABLE_IMAGES
+
+#if BC_ENABLE_SERVER
+
+/// The value of the option to run as a server.
+#define BC_ARGS_SERVER (UCHAR_MAX + 3)
+
+/// The value of the option to run as a client of a server.
+#define BC_ARGS_CLIENT (UCHAR_MAX + 4)
+
+#endif // BC_ENABLE_SERVER
+
+#if BC_ENABLE_JOBS
+
+/// The value of the option to run the expressions and files in parallel jobs.
+#define BC_ARGS_JOBS (UCHAR_MAX + 5)
+
+#endif // BC_ENABLE_JOBS
+
 // A reference to the list of long options.
 extern const BcOptLong bc_args_lopt[];
 
@@ -112,6 +112,13 @@ typedef struct BcLexKeyword
 extern const BcLexKeyword bc_lex_kws[];
 extern const size_t bc_lex_kws_len;
 
+/// The length of each row of bc_lex_kws_chars. It must be one more than the
+/// most keywords that start with the same letter.
+#define BC_LEX_KWS_ROW (6)
+
+// The keywords by their first letter, for the lexer. See src/data.c.
+extern const uchar bc_lex_kws_chars[26][BC_LEX_KWS_ROW];
+
 /**
  * The @a BcLexNext function for bc. (See include/lex.h for a definition of
  * @a BcLexNext.)
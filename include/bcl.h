@@ -136,6 +136,35 @@ struct BclCtxt;
 
 typedef struct BclCtxt* BclContext;
 
+struct BclExpression;
+
+typedef struct BclExpression* BclExpr;
+
+typedef enum BclJobOp
+{
+	BCL_JOB_ADD,
+	BCL_JOB_SUB,
+	BCL_JOB_MUL,
+	BCL_JOB_DIV,
+	BCL_JOB_MOD,
+	BCL_JOB_POW,
+	BCL_JOB_LSHIFT,
+	BCL_JOB_RSHIFT,
+	BCL_JOB_SQRT,
+	BCL_JOB_MODEXP,
+
+	BCL_JOB_NELEMS,
+
+} BclJobOp;
+
+struct BclTask;
+
+typedef struct BclTask* BclJob;
+
+struct BcVm;
+
+typedef struct BcVm* BclThread;
+
 BclError
 bcl_start(void);
 
@@ -169,6 +198,12 @@ bcl_setDigitClamp(bool digitClamp);
 void
 bcl_gc(void);
 
+BclThread
+bcl_thread(void);
+
+void
+bcl_cancel(BclThread thread);
+
 BclError
 bcl_pushContext(BclContext ctxt);
 
@@ -181,6 +216,9 @@ bcl_context(void);
 BclContext
 bcl_ctxt_create(void);
 
+BclContext
+bcl_ctxt_create_arena(size_t hint);
+
 void
 bcl_ctxt_free(BclContext ctxt);
 
@@ -193,6 +231,18 @@ bcl_ctxt_scale(BclContext ctxt);
 void
 bcl_ctxt_setScale(BclContext ctxt, size_t scale);
 
+bool
+bcl_ctxt_fixed(BclContext ctxt);
+
+void
+bcl_ctxt_setFixed(BclContext ctxt, bool fixed);
+
+uint64_t
+bcl_ctxt_deadline(BclContext ctxt);
+
+void
+bcl_ctxt_setDeadline(BclContext ctxt, uint64_t ns);
+
 size_t
 bcl_ctxt_ibase(BclContext ctxt);
 
@@ -244,6 +294,27 @@ bcl_bigdig_keep(BclNumber n, BclBigDig* result);
 BclNumber
 bcl_bigdig2num(BclBigDig val);
 
+BclNumber
+bcl_import_bytes(const unsigned char* restrict bytes, size_t len,
+                 bool bigEndian, bool twosComp);
+
+BclError
+bcl_export_bytes(BclNumber n, unsigned char* restrict bytes, size_t len,
+                 bool bigEndian, bool twosComp);
+
+BclError
+bcl_export_bytes_keep(BclNumber n, unsigned char* restrict bytes, size_t len,
+                      bool bigEndian, bool twosComp);
+
+BclNumber
+bcl_from_double(double val);
+
+BclError
+bcl_to_double(BclNumber n, double* result);
+
+BclError
+bcl_to_double_keep(BclNumber n, double* result);
+
 BclNumber
 bcl_add(BclNumber a, BclNumber b);
 
@@ -292,6 +363,42 @@ bcl_rshift(BclNumber a, BclNumber b);
 BclNumber
 bcl_rshift_keep(BclNumber a, BclNumber b);
 
+BclError
+bcl_add_into(BclNumber d, BclNumber a, BclNumber b);
+
+BclError
+bcl_sub_into(BclNumber d, BclNumber a, BclNumber b);
+
+BclError
+bcl_mul_into(BclNumber d, BclNumber a, BclNumber b);
+
+BclError
+bcl_div_into(BclNumber d, BclNumber a, BclNumber b);
+
+BclError
+bcl_mod_into(BclNumber d, BclNumber a, BclNumber b);
+
+BclError
+bcl_pow_into(BclNumber d, BclNumber a, BclNumber b);
+
+BclError
+bcl_lshift_into(BclNumber d, BclNumber a, BclNumber b);
+
+BclError
+bcl_rshift_into(BclNumber d, BclNumber a, BclNumber b);
+
+BclError
+bcl_add_n(BclNumber* d, const BclNumber* a, const BclNumber* b, size_t n);
+
+BclError
+bcl_mul_scalar_n(BclNumber* d, const BclNumber* a, BclNumber s, size_t n);
+
+BclNumber
+bcl_sum(const BclNumber* nums, size_t n);
+
+BclNumber
+bcl_dot(const BclNumber* a, const BclNumber* b, size_t n);
+
 BclNumber
 bcl_sqrt(BclNumber a);
 
@@ -322,12 +429,46 @@ bcl_one(BclNumber n);
 BclNumber
 bcl_parse(const char* restrict val);
 
+BclNumber
+bcl_parse_n(const char* restrict val, size_t len);
+
 char*
 bcl_string(BclNumber n);
 
 char*
 bcl_string_keep(BclNumber n);
 
+size_t
+bcl_string_len(BclNumber n);
+
+BclError
+bcl_string_into(BclNumber n, char* restrict buf, size_t cap,
+                size_t* restrict needed);
+
+BclExpr
+bcl_expr_compile(const char* restrict expr);
+
+void
+bcl_expr_free(BclExpr expr);
+
+size_t
+bcl_expr_nargs(BclExpr expr);
+
+BclNumber
+bcl_expr_eval(BclExpr expr, const BclNumber* args);
+
+BclError
+bcl_expr_eval_into(BclNumber d, BclExpr expr, const BclNumber* args);
+
+BclJob
+bcl_submit(BclJobOp op, const BclNumber* args);
+
+bool
+bcl_job_poll(BclJob job);
+
+BclNumber
+bcl_job_wait(BclJob job);
+
 BclNumber
 bcl_irand(BclNumber a);
 
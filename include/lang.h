@@ -411,6 +411,13 @@ typedef struct BcFunc
 	bool voidfn;
 #endif // BC_ENABLED
 
+#if BC_ENABLE_IMAGES
+	/// If this is not NULL, the function is a stub for a function in a program
+	/// image, and the vectors have not been allocated. The function is loaded
+	/// from the image the first time it is called.
+	const struct BcImageFunc* img;
+#endif // BC_ENABLE_IMAGES
+
 } BcFunc;
 
 /// Types of results that can be pushed onto the results stack.
@@ -545,6 +552,43 @@ typedef struct BcAuto
 } BcAuto;
 #endif // BC_ENABLED
 
+#if BC_ENABLE_IMAGES
+
+/// A function in a program image, either a precompiled library or one loaded
+/// with --load-image. The arrays are the contents of the vectors in a BcFunc.
+typedef struct BcImageFunc
+{
+	/// The name of the function.
+	const char* name;
+
+	/// The bytecode of the function.
+	const uchar* code;
+
+	/// The length of the bytecode.
+	size_t code_len;
+
+	/// The labels of the function.
+	const size_t* labels;
+
+	/// The number of labels.
+	size_t labels_len;
+
+	/// The autos and parameters of the function.
+	const BcAuto* autos;
+
+	/// The number of autos and parameters.
+	size_t autos_len;
+
+	/// The number of parameters.
+	size_t nparams;
+
+	/// True if the function is a void function.
+	bool voidfn;
+
+} BcImageFunc;
+
+#endif // BC_ENABLE_IMAGES
+
 /// Forward declaration.
 struct BcProgram;
 
@@ -578,6 +622,37 @@ bc_func_insert(BcFunc* f, struct BcProgram* p, char* name, BcType type,
 void
 bc_func_reset(BcFunc* f);
 
+#if BC_ENABLE_IMAGES
+
+/**
+ * Makes a function a stub for a function in a program image. The vectors of
+ * the function are not allocated until it is loaded with bc_func_load().
+ * @param f     The function to make a stub.
+ * @param name  The name of the function. The string is assumed to be owned by
+ *              some other entity.
+ * @param img   The function in the image.
+ */
+void
+bc_func_stub(BcFunc* f, const char* name, const BcImageFunc* img);
+
+/**
+ * Copies a function from a program image onto the end of a function. The
+ * function must not be a stub.
+ * @param f    The function to copy into.
+ * @param img  The function in the image.
+ */
+void
+bc_func_append(BcFunc* f, const BcImageFunc* img);
+
+/**
+ * Loads a stub function from its program image.
+ * @param f  The stub to load.
+ */
+void
+bc_func_load(BcFunc* f);
+
+#endif // BC_ENABLE_IMAGES
+
 #if BC_DEBUG
 /**
  * Frees a function. This is a destructor. This is only used in debug builds
@@ -569,6 +569,28 @@ bc_lex_text(BcLex* l, const char* text, BcMode mode);
 void
 bc_lex_next(BcLex* l);
 
+/**
+ * Starts lexing the next line of the text after bc_lex_next() stopped at the
+ * end of a line in stdin mode.
+ * @param l  The lexer.
+ * @return   True if there was another line, false if the text is done.
+ */
+bool
+bc_lex_nextLine(BcLex* l);
+
+/**
+ * Finds a character, or the end of the text, and counts the newlines before it.
+ * This is used to skip comments and strings.
+ * @param buf     The text. It must end with a nul byte.
+ * @param i       The index to start at.
+ * @param c       The character to find.
+ * @param nlines  An out parameter; the number of newlines that were skipped is
+ *                added to it.
+ * @return        The index of @a c, or of the nul byte if there is no @a c.
+ */
+size_t
+bc_lex_find(const char* buf, size_t i, char c, size_t* nlines);
+
 /**
  * Lexes a line comment (one beginning with '#' and going to a newline).
  * @param l  The lexer.
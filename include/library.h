@@ -186,26 +186,42 @@ typedef BcNum BclNum;
 
 #endif // BC_ENABLE_MEMCHECK
 
+// The cancellation flag is set from other threads. Where the compiler has
+// atomic builtins, they are used so that is not a data race.
+#if defined(__GNUC__) || defined(__clang__)
+#define BCL_ATOMIC_SET(p, v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#define BCL_ATOMIC_GET(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+#else // defined(__GNUC__) || defined(__clang__)
+#define BCL_ATOMIC_SET(p, v) (*(p) = (v))
+#define BCL_ATOMIC_GET(p) (*(p))
+#endif // defined(__GNUC__) || defined(__clang__)
+
 /**
- * A header that sets a jump.
+ * A header that sets a jump. It also starts a new call as far as cancellation
+ * and deadlines are concerned.
  * @param vm  The thread data.
  * @param l   The label to jump to on error.
  */
-#define BC_FUNC_HEADER(vm, l)     \
-	do                            \
-	{                             \
-		BC_SETJMP(vm, l);         \
-		vm->err = BCL_ERROR_NONE; \
-	}                             \
+#define BC_FUNC_HEADER(vm, l)           \
+	do                                  \
+	{                                   \
+		BC_SETJMP(vm, l);               \
+		vm->err = BCL_ERROR_NONE;       \
+		BCL_ATOMIC_SET(&vm->cancel, 0); \
+		vm->call_start = 0;             \
+		vm->poll = 1;                   \
+	}                                   \
 	while (0)
 
 /**
- * A footer for functions that do not return an error code.
+ * A footer for functions that do not return an error code. If there was an
+ * error, the jump ended here, so the unwinding is stopped.
  */
 #define BC_FUNC_FOOTER_NO_ERR(vm) \
 	do                            \
 	{                             \
 		BC_UNSETJMP(vm);          \
+		vm->sig_pop = 0;          \
 	}                             \
 	while (0)
 
@@ -358,6 +374,110 @@ typedef BcNum BclNum;
 void
 bcl_num_destruct(void* num);
 
+/// The amount of work, roughly in limb operations, that long-running math does
+/// between the checks for cancellation and deadlines.
+#define BCL_POLL_STEPS (1 << 16)
+
+/**
+ * Counts down the work done by a step of a long-running loop and checks for
+ * cancellation and deadlines when the count runs out. This must only be used
+ * where a jump is safe, which is anywhere an allocation could happen.
+ * @param vm    The thread data.
+ * @param work  The work done by the step, roughly in limb operations. This is
+ *              evaluated more than once, so it must not have side effects.
+ */
+#define BCL_POLL(vm, work)                                   \
+	do                                                       \
+	{                                                        \
+		if (BC_UNLIKELY((vm)->poll <= (work))) bcl_poll(vm); \
+		else (vm)->poll -= (work);                           \
+	}                                                        \
+	while (0)
+
+/**
+ * Checks whether the current call has been cancelled or is past its deadline,
+ * and if so, jumps with BCL_ERROR_SIGNAL. This also resets the count for
+ * BCL_POLL().
+ * @param vm  The thread data.
+ */
+void
+bcl_poll(BcVm* vm);
+
+/// The size of the first chunk of an arena if the client does not give one.
+#define BCL_ARENA_DEF_SIZE (1 << 16)
+
+/**
+ * A chunk of memory in an arena. The memory that is handed out follows the
+ * header.
+ */
+typedef struct BclArenaChunk
+{
+	/// The next chunk, or NULL if this is the last one.
+	struct BclArenaChunk* next;
+
+	/// The number of bytes after the header.
+	size_t cap;
+
+} BclArenaChunk;
+
+/**
+ * Returns a pointer to the memory of a chunk in an arena.
+ * @param c  The chunk.
+ * @return   A pointer to the memory of @a c, as a char pointer.
+ */
+#define BCL_ARENA_DATA(c) ((char*) ((c) + 1))
+
+/**
+ * An arena for the limbs of the numbers in a context. Memory is handed out from
+ * the current chunk by bumping a pointer, and freeing is a no-op unless it is
+ * the last thing that was handed out. Resetting goes back to the first chunk,
+ * and chunks are kept and reused until the arena is freed.
+ */
+typedef struct BclArena
+{
+	/// The first chunk, or NULL if the context does not use an arena.
+	BclArenaChunk* first;
+
+	/// The chunk that memory is being handed out from.
+	BclArenaChunk* cur;
+
+	/// The number of bytes of the current chunk that have been handed out.
+	size_t used;
+
+} BclArena;
+
+/**
+ * Allocates memory from an arena. This is like bc_vm_malloc().
+ * @param a     The arena.
+ * @param size  The number of bytes to allocate.
+ * @return      The memory.
+ */
+void*
+bcl_arena_malloc(BclArena* a, size_t size);
+
+/**
+ * Reallocates memory from an arena. This is like bc_vm_realloc(), except that
+ * the old size must be given. Unless @a ptr is the last allocation, the old
+ * memory is not reused until the arena is reset.
+ * @param a        The arena.
+ * @param ptr      The memory to reallocate, or NULL.
+ * @param oldsize  The size of @a ptr.
+ * @param size     The new size.
+ * @return         The memory.
+ */
+void*
+bcl_arena_realloc(BclArena* a, void* ptr, size_t oldsize, size_t size);
+
+/**
+ * Frees memory from an arena. This only does anything if @a ptr is the last
+ * allocation from the arena.
+ * @param a     The arena.
+ * @param ptr   The memory to free.
+ * @param size  The size of @a ptr.
+ */
+void
+bcl_arena_free(BclArena* a, void* ptr, size_t size);
+
 /// The actual context struct.
 typedef struct BclCtxt
 {
@@ -370,6 +490,13 @@ typedef struct BclCtxt
 	/// The context's obase.
 	size_t obase;
 
+	/// True if the context is in fixed-scale mode, where multiply and divide
+	/// use native 128-bit math when they can.
+	bool fixed;
+
+	/// The most time, in nanoseconds, that a call may take, or 0 for no limit.
+	uint64_t deadline;
+
 	/// A vector of BcNum numbers.
 	BcVec nums;
 
@@ -377,8 +504,109 @@ typedef struct BclCtxt
 	/// not used (because they were freed).
 	BcVec free_nums;
 
+	/// A scratch number for operations whose destination is also an operand.
+	/// Its limbs are swapped with the destination's after the operation.
+	BcNum scratch;
+
+	/// The stack of BcNums for evaluating compiled expressions. The numbers are
+	/// kept between evaluations so their limbs can be reused.
+	BcVec expr_stack;
+
+	/// The arena that the limbs of all numbers in the context come from, if
+	/// the context was created with bcl_ctxt_create_arena().
+	BclArena arena;
+
 } BclCtxt;
 
+/// The maximum nesting depth of parentheses and unary minus in a compiled
+/// expression. This keeps the compiler's recursion bounded.
+#define BCL_EXPR_MAX_DEPTH (1 << 10)
+
+/**
+ * A compiled expression. Once it is compiled, nothing in it is changed, so it
+ * can be evaluated by multiple threads at once.
+ */
+typedef struct BclExpression
+{
+	/// The bytecode. It uses the bc instructions for constants (BC_INST_NUM),
+	/// arguments (BC_INST_VAR), and the operators, with indices encoded like
+	/// in bc.
+	BcVec code;
+
+	/// The constants, already parsed.
+	BcVec consts;
+
+	/// The number of arguments the expression takes.
+	size_t nargs;
+
+	/// The maximum number of items on the stack during evaluation.
+	size_t depth;
+
+} BclExpression;
+
+/**
+ * The state of the expression compiler. It only lives as long as a call to
+ * bcl_expr_compile().
+ */
+typedef struct BclExprParser
+{
+	/// The current position in the source.
+	const char* s;
+
+	/// The expression being compiled.
+	BclExpression* e;
+
+	/// The names of the arguments, as pointers into the source, in the order
+	/// they were first seen.
+	BcVec names;
+
+	/// The number of items that would be on the stack at this point.
+	size_t sp;
+
+	/// The current nesting depth of parentheses.
+	size_t nest;
+
+	/// The ibase to parse constants with.
+	size_t ibase;
+
+} BclExprParser;
+
+// If the compiler has native thread-local storage, the thread data is also kept
+// there, which makes getting it a load instead of a call into pthreads, and
+// every bcl function gets it at least once. Define BC_ENABLE_THREAD_LOCAL to 0
+// to use only the thread-specific data from the OS.
+#ifndef BC_ENABLE_THREAD_LOCAL
+#define BC_ENABLE_THREAD_LOCAL (1)
+#endif // BC_ENABLE_THREAD_LOCAL
+
+#if BC_ENABLE_THREAD_LOCAL && !defined(BCL_THREAD_LOCAL)
+#if defined(__GNUC__) || defined(__clang__)
+#define BCL_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#define BCL_THREAD_LOCAL __declspec(thread)
+#elif __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+#define BCL_THREAD_LOCAL _Thread_local
+#endif
+#endif // BC_ENABLE_THREAD_LOCAL && !defined(BCL_THREAD_LOCAL)
+
+#ifdef BCL_THREAD_LOCAL
+
+/// The thread data for the current thread, or NULL if bcl has not been
+/// initialized on it. This mirrors the thread-specific data.
+extern BCL_THREAD_LOCAL BcVm* bcl_vm;
+
+/**
+ * Returns the @a BcVm for the current thread.
+ * @return  The vm for the current thread.
+ */
+static inline BcVm*
+bcl_getspecific(void)
+{
+	return bcl_vm;
+}
+
+#else // BCL_THREAD_LOCAL
+
 /**
  * Returns the @a BcVm for the current thread.
  * @return  The vm for the current thread.
@@ -386,14 +614,126 @@ typedef struct BclCtxt
 BcVm*
 bcl_getspecific(void);
 
+#endif // BCL_THREAD_LOCAL
+
 #ifndef _WIN32
 
 typedef pthread_key_t BclTls;
+typedef pthread_mutex_t BclMutex;
+typedef pthread_cond_t BclCond;
+typedef pthread_t BclWorker;
+
+#define BCL_MUTEX_INIT PTHREAD_MUTEX_INITIALIZER
+#define BCL_COND_INIT PTHREAD_COND_INITIALIZER
+
+#define BCL_LOCK(m) pthread_mutex_lock(m)
+#define BCL_UNLOCK(m) pthread_mutex_unlock(m)
+#define BCL_WAIT(c, m) pthread_cond_wait((c), (m))
+#define BCL_SIGNAL(c) pthread_cond_signal(c)
+#define BCL_BROADCAST(c) pthread_cond_broadcast(c)
 
 #else // _WIN32
 
 typedef DWORD BclTls;
+typedef SRWLOCK BclMutex;
+typedef CONDITION_VARIABLE BclCond;
+typedef HANDLE BclWorker;
+
+#define BCL_MUTEX_INIT SRWLOCK_INIT
+#define BCL_COND_INIT CONDITION_VARIABLE_INIT
+
+#define BCL_LOCK(m) AcquireSRWLockExclusive(m)
+#define BCL_UNLOCK(m) ReleaseSRWLockExclusive(m)
+#define BCL_WAIT(c, m) SleepConditionVariableSRW((c), (m), INFINITE, 0)
+#define BCL_SIGNAL(c) WakeConditionVariable(c)
+#define BCL_BROADCAST(c) WakeAllConditionVariable(c)
 
 #endif // _WIN32
 
+#if BC_ENABLE_LIBRARY
+
+/// The most operands any job takes.
+#define BCL_JOB_MAX_ARGS (3)
+
+/**
+ * A job that is done by a worker thread. Everything in it belongs to the
+ * worker from when it is submitted until it is done, and to the thread that
+ * waits on it after that.
+ */
+typedef struct BclTask
+{
+	/// The next job in the queue.
+	struct BclTask* next;
+
+	/// The operation.
+	BclJobOp op;
+
+	/// The function for binary operations, already adjusted for fixed-scale
+	/// mode.
+	BcNumBinaryOp fn;
+
+	/// The function to get the size of the result of a binary operation.
+	BcNumBinaryOpReq req;
+
+	/// The scale of the context the job was submitted from.
+	size_t scale;
+
+	/// The deadline of the context the job was submitted from.
+	uint64_t deadline;
+
+	/// Copies of the operands. They are not from any arena.
+	BcNum args[BCL_JOB_MAX_ARGS];
+
+	/// The result. It is not from any arena.
+	BcNum res;
+
+	/// The error, if any.
+	BclError err;
+
+	/// True once a worker is done with the job.
+	bool done;
+
+} BclTask;
+
+/**
+ * The pool of worker threads for jobs. There is one for the whole process, and
+ * it is started by the first job. Every worker has its own BcVm.
+ */
+typedef struct BclJobPool
+{
+	/// The lock for everything else in the pool and the jobs.
+	BclMutex lock;
+
+	/// Signaled when a job is queued or the workers should stop.
+	BclCond work;
+
+	/// Broadcast when a job is done.
+	BclCond done;
+
+	/// The first job in the queue, or NULL if the queue is empty.
+	BclTask* head;
+
+	/// The last job in the queue.
+	BclTask* tail;
+
+	/// The worker threads, or NULL if they have not been started.
+	BclWorker* threads;
+
+	/// The number of worker threads.
+	size_t nthreads;
+
+	/// True if the workers should exit once the queue is empty.
+	bool stop;
+
+} BclJobPool;
+
+/**
+ * Stops the worker threads for jobs, if they were started. This waits for the
+ * jobs in the queue to be done.
+ */
+void
+bcl_jobs_stop(void);
+
+#endif // BC_ENABLE_LIBRARY
+
 #endif // LIBBC_PRIVATE_H
@@ -165,6 +165,9 @@ struct BcRNG;
 /// The base for printing streams from numbers.
 #define BC_NUM_STREAM_BASE (256)
 
+/// The size of the buffer that decimal digits are put in before printing.
+#define BC_NUM_PRINT_BUF_SIZE (512)
+
 // This sets a default for the Karatsuba length.
 #ifndef BC_NUM_KARATSUBA_LEN
 #define BC_NUM_KARATSUBA_LEN (BC_NUM_BIGDIG_C(32))
@@ -814,6 +817,16 @@ bc_num_cmpZero(const BcNum* n);
 bool
 bc_num_strValid(const char* restrict val);
 
+/**
+ * Check a number string of a known length for validity. This is the same as
+ * bc_num_strValid(), but the string does not need to be nul-terminated.
+ * @param val  The string to check.
+ * @param len  The length of the string.
+ * @return     True if the string is a valid number, false otherwise.
+ */
+bool
+bc_num_strValidLen(const char* restrict val, size_t len);
+
 /**
  * Parses a number string into the number @a n according to @a base.
  * @param n     The number to set to the parsed value.
@@ -823,6 +836,18 @@ bc_num_strValid(const char* restrict val);
 void
 bc_num_parse(BcNum* restrict n, const char* restrict val, BcBigDig base);
 
+/**
+ * Parses a number string of a known length into the number @a n according to
+ * @a base. The string does not need to be nul-terminated.
+ * @param n     The number to set to the parsed value.
+ * @param val   The number string to parse.
+ * @param len   The length of the number string.
+ * @param base  The base to parse the number string by.
+ */
+void
+bc_num_parseLen(BcNum* restrict n, const char* restrict val, size_t len,
+                BcBigDig base);
+
 /**
  * Prints the number @a n according to @a base.
  * @param n        The number to print.
@@ -833,6 +858,107 @@ bc_num_parse(BcNum* restrict n, const char* restrict val, BcBigDig base);
 void
 bc_num_print(BcNum* restrict n, BcBigDig base, bool newline);
 
+#if BC_ENABLE_LIBRARY
+
+/**
+ * Returns the exact number of characters bc_num_decimalStr() will write for
+ * @a n, not counting a nul terminator.
+ * @param n  The number.
+ * @return   The length of @a n as a decimal string.
+ */
+size_t
+bc_num_decimalLen(const BcNum* restrict n);
+
+/**
+ * Writes @a n as a decimal string into @a buf, the same as bc_num_print() would
+ * print it in base 10 without a newline. This does not write a nul terminator.
+ * @param n    The number.
+ * @param buf  The buffer to write into. It must have room for at least
+ *             bc_num_decimalLen(n) characters.
+ * @return     The number of characters written.
+ */
+size_t
+bc_num_decimalStr(const BcNum* restrict n, char* restrict buf);
+
+/**
+ * Sets @a n to the integer in an array of bytes.
+ * @param n          The number to set. It must be initialized.
+ * @param bytes      The bytes.
+ * @param len        The number of bytes.
+ * @param bigEndian  True if the most significant byte is first, false if it is
+ *                   last.
+ * @param twosComp   True if the bytes are a two's complement number, false if
+ *                   they are a magnitude.
+ */
+void
+bc_num_fromBytes(BcNum* restrict n, const uchar* restrict bytes, size_t len,
+                 bool bigEndian, bool twosComp);
+
+/**
+ * Writes the integer part of @a n into an array of bytes. This does not check
+ * the sign of @a n; if it is negative, @a twosComp must be true.
+ * @param n          The number to write.
+ * @param temp       A number to use as scratch space. It must be initialized or
+ *                   cleared.
+ * @param bytes      The bytes to write into.
+ * @param len        The number of bytes.
+ * @param bigEndian  True if the most significant byte is first, false if it is
+ *                   last.
+ * @param twosComp   True to write a two's complement number, false to write a
+ *                   magnitude.
+ * @return           True if the number fit, false otherwise.
+ */
+bool
+bc_num_toBytes(const BcNum* restrict n, BcNum* restrict temp,
+               uchar* restrict bytes, size_t len, bool bigEndian, bool twosComp);
+
+/**
+ * Sets @a n to the value of a double, exactly, except that it is truncated to
+ * @a scale decimal places.
+ * @param n      The number to set. It must be initialized.
+ * @param val    The double.
+ * @param scale  The maximum scale of the result.
+ * @return       True if @a val was finite, false otherwise.
+ */
+bool
+bc_num_fromDouble(BcNum* restrict n, double val, size_t scale);
+
+/**
+ * Converts @a n to the nearest double.
+ * @param n       The number to convert.
+ * @param result  The return parameter for the double.
+ * @return        True if @a n is in range for a double, false otherwise.
+ */
+bool
+bc_num_toDouble(const BcNum* restrict n, double* restrict result);
+
+/**
+ * The multiply function for the fixed-scale mode of bcl. The result is the same
+ * as bc_num_mul(), but when the operands and the product are small enough, the
+ * math is done on native 128-bit integers, and there is no allocation unless
+ * @a c is too small. Otherwise, this is just bc_num_mul(). This is a
+ * BcNumBinaryOp function.
+ * @param a      The first parameter.
+ * @param b      The second parameter.
+ * @param c      The return parameter.
+ * @param scale  The current scale.
+ */
+void
+bc_num_mulFixed(BcNum* a, BcNum* b, BcNum* c, size_t scale);
+
+/**
+ * The fixed-scale version of bc_num_div(). See bc_num_mulFixed(). This is a
+ * BcNumBinaryOp function.
+ * @param a      The first parameter.
+ * @param b      The second parameter.
+ * @param c      The return parameter.
+ * @param scale  The current scale.
+ */
+void
+bc_num_divFixed(BcNum* a, BcNum* b, BcNum* c, size_t scale);
+
+#endif // BC_ENABLE_LIBRARY
+
 /**
  * Invert @a into @a b at the current scale.
  * @param a      The number to invert.
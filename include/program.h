@@ -64,6 +64,48 @@
 /// The length of the globals array.
 #define BC_PROG_GLOBALS_LEN (3 + BC_ENABLE_EXTRA_MATH)
 
+#if BC_ENABLED
+
+/// A memoized call of a bc function. Memos are kept in a fixed-size vector and
+/// linked into both a hash table chain and a least-recently-used list by index.
+typedef struct BcMemo
+{
+	/// The key, which is the function index, the globals, and the arguments,
+	/// all as bytes.
+	BcVec key;
+
+	/// The hash of the key.
+	size_t hash;
+
+	/// The result of the call.
+	BcNum res;
+
+	/// The index of the next memo in the same hash table chain.
+	size_t chain;
+
+	/// The index of the next more recently used memo.
+	size_t prev;
+
+	/// The index of the next less recently used memo.
+	size_t next;
+
+} BcMemo;
+
+/// A call that missed the memoization cache and is waiting for its result.
+typedef struct BcMemoCall
+{
+	/// The length of the execution stack while the call executes. When a
+	/// function returns with the execution stack at this length, the result is
+	/// the result of this call.
+	size_t depth;
+
+	/// The start of the call's key in the memo_keys vector in BcProgram.
+	size_t start;
+
+} BcMemoCall;
+
+#endif // BC_ENABLED
+
 typedef struct BcProgram
 {
 	/// The array of globals values.
@@ -93,7 +135,7 @@ typedef struct BcProgram
 	BcVec consts;
 
 	/// The map of constants to go with consts.
-	BcVec const_map;
+	BcMap const_map;
 
 	/// The strings encountered in the program. They are global to the program
 	/// to prevent bad accesses when functions that used non-auto variables are
@@ -101,25 +143,25 @@ typedef struct BcProgram
 	BcVec strs;
 
 	/// The map of strings to go with strs.
-	BcVec str_map;
+	BcMap str_map;
 
 	/// The array of functions.
 	BcVec fns;
 
 	/// The map of functions to go with fns.
-	BcVec fn_map;
+	BcMap fn_map;
 
 	/// The array of variables.
 	BcVec vars;
 
 	/// The map of variables to go with vars.
-	BcVec var_map;
+	BcMap var_map;
 
 	/// The array of arrays.
 	BcVec arrs;
 
 	/// The map of arrays to go with arrs.
-	BcVec arr_map;
+	BcMap arr_map;
 
 #if DC_ENABLED
 
@@ -131,6 +173,51 @@ typedef struct BcProgram
 
 #endif // DC_ENABLED
 
+#if BC_ENABLED
+
+	/// The locations (as BcLoc's, without the element index) of array
+	/// parameters that were passed by value but have not been copied yet. See
+	/// the development manual (manuals/development.md#copy-on-write-arrays) for
+	/// more information. This is only used in bc.
+	BcVec arr_cows;
+
+	/// A pool of numbers from parameters and autos of functions that have
+	/// returned. Calls reuse them instead of allocating. This is only used in
+	/// bc.
+	BcVec num_pool;
+
+	/// A pool of arrays from array autos of functions that have returned. Calls
+	/// reuse them instead of allocating. This is only used in bc.
+	BcVec arr_pool;
+
+	/// The memoization cache of function results, as BcMemo's. This is only
+	/// used in bc, and only with the memoize option.
+	BcVec memos;
+
+	/// The hash table of the memoization cache. Each slot has the index of the
+	/// first memo in its chain. This is NULL until the first memo is added.
+	size_t* memo_slots;
+
+	/// The most recently used memo.
+	size_t memo_head;
+
+	/// The least recently used memo, which is the next to be evicted.
+	size_t memo_tail;
+
+	/// The keys of calls that missed the memoization cache, concatenated.
+	BcVec memo_keys;
+
+	/// The calls that missed the memoization cache, as BcMemoCall's.
+	BcVec memo_calls;
+
+#endif // BC_ENABLED
+
+#if BC_ENABLE_IMAGES
+	/// The functions of an image loaded with bc_program_readImage(). Stubs
+	/// point into this array.
+	BcImageFunc* img_fns;
+#endif // BC_ENABLE_IMAGES
+
 	/// A BcNum that has the proper base for asciify.
 	BcNum strmb;
 
@@ -152,6 +239,229 @@ typedef struct BcProgram
 
 } BcProgram;
 
+#if BC_ENABLED
+
+/// The maximum number of items in each of the pools of numbers and arrays for
+/// function parameters and autos.
+#define BC_PROG_POOL_MAX (1 << 6)
+
+/// The maximum capacity of numbers kept in the pool of numbers for function
+/// parameters and autos. This keeps the memory held by the pool bounded.
+#define BC_PROG_POOL_NUM_CAP (BC_NUM_DEF_SIZE << 5)
+
+/// The maximum number of memos in the memoization cache.
+#define BC_PROG_MEMO_MAX (1 << 10)
+
+/// The number of slots in the hash table of the memoization cache. This must be
+/// a power of two.
+#define BC_PROG_MEMO_SLOTS (BC_PROG_MEMO_MAX << 1)
+
+/// The maximum length, in limbs, of results and of all of the arguments of a
+/// call in the memoization cache. This keeps the memory held by the cache
+/// bounded.
+#define BC_PROG_MEMO_MAX_LEN (1 << 10)
+
+/// The marker byte at the start of a reference vector that marks it as a
+/// copy-on-write array instead of a reference. No index can start with this
+/// byte because the first byte of an index is its length in bytes.
+#define BC_PROG_ARR_COW (UCHAR_MAX)
+
+/**
+ * Returns true if the array @a a (the item on an array stack) is a copy-on-write
+ * array, false otherwise.
+ * @param a  The array to test.
+ * @return   True if @a a is a copy-on-write array, false otherwise.
+ */
+#define BC_PROG_ARR_IS_COW(a) \
+	((a)->size == sizeof(uchar) && ((uchar) (a)->v[0]) == BC_PROG_ARR_COW)
+
+#if BC_ENABLE_IMAGES
+
+/// A program image. This is what the parser leaves in a BcProgram after parsing,
+/// either a math library, generated at build time by gen/libimg.c, or whatever
+/// was defined before --save-image saved it to a file. All of the names are in
+/// the order that the parser inserted them, so inserting them in the same order
+/// gives them the indices that the bytecode uses.
+typedef struct BcImage
+{
+	/// The functions defined by the library, starting after any functions that
+	/// were already in the program.
+	const BcImageFunc* fns;
+
+	/// The number of functions.
+	size_t fns_len;
+
+	/// The code that the library adds to the main function.
+	BcImageFunc main;
+
+	/// The names of the variables that the library adds.
+	const char* const* vars;
+
+	/// The number of variables.
+	size_t vars_len;
+
+	/// The names of the arrays that the library adds.
+	const char* const* arrs;
+
+	/// The number of arrays.
+	size_t arrs_len;
+
+	/// The strings that the library adds.
+	const char* const* strs;
+
+	/// The number of strings.
+	size_t strs_len;
+
+	/// The constants that the library adds.
+	const char* const* consts;
+
+	/// The number of constants.
+	size_t consts_len;
+
+} BcImage;
+
+#if BC_ENABLE_LIB_IMAGE
+
+// The images of the math libraries. The image of the second library only holds
+// what it adds to the first.
+extern const BcImage bc_lib_img;
+#if BC_ENABLE_EXTRA_MATH
+extern const BcImage bc_lib2_img;
+#endif // BC_ENABLE_EXTRA_MATH
+
+#endif // BC_ENABLE_LIB_IMAGE
+
+/// The magic bytes at the start of an image file.
+#define BC_IMAGE_MAGIC ("bc image")
+
+/// The version of the format of image files. This must be incremented every
+/// time the format changes.
+#define BC_IMAGE_VERSION (1)
+
+/// The build of bc that an image file is for. Image files are in the native
+/// byte order and use the native sizes, and the bytecode depends on how bc was
+/// configured, so they can only be loaded by the same build that saved them.
+/// This, the version of bc, and the byte order of the format version catch
+/// most mismatches.
+#define BC_IMAGE_BUILD                                                    \
+	((sizeof(size_t) << 24) | (sizeof(BcDig) << 16) | (sizeof(BcAuto) << 8) | \
+	 BC_INST_INVALID)
+
+/// The flag in an image file that says that it has the math library.
+#define BC_IMAGE_FLAG_LIB ((size_t) 1)
+
+/// The length value of a number in an image file that is really a string. The
+/// scale is the index of the string.
+#define BC_IMAGE_STR (SIZE_MAX)
+
+/// The header of an image file. All offsets are from the start of the file, and
+/// everything in the file is aligned to a size_t, so that the file can be mapped
+/// into memory and used in place.
+///
+/// After the header are the function records, then the names of the variables,
+/// arrays, strings, and constants, each nul-terminated, and then the values.
+/// The bytecode, labels, and autos of the functions are between the records and
+/// the names.
+typedef struct BcImageHeader
+{
+	/// The magic bytes, BC_IMAGE_MAGIC.
+	char magic[8];
+
+	/// The version of the format, BC_IMAGE_VERSION.
+	size_t version;
+
+	/// The build, BC_IMAGE_BUILD.
+	size_t build;
+
+	/// The version of bc, BC_VERSION.
+	char bc_version[16];
+
+	/// The flags.
+	size_t flags;
+
+	/// The length of the file.
+	size_t len;
+
+	/// The values of ibase, obase, and scale, in that order.
+	size_t globals[3];
+
+	/// The offset and number of the function records.
+	size_t fns;
+	size_t fns_len;
+
+	/// The offset of the names and their numbers.
+	size_t names;
+	size_t vars_len;
+	size_t arrs_len;
+	size_t strs_len;
+	size_t consts_len;
+
+	/// The offset and number of the values.
+	size_t vals;
+	size_t vals_len;
+
+} BcImageHeader;
+
+/// A function in an image file. This becomes a BcImageFunc when the file is
+/// loaded.
+typedef struct BcImageRecord
+{
+	/// The offset of the name.
+	size_t name;
+
+	/// The offset and length of the bytecode.
+	size_t code;
+	size_t code_len;
+
+	/// The offset and number of the labels.
+	size_t labels;
+	size_t labels_len;
+
+	/// The offset and number of the autos and parameters.
+	size_t autos;
+	size_t autos_len;
+
+	/// The number of parameters.
+	size_t nparams;
+
+	/// Non-zero if the function is a void function.
+	size_t voidfn;
+
+} BcImageRecord;
+
+/// The value of a variable or an array in an image file. The numbers follow
+/// it, each as a BcImageNum followed by its limbs, padded to a size_t.
+typedef struct BcImageVal
+{
+	/// The type, either BC_TYPE_VAR or BC_TYPE_ARRAY.
+	size_t type;
+
+	/// The index of the variable or array.
+	size_t idx;
+
+	/// The number of numbers, which is 1 for a variable.
+	size_t len;
+
+} BcImageVal;
+
+/// A number in an image file. These are the fields of a BcNum.
+typedef struct BcImageNum
+{
+	/// The rdx, with the sign in the low bit.
+	size_t rdx;
+
+	/// The scale, or the index if this is a string.
+	size_t scale;
+
+	/// The number of limbs, or BC_IMAGE_STR for a string.
+	size_t len;
+
+} BcImageNum;
+
+#endif // BC_ENABLE_IMAGES
+
+#endif // BC_ENABLED
+
 /**
  * Returns true if the stack @a s has at least @a n items, false otherwise.
  * @param s  The stack to check.
@@ -378,6 +688,40 @@ bc_program_addString(BcProgram* p, const char* str);
 size_t
 bc_program_insertFunc(BcProgram* p, const char* name);
 
+#if BC_ENABLE_IMAGES
+
+/**
+ * Loads a program image into the program, leaving it as if what made the image
+ * had been parsed.
+ * @param p    The program.
+ * @param img  The image to load.
+ */
+void
+bc_program_loadImage(BcProgram* p, const BcImage* img);
+
+/**
+ * Serializes the functions, names, and values of a program into the contents
+ * of an image file. The program must not be executing anything.
+ * @param p      The program.
+ * @param buf    The vector of chars to put the contents in. It must be empty.
+ * @param flags  The flags of the image.
+ */
+void
+bc_program_saveImage(BcProgram* p, BcVec* buf, size_t flags);
+
+/**
+ * Loads the contents of an image file into a fresh program. The functions are
+ * stubs that point into @a img, so it must outlive the program. The header must
+ * have been checked by the caller, but everything else is checked here.
+ * @param p    The program.
+ * @param img  The contents of the image file, aligned to a size_t.
+ * @return     True if the image was valid, false otherwise.
+ */
+bool
+bc_program_readImage(BcProgram* p, const char* img);
+
+#endif // BC_ENABLE_IMAGES
+
 /**
  * Resets a program, usually because of resetting after an error.
  * @param p  The program to reset.
@@ -48,6 +48,9 @@
  */
 #define BC_READ_BIN_CHAR(c) (!(c))
 
+/// The number of bytes that bc_read_stream() reads from a file at a time.
+#define BC_READ_STREAM_SIZE (1 << 16)
+
 /**
  * Reads a line from stdin after printing prompt, if desired.
  * @param vec     The vector to put the stdin data into.
@@ -64,6 +67,33 @@ bc_read_line(BcVec* vec, const char* prompt);
 char*
 bc_read_file(const char* path);
 
+/**
+ * Opens a file for reading. It is an error if the file cannot be opened or if
+ * it is a directory.
+ * @param path  The path to the file to open.
+ * @param size  An out parameter for the size of the file, or NULL if it is not
+ *              needed.
+ * @return      The file descriptor of the open file.
+ */
+int
+bc_read_openFile(const char* path, size_t* size);
+
+/**
+ * Reads the next piece of a file, which is made up of whole lines, and appends
+ * it to the string in @a vec. The data that is read past the last whole line is
+ * kept in @a rem for the next call. This is what keeps memory use bounded when
+ * processing big files.
+ * @param vec   The vector to append the piece to. It must hold a nul-terminated
+ *              string.
+ * @param rem   The vector for data that has been read but not appended yet.
+ * @param fd    A pointer to the file descriptor. When the end of the file is
+ *              reached, this is set to -1, but the file is not closed.
+ * @param path  The path to the file, for error messages.
+ * @return      True if anything was appended, false if the file was done.
+ */
+bool
+bc_read_stream(BcVec* vec, BcVec* rem, int* fd, const char* path);
+
 /**
  * Helper function for reading characters from stdin. This takes care of a bunch
  * of complex error handling. Thus, it returns a status instead of throwing an
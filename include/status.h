@@ -120,6 +120,37 @@
 #define BC_ENABLE_HISTORY (1)
 #endif // BC_ENABLE_HISTORY
 
+#ifndef BC_ENABLE_LIB_IMAGE
+#define BC_ENABLE_LIB_IMAGE (0)
+#endif // BC_ENABLE_LIB_IMAGE
+
+/// Whether program images are supported. Both the precompiled math library and
+/// the images of --save-image and --load-image use them, and only the bc
+/// executable has either. Image files are mapped into memory with mmap(), so
+/// they are not supported on Windows.
+#ifndef _WIN32
+#define BC_ENABLE_IMAGES (BC_ENABLED && !BC_ENABLE_LIBRARY)
+#else // _WIN32
+#define BC_ENABLE_IMAGES (0)
+#endif // _WIN32
+
+/// Whether the server and client modes of --server and --client are supported.
+/// They use Unix domain sockets and fork(), so they are not supported on
+/// Windows, and only the bc executable has them.
+#ifndef _WIN32
+#define BC_ENABLE_SERVER (BC_ENABLED && !BC_ENABLE_LIBRARY)
+#else // _WIN32
+#define BC_ENABLE_SERVER (0)
+#endif // _WIN32
+
+/// Whether --jobs is supported. The jobs are processes made with fork(), so it
+/// is not supported on Windows.
+#ifndef _WIN32
+#define BC_ENABLE_JOBS (!BC_ENABLE_LIBRARY)
+#else // _WIN32
+#define BC_ENABLE_JOBS (0)
+#endif // _WIN32
+
 #ifndef BC_ENABLE_EDITLINE
 #define BC_ENABLE_EDITLINE (0)
 #endif // BC_ENABLE_EDITLINE
@@ -679,6 +710,10 @@ typedef enum BcMode
 	/// stdin mode.
 	BC_MODE_STDIN,
 
+	/// Stream mode, which is for files read a piece at a time. Unlike file
+	/// mode, the lexer can ask for more data.
+	BC_MODE_STREAM,
+
 } BcMode;
 
 /// Do a longjmp(). This is what to use when activating an "exception", i.e., a
@@ -868,24 +903,28 @@ typedef enum BcMode
 #define BC_SIG_TRYUNLOCK(lock)
 #define BC_SIG_ASSERT_LOCKED
 
-/// Returns true if an exception is in flight, false otherwise.
-#define BC_SIG_EXC(vm) \
-	BC_UNLIKELY(vm->status != (sig_atomic_t) BC_STATUS_SUCCESS)
+/// Returns true if an exception is in flight, false otherwise. In the library,
+/// errors are reported in vm->err, not vm->status, so that is checked too.
+#define BC_SIG_EXC(vm)                                             \
+	BC_UNLIKELY(vm->status != (sig_atomic_t) BC_STATUS_SUCCESS || \
+	            vm->err != BCL_ERROR_NONE)
 
 /// Returns true if there is *no* exception in flight, false otherwise.
-#define BC_NO_SIG_EXC(vm) \
-	BC_LIKELY(vm->status == (sig_atomic_t) BC_STATUS_SUCCESS)
+#define BC_NO_SIG_EXC(vm)                                        \
+	BC_LIKELY(vm->status == (sig_atomic_t) BC_STATUS_SUCCESS && \
+	          vm->err == BCL_ERROR_NONE)
 
 /// Used after cleanup labels set by BC_SETJMP and BC_SETJMP_LOCKED to jump to
 /// the next place. This is what continues the stack unwinding. This basically
 /// copies BC_SIG_UNLOCK into itself, but that is because its condition for
-/// jumping is BC_SIG_EXC, not just that a signal happened.
-#define BC_LONGJMP_CONT(vm)         \
-	do                              \
-	{                               \
-		bc_vec_pop(&vm->jmp_bufs);  \
-		if (BC_SIG_EXC(vm)) BC_JMP; \
-	}                               \
+/// jumping is BC_SIG_EXC, not just that a signal happened. If a jump is in
+/// flight, bc_vm_jmp() pops the jmp_buf, so it must not be popped here too.
+#define BC_LONGJMP_CONT(vm)                          \
+	do                                               \
+	{                                                \
+		if (!vm->sig_pop) bc_vec_pop(&vm->jmp_bufs); \
+		if (BC_SIG_EXC(vm)) BC_JMP;                  \
+	}                                                \
 	while (0)
 
 #endif // !BC_ENABLE_LIBRARY
@@ -157,7 +157,8 @@ void
 bc_vec_expand(BcVec* restrict v, size_t req);
 
 /**
- * Grow a vector by at least @a n elements.
+ * Grow a vector so that it has room for at least @a n more elements. This does
+ * nothing if it already does.
  * @param v  The vector to grow.
  * @param n  The number of elements to grow the vector by.
  */
@@ -234,8 +235,7 @@ bc_vec_pushIndex(BcVec* restrict v, size_t idx);
 /**
  * Push an item onto the vector at a certain index. The index must be valid
  * (either exists or is equal to the length of the vector). The elements at that
- * index and after are moved back one element and kept in the same order. This
- * is how the map vectors are kept sorted.
+ * index and after are moved back one element and kept in the same order.
  * @param v     The vector to push onto.
  * @param data  A pointer to the data to push.
  * @param idx   The index to push at.
@@ -318,10 +318,69 @@ bc_vec_clear(BcVec* restrict v);
 void
 bc_vec_free(void* vec);
 
+/**
+ * Hashes bytes. This is used for the hash tables of maps, among other things.
+ * @param bytes  The bytes to hash.
+ * @param len    The number of bytes.
+ * @return       The hash of the bytes.
+ */
+size_t
+bc_vec_hash(const char* bytes, size_t len);
+
+/// The starting number of slots in a map's hash table. This must be a power of
+/// two.
+#define BC_MAP_START_SLOTS (BC_VEC_START_CAP << 1)
+
+/// A slot in the hash table of a map.
+typedef struct BcMapSlot
+{
+	/// The hash of the name in the slot. This is kept so that lookups only need
+	/// to compare strings when the hashes match and so that the table can be
+	/// grown without rehashing names.
+	size_t hash;
+
+	/// The index of the ID in the map's vector, or BC_VEC_INVALID_IDX if the
+	/// slot is empty.
+	size_t idx;
+
+} BcMapSlot;
+
+/// A map from names to indices. The IDs are kept in a vector in insertion order,
+/// which means that the index of an ID in the map never changes and is always
+/// the same as the index of the item in the partner array. Names are found with
+/// an open-addressed, linear-probed hash table whose slots point into the
+/// vector. Items are never removed from maps, so there are no tombstones.
+typedef struct BcMap
+{
+	/// The IDs, in insertion order.
+	BcVec ids;
+
+	/// The hash table. Its length is always a power of two.
+	BcMapSlot* slots;
+
+	/// The number of slots in the hash table.
+	size_t nslots;
+
+} BcMap;
+
+/**
+ * Initializes a map.
+ * @param m  The map to initialize.
+ */
+void
+bc_map_init(BcMap* restrict m);
+
+/**
+ * Frees a map. This does not free the names, which are owned by the slabs.
+ * @param m  The map to free.
+ */
+void
+bc_map_free(BcMap* restrict m);
+
 /**
  * Attempts to insert an ID into a map and returns true if it succeeded, false
  * if the item already exists.
- * @param v     The map vector to insert into.
+ * @param v     The map to insert into.
  * @param name  The name of the item to insert. This name is assumed to be owned
  *              by another entity.
  * @param idx   The index of the partner array where the actual item is.
@@ -330,30 +389,30 @@ bc_vec_free(void* vec);
  * @return      True if the item was inserted, false if the item already exists.
  */
 bool
-bc_map_insert(BcVec* restrict v, const char* name, size_t idx,
+bc_map_insert(BcMap* restrict v, const char* name, size_t idx,
               size_t* restrict i);
 
 /**
  * Returns the index of the item with @a name in the map, or BC_VEC_INVALID_IDX
  * if it doesn't exist.
- * @param v     The map vector.
+ * @param v     The map.
  * @param name  The name of the item to find.
  * @return      The index in the map of the item with @a name, or
  *              BC_VEC_INVALID_IDX if the item does not exist.
  */
 size_t
-bc_map_index(const BcVec* restrict v, const char* name);
+bc_map_index(const BcMap* restrict v, const char* name);
 
 #if DC_ENABLED
 
 /**
  * Returns the name of the item at index @a idx in the map.
- * @param v    The map vector.
+ * @param v    The map.
  * @param idx  The index.
  * @return     The name of the item at @a idx.
  */
 const char*
-bc_map_name(const BcVec* restrict v, size_t idx);
+bc_map_name(const BcMap* restrict v, size_t idx);
 
 #endif // DC_ENABLED
 
@@ -377,10 +436,17 @@ bc_map_name(const BcVec* restrict v, size_t idx);
 #define bc_vec_top(v) (bc_vec_item_rev((v), 0))
 
 /**
- * Initializes a vector to serve as a map.
- * @param v  The vector to initialize.
+ * Returns a pointer to the ID at index @a i in the map. The index must exist.
+ * @param m  The map.
+ * @param i  The index of the ID in the map.
+ */
+#define bc_map_item(m, i) ((BcId*) bc_vec_item(&(m)->ids, (i)))
+
+/**
+ * Returns the number of items in the map.
+ * @param m  The map.
  */
-#define bc_map_init(v) (bc_vec_init((v), sizeof(BcId), BC_DTOR_NONE))
+#define bc_map_len(m) ((m)->ids.len)
 
 /// A reference to the array of destructors.
 extern const BcVecFree bc_vec_dtors[];
@@ -178,6 +178,13 @@
 /// The flag for digit clamping.
 #define BC_FLAG_DIGIT_CLAMP (UINTMAX_C(1) << 14)
 
+#if BC_ENABLED
+
+/// The flag for the memoize option.
+#define BC_FLAG_M (UINTMAX_C(1) << 15)
+
+#endif // BC_ENABLED
+
 /// A convenience macro for getting the TTYIN flag.
 #define BC_TTYIN (vm->flags & BC_FLAG_TTYIN)
 
@@ -201,6 +208,9 @@
 /// A convenience macro for getting the global stacks flag.
 #define BC_G (vm->flags & BC_FLAG_G)
 
+/// A convenience macro for getting the memoize flag.
+#define BC_M (vm->flags & BC_FLAG_M)
+
 #endif // BC_ENABLED
 
 #if DC_ENABLED
@@ -465,11 +475,13 @@
 
 #else // BC_ENABLE_LINE_LIB
 
-/// The size of the global buffer.
-#define BC_VM_BUF_SIZE (1 << 12)
-
-/// The amount of the global buffer allocated to stdout.
-#define BC_VM_STDOUT_BUF_SIZE (1 << 11)
+// The amount of the global buffer allocated to stdout. This sets a default;
+// configure.sh can set another.
+#ifndef BC_VM_STDOUT_BUF_SIZE
+#define BC_VM_STDOUT_BUF_SIZE (1 << 16)
+#elif BC_VM_STDOUT_BUF_SIZE < 256
+#error BC_VM_STDOUT_BUF_SIZE must be at least 256.
+#endif // BC_VM_STDOUT_BUF_SIZE
 
 /// The amount of the global buffer allocated to stderr.
 #define BC_VM_STDERR_BUF_SIZE (1 << 10)
@@ -477,8 +489,19 @@
 /// The amount of the global buffer allocated to stdin.
 #define BC_VM_STDIN_BUF_SIZE (BC_VM_STDERR_BUF_SIZE - 1)
 
+/// The size of the global buffer.
+#define BC_VM_BUF_SIZE (BC_VM_STDOUT_BUF_SIZE + 2 * BC_VM_STDERR_BUF_SIZE)
+
 #endif // BC_ENABLE_LINE_LIB
 
+// The number of statements that bc parses before it runs them, when it can.
+// This sets a default; configure.sh can set another.
+#ifndef BC_VM_PARSE_AHEAD
+#define BC_VM_PARSE_AHEAD (64)
+#elif BC_VM_PARSE_AHEAD < 1
+#error BC_VM_PARSE_AHEAD must be at least 1.
+#endif // BC_VM_PARSE_AHEAD
+
 /// The max number of temporary BcNums that can be kept.
 #define BC_VM_MAX_TEMPS (1 << 9)
 
@@ -505,6 +528,45 @@
 #define BC_VM_MUL_OVERFLOW(a, b, r) \
 	((r) >= SIZE_MAX || ((a) != 0 && (r) / (a) != (b)))
 
+#if BC_ENABLE_IMAGES
+
+/// Returns true if a program image was loaded with --load-image.
+#define BC_VM_HAS_IMAGE (vm->image != NULL)
+
+#else // BC_ENABLE_IMAGES
+
+/// Returns true if a program image was loaded with --load-image.
+#define BC_VM_HAS_IMAGE (0)
+
+#endif // BC_ENABLE_IMAGES
+
+#if BC_ENABLE_SERVER
+
+/// Returns true if bc was told to run as a server with --server.
+#define BC_VM_IS_SERVER (vm->server != NULL)
+
+#else // BC_ENABLE_SERVER
+
+/// Returns true if bc was told to run as a server with --server.
+#define BC_VM_IS_SERVER (0)
+
+#endif // BC_ENABLE_SERVER
+
+#if BC_ENABLE_JOBS
+
+/// Returns true if the expressions and files run in jobs because of --jobs.
+#define BC_VM_HAS_JOBS (vm->jobs > 1)
+
+/// The size of the buffer that the output of jobs is read into.
+#define BC_VM_JOBS_BUF_SIZE (1 << 12)
+
+#else // BC_ENABLE_JOBS
+
+/// Returns true if the expressions and files run in jobs because of --jobs.
+#define BC_VM_HAS_JOBS (0)
+
+#endif // BC_ENABLE_JOBS
+
 /// The global vm struct. This holds all of the global data besides the file
 /// buffers.
 typedef struct BcVm
@@ -543,6 +605,17 @@ typedef struct BcVm
 	/// A buffer for read expressions.
 	BcVec read_buf;
 
+	/// A buffer for data that has been read from the current file but has not
+	/// been put in buffer yet because it is not a whole line.
+	BcVec file_buf;
+
+	/// The file descriptor of the current file, or -1 if it has all been read.
+	int file_fd;
+
+	/// True if stdin is read in blocks instead of lines because it is not
+	/// interactive. See bc_vm_stdin().
+	bool stdin_blocks;
+
 #endif // !BC_ENABLE_LIBRARY
 
 	/// A vector of jmp_bufs for doing a jump series. This allows exception-type
@@ -557,6 +630,10 @@ typedef struct BcVm
 	/// The vector of contexts for the library.
 	BcVec ctxts;
 
+	/// The arena of the current context, or NULL if the current context does
+	/// not have one. If it is not NULL, limbs are allocated from it.
+	struct BclArena* arena;
+
 	/// The vector for creating strings to pass to the client.
 	BcVec out;
 
@@ -583,6 +660,17 @@ typedef struct BcVm
 	/// The number of "references," or times that the library was initialized.
 	unsigned int refs;
 
+	/// Set by bcl_cancel(), possibly from another thread, to interrupt the
+	/// current call. It is cleared at the start of every call.
+	volatile sig_atomic_t cancel;
+
+	/// The work left before bcl_poll() is called.
+	size_t poll;
+
+	/// The time, in nanoseconds, when the current call was first polled, or 0
+	/// if it has not been yet.
+	uint64_t call_start;
+
 #else // BC_ENABLE_LIBRARY
 
 	/// A pointer to the filename of the current file. This is not owned by the
@@ -641,6 +729,17 @@ typedef struct BcVm
 	/// builtin math libraries for bc.
 	bool no_redefine;
 
+	/// True while the parser parses a statement after statements that were
+	/// parsed ahead and have not run yet. See bc_vm_runAhead().
+	bool ahead;
+
+	/// True if the statement being parsed has to run before the next one is
+	/// parsed.
+	bool ahead_stop;
+
+	/// The end of the code of the statements that were parsed ahead.
+	size_t ahead_end;
+
 #endif // BC_ENABLED
 
 	/// A vector of filenames to process.
@@ -649,6 +748,41 @@ typedef struct BcVm
 	/// A vector of expressions to process.
 	BcVec exprs;
 
+#if BC_ENABLE_JOBS
+
+	/// The index in exprs of the end of each -e and -f.
+	BcVec expr_ends;
+
+	/// The number of jobs to run at once with --jobs, or 0 if not given.
+	size_t jobs;
+
+#endif // BC_ENABLE_JOBS
+
+#if BC_ENABLE_IMAGES
+
+	/// The file to load a program image from, or NULL.
+	const char* load_image;
+
+	/// The file to save a program image to at the end of input, or NULL.
+	const char* save_image;
+
+	/// The contents of the loaded program image, which the program points into,
+	/// and its length.
+	char* image;
+	size_t image_len;
+
+#endif // BC_ENABLE_IMAGES
+
+#if BC_ENABLE_SERVER
+
+	/// The path of the socket to serve requests on, or NULL.
+	const char* server;
+
+	/// The path of the socket of the server to send the request to, or NULL.
+	const char* client;
+
+#endif // BC_ENABLE_SERVER
+
 	/// The name of the calculator under use. This is used by BC_IS_BC and
 	/// BC_IS_DC.
 	const char* name;
@@ -803,6 +937,19 @@ bc_vm_boot(int argc, char* argv[]);
 void
 bc_vm_init(void);
 
+#if BC_ENABLED && !BC_ENABLE_LIBRARY
+
+/**
+ * Loads a math library by parsing its text. This is also used by gen/libimg.c
+ * to generate the library images.
+ * @param name  The name of the library.
+ * @param text  The text of the source code.
+ */
+void
+bc_vm_load(const char* name, const char* text);
+
+#endif // BC_ENABLED && !BC_ENABLE_LIBRARY
+
 /**
  * Frees the BcVm global.
  */
@@ -844,11 +991,13 @@ bc_vm_freeTemps(void);
  * matter if history does not exist.
  */
 #define bc_vm_putchar(c, t) bc_vm_putchar_impl(c)
+#define bc_vm_write(s, n, t) bc_vm_write_impl(s, n)
 
 #else // !BC_ENABLE_HISTORY || BC_ENABLE_LINE_LIB || BC_ENABLE_LIBRARY
 
 // This is here to satisfy a clang warning about recursive macros.
 #define bc_vm_putchar(c, t) bc_vm_putchar_impl(c, t)
+#define bc_vm_write(s, n, t) bc_vm_write_impl(s, n, t)
 
 #endif // !BC_ENABLE_HISTORY || BC_ENABLE_LINE_LIB || BC_ENABLE_LIBRARY
 
@@ -867,6 +1016,16 @@ bc_vm_printf(const char* fmt, ...);
 void
 bc_vm_putchar(int c, BcFlushType type);
 
+/**
+ * Puts a string of chars, none of which may be newlines, into the stdout
+ * buffer all at once.
+ * @param str   The chars to put on the stdout buffer.
+ * @param len   The number of chars.
+ * @param type  The flush type.
+ */
+void
+bc_vm_write(const char* str, size_t len, BcFlushType type);
+
 /**
  * Multiplies @a n and @a size and throws an allocation error if overflow
  * occurs.
@@ -928,6 +1087,39 @@ bc_vm_readLine(bool clear);
 bool
 bc_vm_readBuf(bool clear);
 
+#if BC_ENABLED
+
+/**
+ * Runs the statements that were parsed ahead and have not run yet, if there are
+ * any. Anything that the parser does right away, such as errors, quit, and
+ * limits, must call this first so that it happens after those statements, like
+ * it would if they had run as soon as they were parsed.
+ */
+void
+bc_vm_runAhead(void);
+
+#endif // BC_ENABLED
+
+/**
+ * Reads the next piece of the current file into BcVm's buffer field.
+ * @param clear  True if the buffer should be cleared first, false otherwise.
+ * @return       True if anything was read, false otherwise.
+ */
+bool
+bc_vm_readFile(bool clear);
+
+/**
+ * Reads the line of stdin that comes after the one being parsed when stdin is
+ * read in blocks. This is for read(), which must get the same line that it
+ * would if stdin was read a line at a time. The line is taken out of BcVm's
+ * buffer field so that it is not parsed.
+ * @param vec  The vector to put the line in.
+ * @return     BC_STATUS_EOF if there are no more lines, BC_STATUS_SUCCESS
+ *             otherwise.
+ */
+BcStatus
+bc_vm_readNextLine(BcVec* vec);
+
 /**
  * A convenience and portability function for OpenBSD's pledge().
  * @param promises      The promises to pledge().
@@ -0,0 +1,177 @@
+/*
+ * *****************************************************************************
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2018-2024 Gavin D. Howard and contributors.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *****************************************************************************
+ *
+ * A tool to run a command and report how long it takes to print its first
+ * output, how long it takes to finish, and its peak resident memory. This is
+ * for benchmarking how quickly bc starts working on big files and how much
+ * memory it needs to do so. It can also feed the command a file on stdin and
+ * report throughput, for benchmarking piped input.
+ *
+ */
+
+// wait4() is not in POSIX, but it is the only way to get the resources used by
+// one child, and glibc needs this to declare it.
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+/**
+ * Abort with an error message.
+ * @param msg  The error message.
+ */
+static void
+err(const char* msg)
+{
+	perror(msg);
+	abort();
+}
+
+/**
+ * Returns the current time in seconds.
+ * @return  The current time in seconds.
+ */
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double) ts.tv_sec + (double) ts.tv_nsec / 1000000000.0;
+}
+
+/**
+ * Runs the command once and prints the time to the first output, the total
+ * time, and the peak RSS in kilobytes, in a format that ministat can digest.
+ * If @a exprs is not 0, the number of expressions per second is printed too.
+ * @param argv   The command and its arguments.
+ * @param input  The file to use as stdin, or /dev/null.
+ * @param exprs  The number of expressions in @a input.
+ */
+static void
+run(char* argv[], const char* input, long exprs)
+{
+	int fds[2], status;
+	pid_t pid;
+	double start, total, first = -1.0;
+	char buf[1 << 16];
+	ssize_t r;
+	struct rusage ru;
+
+	if (pipe(fds) < 0) err("pipe");
+
+	start = now();
+
+	pid = fork();
+	if (pid < 0) err("fork");
+
+	if (!pid)
+	{
+		int in = open(input, O_RDONLY);
+
+		if (in < 0 || dup2(in, STDIN_FILENO) < 0) err(input);
+		if (dup2(fds[1], STDOUT_FILENO) < 0) err("stdout");
+
+		close(fds[0]);
+		close(fds[1]);
+		close(in);
+
+		execvp(argv[0], argv);
+		err(argv[0]);
+	}
+
+	close(fds[1]);
+
+	// Read everything, but only time the first read.
+	while ((r = read(fds[0], buf, sizeof(buf))) != 0)
+	{
+		if (r < 0) err("read");
+		if (first < 0) first = now() - start;
+	}
+
+	close(fds[0]);
+
+	if (wait4(pid, &status, 0, &ru) < 0) err("wait4");
+	if (!WIFEXITED(status))
+	{
+		fprintf(stderr, "%s did not exit normally\n", argv[0]);
+		abort();
+	}
+
+	total = now() - start;
+
+	printf("%f %f %ld", first, total, (long) ru.ru_maxrss);
+	if (exprs) printf(" %.0f", (double) exprs / total);
+	printf("\n");
+}
+
+int
+main(int argc, char* argv[])
+{
+	int i, runs = 1, idx = 1;
+	long exprs = 0;
+	const char* input = "/dev/null";
+
+	for (; idx + 1 < argc && argv[idx][0] == '-'; idx += 2)
+	{
+		if (!strcmp(argv[idx], "-n")) runs = atoi(argv[idx + 1]);
+		else if (!strcmp(argv[idx], "-i")) input = argv[idx + 1];
+		else if (!strcmp(argv[idx], "-e")) exprs = atol(argv[idx + 1]);
+		else break;
+	}
+
+	if (idx >= argc || runs <= 0 || exprs < 0)
+	{
+		fprintf(stderr,
+		        "usage: %s [-n runs] [-i input] [-e exprs] command [args...]\n",
+		        argv[0]);
+		return 1;
+	}
+
+	fprintf(stderr, "first output (s), total (s), max RSS (KB)%s\n",
+	        exprs ? ", expressions/s" : "");
+
+	for (i = 0; i < runs; ++i)
+	{
+		run(argv + idx, input, exprs);
+	}
+
+	return 0;
+}
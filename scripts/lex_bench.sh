@@ -0,0 +1,148 @@
+#! /bin/sh
+#
+# SPDX-License-Identifier: BSD-2-Clause
+#
+# Copyright (c) 2018-2024 Gavin D. Howard and contributors.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# * Redistributions of source code must retain the above copyright notice, this
+#   list of conditions and the following disclaimer.
+#
+# * Redistributions in binary form must reproduce the above copyright notice,
+#   this list of conditions and the following disclaimer in the documentation
+#   and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+
+
+# This script benchmarks how fast bc lexes. It generates files that are almost
+# all big numbers, comments, or keywords and names in code that never runs, and
+# prints how many megabytes of each that bc gets through in a second, less the
+# time that bc takes to start. It depends on GNU date for the time in
+# nanoseconds, but I am okay with that because this script is only for
+# maintainers.
+
+# Just print the usage and exit with an error. This can receive a message to
+# print.
+# @param 1  A message to print.
+usage() {
+	if [ $# -eq 1 ]; then
+		printf '%s\n\n' "$1"
+	fi
+	printf 'usage: %s [-r<runs>] [-s<size>]\n' "$0" 1>&2
+	printf '    -r runs is how many times to run each file, default 5. The best\n'
+	printf '       time is used.\n'
+	printf '    -s size is about how many megabytes each file has, default 16.\n'
+	exit 1
+}
+
+script="$0"
+scriptdir=$(dirname "$script")
+
+. "$scriptdir/functions.sh"
+
+runs=5
+size=16
+
+# Process command-line arguments.
+while getopts "r:s:" opt; do
+
+	case "$opt" in
+		r) runs="$OPTARG" ;;
+		s) size="$OPTARG" ;;
+		?) usage "Invalid option: $opt" ;;
+	esac
+
+done
+
+bc="$scriptdir/../bin/bc"
+dir="$scriptdir/../lex_bench"
+
+mkdir -p "$dir"
+
+trap 'rm -rf "$dir"' EXIT
+
+bytes=$((size * 1000000))
+
+# Numbers with 100,000 digits. They are in if statements that are never true,
+# so that bc does not spend any time converting them.
+awk -v bytes="$bytes" 'BEGIN {
+	d = "1234567890"
+	while (length(d) < 100000) d = d d
+	d = substr(d, 1, 100000)
+	for (n = 0; n < bytes; n += 100000 + 12) print "if (0) x = " d
+}' > "$dir/numbers.bc"
+
+# Comments with 1,000 lines each.
+awk -v bytes="$bytes" 'BEGIN {
+	l = " * The quick brown fox jumps over the lazy dog, 0123456789 times."
+	for (n = 0; n < bytes; n += 1000 * (length(l) + 1) + 6) {
+		print "/*"
+		for (i = 0; i < 1000; ++i) print l
+		print " */"
+	}
+}' > "$dir/comments.bc"
+
+# Keywords and names, in a function that is never called.
+awk -v bytes="$bytes" 'BEGIN {
+	l = "\tif (scale(abc) < length(def)) return sqrt(ghi) + abs(jkl) + xyz"
+	print "define f(abc, def, ghi, jkl, xyz) {"
+	for (n = 0; n < bytes; n += length(l) + 1) print l
+	print "}"
+}' > "$dir/keywords.bc"
+
+printf 'halt\n' > "$dir/empty.bc"
+
+# Prints the best time, in nanoseconds, of running bc on a file.
+# @param 1  The file.
+best() {
+
+	_best_file="$1"
+	shift
+
+	_best_time=""
+
+	_best_i=0
+
+	while [ "$_best_i" -lt "$runs" ]; do
+
+		_best_start=$(date +%s%N)
+		"$bc" -q "$_best_file" "$dir/empty.bc" > /dev/null
+		_best_end=$(date +%s%N)
+
+		_best_t=$((_best_end - _best_start))
+
+		if [ -z "$_best_time" ] || [ "$_best_t" -lt "$_best_time" ]; then
+			_best_time="$_best_t"
+		fi
+
+		_best_i=$((_best_i + 1))
+	done
+
+	printf '%s\n' "$_best_time"
+}
+
+start=$(best "$dir/empty.bc")
+
+for f in numbers comments keywords; do
+
+	file="$dir/$f.bc"
+
+	t=$(best "$file")
+
+	printf '%-12s %s MB/s\n' "$f" \
+		"$(printf 'scale = 1; %s * 1000 / (%s - %s)\n' "$(wc -c < "$file")" \
+			"$t" "$start" | "$bc")"
+done
@@ -167,6 +167,7 @@ scripts/radamsa.txt
 scripts/randmath.py
 scripts/release_settings.txt
 scripts/release.sh
+scripts/server_bench.sh
 scripts/test_settings.sh
 scripts/test_settings.txt
 tests/bc_outputs/
@@ -0,0 +1,119 @@
+#! /bin/sh
+#
+# SPDX-License-Identifier: BSD-2-Clause
+#
+# Copyright (c) 2018-2024 Gavin D. Howard and contributors.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# * Redistributions of source code must retain the above copyright notice, this
+#   list of conditions and the following disclaimer.
+#
+# * Redistributions in binary form must reproduce the above copyright notice,
+#   this list of conditions and the following disclaimer in the documentation
+#   and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+
+
+# This script benchmarks the server mode of bc (--server and --client) against
+# starting a new bc for every request, the way that shell scripts usually use
+# bc. It depends on GNU date for the time in nanoseconds, but I am okay with
+# that because this script is only for maintainers.
+
+# Just print the usage and exit with an error. This can receive a message to
+# print.
+# @param 1  A message to print.
+usage() {
+	if [ $# -eq 1 ]; then
+		printf '%s\n\n' "$1"
+	fi
+	printf 'usage: %s [-n<requests>] [-e<expression>] [file...]\n' "$0" 1>&2
+	printf '    -n requests is how many requests to run each way, default 1000.\n'
+	printf '    -e expression is the request, default "s(1)".\n'
+	printf '    The files are loaded before every request, like a library.\n'
+	exit 1
+}
+
+script="$0"
+scriptdir=$(dirname "$script")
+
+. "$scriptdir/functions.sh"
+
+requests=1000
+expr="s(1)"
+
+# Process command-line arguments.
+while getopts "e:n:" opt; do
+
+	case "$opt" in
+		e) expr="$OPTARG" ;;
+		n) requests="$OPTARG" ;;
+		?) usage "Invalid option: $opt" ;;
+	esac
+
+done
+
+shift $((OPTIND - 1))
+
+bc="$scriptdir/../bin/bc"
+sock="$scriptdir/../server_bench.sock"
+
+rm -f "$sock"
+
+"$bc" -lq --server="$sock" "$@" &
+server=$!
+
+trap 'kill "$server" 2> /dev/null' EXIT
+
+# Wait for the server to be listening.
+while [ ! -S "$sock" ]; do
+	sleep 0.1
+done
+
+# Runs the requests and prints how many there were per second.
+# @param 1  The name of the way to run them.
+# @param @  The command to run each request with.
+run() {
+
+	_run_name="$1"
+	shift
+
+	_run_start=$(date +%s%N)
+
+	_run_i=0
+
+	while [ "$_run_i" -lt "$requests" ]; do
+		printf '%s\n' "$expr" | "$@" > /dev/null
+		_run_i=$((_run_i + 1))
+	done
+
+	_run_end=$(date +%s%N)
+
+	printf '%-12s %s requests/sec\n' "$_run_name" \
+		"$(printf 'scale = 1; %s * 10^9 / (%s - %s)\n' "$requests" \
+			"$_run_end" "$_run_start" | "$bc")"
+}
+
+# The result has to be the same both ways.
+direct=$(printf '%s\n' "$expr" | "$bc" -lq "$@")
+served=$(printf '%s\n' "$expr" | "$bc" --client="$sock")
+
+if [ "$direct" != "$served" ]; then
+	die "$bc" "server gave a different result" "$expr" 1
+fi
+
+run "fork+exec" "$bc" -lq "$@"
+run "--client" "$bc" --client="$sock"
@@ -57,6 +57,10 @@
 static void
 bc_args_exprs(const char* str)
 {
+#if BC_ENABLE_JOBS
+	size_t end;
+#endif // BC_ENABLE_JOBS
+
 	BC_SIG_ASSERT_LOCKED;
 
 	if (vm->exprs.v == NULL)
@@ -66,6 +70,19 @@ bc_args_exprs(const char* str)
 
 	bc_vec_concat(&vm->exprs, str);
 	bc_vec_concat(&vm->exprs, "\n");
+
+#if BC_ENABLE_JOBS
+
+	// Remember where each -e and -f ends so that they can be separate jobs.
+	if (vm->expr_ends.v == NULL)
+	{
+		bc_vec_init(&vm->expr_ends, sizeof(size_t), BC_DTOR_NONE);
+	}
+
+	end = vm->exprs.len - 1;
+	bc_vec_push(&vm->expr_ends, &end);
+
+#endif // BC_ENABLE_JOBS
 }
 
 /**
@@ -301,6 +318,13 @@ bc_args(int argc, char* argv[], bool exit_exprs, BcBigDig* scale,
 				break;
 			}
 
+			case 'M':
+			{
+				assert(BC_IS_BC);
+				vm->flags |= BC_FLAG_M;
+				break;
+			}
+
 			case 'q':
 			{
 				assert(BC_IS_BC);
@@ -329,6 +353,47 @@ bc_args(int argc, char* argv[], bool exit_exprs, BcBigDig* scale,
 			}
 #endif // BC_ENABLED
 
+#if BC_ENABLE_IMAGES
+			case BC_ARGS_LOAD_IMAGE:
+			{
+				assert(BC_IS_BC);
+				vm->load_image = opts.optarg;
+				break;
+			}
+
+			case BC_ARGS_SAVE_IMAGE:
+			{
+				assert(BC_IS_BC);
+				vm->save_image = opts.optarg;
+				break;
+			}
+#endif // BC_ENABLE_IMAGES
+
+#if BC_ENABLE_SERVER
+			case BC_ARGS_SERVER:
+			{
+				assert(BC_IS_BC);
+				vm->server = opts.optarg;
+				break;
+			}
+
+			case BC_ARGS_CLIENT:
+			{
+				assert(BC_IS_BC);
+				vm->client = opts.optarg;
+				break;
+			}
+#endif // BC_ENABLE_SERVER
+
+#if BC_ENABLE_JOBS
+			case BC_ARGS_JOBS:
+			{
+				vm->jobs = (size_t) bc_args_builtin(opts.optarg);
+				if (BC_ERR(!vm->jobs)) bc_verr(BC_ERR_FATAL_ARG, opts.optarg);
+				break;
+			}
+#endif // BC_ENABLE_JOBS
+
 			case 'V':
 			case 'v':
 			{
@@ -52,15 +52,27 @@ bc_lex_identifier(BcLex* l)
 	// We already passed the first character, so we need to be sure to include
 	// it.
 	const char* buf = l->buf + l->i - 1;
-	size_t i;
+	const uchar* kws;
+	size_t n;
+	char c;
+
+	// Find the end of the identifier first, so that keywords only have to be
+	// compared if they have the same length.
+	for (n = 1, c = buf[n]; (c >= 'a' && c <= 'z') || isdigit(c) || c == '_';
+	     c = buf[++n])
+	{
+		continue;
+	}
 
-	// This loop is simply checking for keywords.
-	for (i = 0; i < bc_lex_kws_len; ++i)
+	// This loop is simply checking for keywords, but only the ones that start
+	// with the same letter. If the identifier is followed by an uppercase
+	// letter, it cannot be a keyword.
+	for (kws = bc_lex_kws_chars[buf[0] - 'a']; *kws && !isalnum(c); ++kws)
 	{
+		size_t i = (size_t) (*kws - BC_LEX_KW_AUTO);
 		const BcLexKeyword* kw = bc_lex_kws + i;
-		size_t n = BC_LEX_KW_LEN(kw);
 
-		if (!strncmp(buf, kw->name, n) && !isalnum(buf[n]) && buf[n] != '_')
+		if (BC_LEX_KW_LEN(kw) == n && !memcmp(buf, kw->name, n))
 		{
 			// If the keyword has been redefined, and redefinition is allowed
 			// (it is not allowed for builtin libraries), break out of the loop
@@ -68,7 +80,7 @@ bc_lex_identifier(BcLex* l)
 			// ensure that only non-POSIX keywords get redefined.
 			if (!vm->no_redefine && vm->redefined_kws[i]) break;
 
-			l->t = BC_LEX_KW_AUTO + (BcLexType) i;
+			l->t = (BcLexType) *kws;
 
 			// Warn or error, as appropriate for the mode, if the keyword is not
 			// in the POSIX standard.
@@ -82,15 +94,15 @@ bc_lex_identifier(BcLex* l)
 		}
 	}
 
-	// If not a keyword, parse the name.
-	bc_lex_name(l);
+	// If not a keyword, it is a name. This is what bc_lex_name() does, without
+	// finding the end again.
+	l->t = BC_LEX_NAME;
+	bc_vec_string(&l->str, n, buf);
+	l->i += n - 1;
 
 	// POSIX doesn't allow identifiers that are more than one character, so we
 	// might have to warn or error here too.
-	if (BC_ERR(l->str.len - 1 > 1))
-	{
-		bc_lex_verr(l, BC_ERR_POSIX_NAME_LEN, l->str.v);
-	}
+	if (BC_ERR(n > 1)) bc_lex_verr(l, BC_ERR_POSIX_NAME_LEN, l->str.v);
 }
 
 /**
@@ -118,11 +130,9 @@ bc_lex_string(BcLex* l)
 		assert(vm->mode != BC_MODE_STDIN || buf == vm->buffer.v);
 
 		// Fortunately for us, bc doesn't escape quotes. Instead, the equivalent
-		// is '\q', which makes this loop simpler.
-		for (i = l->i; (c = buf[i]) && c != '"'; ++i)
-		{
-			nlines += (c == '\n');
-		}
+		// is '\q', which makes this simpler.
+		i = bc_lex_find(buf, l->i, '"', &nlines);
+		c = buf[i];
 
 		if (BC_ERR(c == '\0') && !vm->eof && l->mode != BC_MODE_FILE)
 		{
@@ -384,10 +384,17 @@ bc_parse_call(BcParse* p, const char* name, uint8_t flags)
 		p->func = bc_vec_item(&p->prog->fns, p->fidx);
 	}
 	// The function exists, so set the right function index.
-	else idx = ((BcId*) bc_vec_item(&p->prog->fn_map, idx))->idx;
+	else idx = bc_map_item(&p->prog->fn_map, idx)->idx;
 
 	bc_parse_pushIndex(p, idx);
 
+	// The function may call read(), which takes the next line of stdin, so in
+	// stdin mode, the statement has to run before the next one is parsed.
+	if (p->l.mode == BC_MODE_STDIN && p->fidx == BC_PROG_MAIN)
+	{
+		vm->ahead_stop = true;
+	}
+
 	// Make sure to get the next token.
 	bc_lex_next(&p->l);
 }
@@ -1403,7 +1410,7 @@ bc_parse_func(BcParse* p)
 	if (BC_ERR(p->l.t != BC_LEX_LPAREN)) bc_parse_err(p, BC_ERR_PARSE_FUNC);
 
 	// Make sure the functions map and vector are synchronized.
-	assert(p->prog->fns.len == p->prog->fn_map.len);
+	assert(p->prog->fns.len == bc_map_len(&p->prog->fn_map));
 
 	// Insert the function by name into the map and vector.
 	idx = bc_program_insertFunc(p->prog, p->l.str.v);
@@ -1792,6 +1799,7 @@ bc_parse_stmt(BcParse* p)
 		case BC_LEX_KW_LIMITS:
 		{
 			// `limits` is a compile-time command, so execute it right away.
+			bc_vm_runAhead();
 			bc_vm_printf("BC_LONG_BIT      = %lu\n", (ulong) BC_LONG_BIT);
 			bc_vm_printf("BC_BASE_DIGS     = %lu\n", (ulong) BC_BASE_DIGS);
 			bc_vm_printf("BC_BASE_POW      = %lu\n", (ulong) BC_BASE_POW);
@@ -1825,6 +1833,7 @@ bc_parse_stmt(BcParse* p)
 		{
 			// Quit is a compile-time command. We don't exit directly, so the vm
 			// can clean up.
+			bc_vm_runAhead();
 			vm->status = BC_STATUS_QUIT;
 			BC_JMP;
 			break;
@@ -1957,6 +1966,10 @@ bc_parse_parse(BcParse* p)
 	// Functions need special parsing.
 	else if (p->l.t == BC_LEX_KW_DEFINE)
 	{
+		// A function can be redefined, so the statements before the definition
+		// have to run first in case they call the old one.
+		bc_vm_runAhead();
+
 		if (BC_ERR(BC_PARSE_NO_EXEC(p)))
 		{
 			bc_parse_endif(p);
@@ -2364,6 +2377,10 @@ bc_parse_expr_err(BcParse* p, uint8_t flags, BcParseNext next)
 					bc_parse_err(p, BC_ERR_EXEC_REC_READ);
 				}
 
+				// read() takes the next line of stdin, so the statement has to
+				// run before the next one is parsed.
+				if (t == BC_LEX_KW_READ) vm->ahead_stop = true;
+
 				prev = t - BC_LEX_KW_READ + BC_INST_READ;
 				bc_parse_noArgBuiltin(p, prev);
 
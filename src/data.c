@@ -160,11 +160,23 @@ const BcOptLong bc_args_lopt[] = {
 #if BC_ENABLED
 	{ "global-stacks", BC_OPT_BC_ONLY, 'g' },
 	{ "mathlib", BC_OPT_BC_ONLY, 'l' },
+	{ "memoize", BC_OPT_BC_ONLY, 'M' },
 	{ "quiet", BC_OPT_BC_ONLY, 'q' },
 	{ "redefine", BC_OPT_REQUIRED_BC_ONLY, 'r' },
 	{ "standard", BC_OPT_BC_ONLY, 's' },
 	{ "warn", BC_OPT_BC_ONLY, 'w' },
 #endif // BC_ENABLED
+#if BC_ENABLE_IMAGES
+	{ "load-image", BC_OPT_REQUIRED_BC_ONLY, BC_ARGS_LOAD_IMAGE },
+	{ "save-image", BC_OPT_REQUIRED_BC_ONLY, BC_ARGS_SAVE_IMAGE },
+#endif // BC_ENABLE_IMAGES
+#if BC_ENABLE_SERVER
+	{ "server", BC_OPT_REQUIRED_BC_ONLY, BC_ARGS_SERVER },
+	{ "client", BC_OPT_REQUIRED_BC_ONLY, BC_ARGS_CLIENT },
+#endif // BC_ENABLE_SERVER
+#if BC_ENABLE_JOBS
+	{ "jobs", BC_OPT_REQUIRED, BC_ARGS_JOBS },
+#endif // BC_ENABLE_JOBS
 	{ "version", BC_OPT_NONE, 'v' },
 	{ "version", BC_OPT_NONE, 'V' },
 #if DC_ENABLED
@@ -841,6 +853,69 @@ const BcLexKeyword bc_lex_kws[] = {
 /// The length of the list of bc keywords.
 const size_t bc_lex_kws_len = sizeof(bc_lex_kws) / sizeof(BcLexKeyword);
 
+/// The tokens of the keywords in bc_lex_kws, in rows by the first letter of the
+/// keyword, so that the lexer only has to compare an identifier with a few of
+/// them. Each row ends with a 0. This needs to be updated if keywords change.
+const uchar bc_lex_kws_chars[26][BC_LEX_KWS_ROW] = {
+	['a' - 'a'] = { BC_LEX_KW_AUTO, BC_LEX_KW_ABS, BC_LEX_KW_ASCIIFY, 0 },
+	['b' - 'a'] = { BC_LEX_KW_BREAK, 0 },
+	['c' - 'a'] = { BC_LEX_KW_CONTINUE, 0 },
+	['d' - 'a'] = { BC_LEX_KW_DEFINE, BC_LEX_KW_DIVMOD, 0 },
+	['e' - 'a'] = { BC_LEX_KW_ELSE, 0 },
+	['f' - 'a'] = { BC_LEX_KW_FOR, 0 },
+	['g' - 'a'] = { BC_LEX_KW_GLOBAL_STACKS, 0 },
+	['h' - 'a'] = { BC_LEX_KW_HALT, 0 },
+	['i' - 'a'] = {
+		BC_LEX_KW_IF,
+		BC_LEX_KW_IBASE,
+		BC_LEX_KW_IS_NUMBER,
+		BC_LEX_KW_IS_STRING,
+#if BC_ENABLE_EXTRA_MATH
+		BC_LEX_KW_IRAND,
+#endif // BC_ENABLE_EXTRA_MATH
+		0,
+	},
+	['l' - 'a'] = {
+		BC_LEX_KW_LIMITS,
+		BC_LEX_KW_LAST,
+		BC_LEX_KW_LENGTH,
+		BC_LEX_KW_LINE_LENGTH,
+		BC_LEX_KW_LEADING_ZERO,
+		0,
+	},
+	['m' - 'a'] = {
+		BC_LEX_KW_MODEXP,
+		BC_LEX_KW_MAXIBASE,
+		BC_LEX_KW_MAXOBASE,
+		BC_LEX_KW_MAXSCALE,
+#if BC_ENABLE_EXTRA_MATH
+		BC_LEX_KW_MAXRAND,
+#endif // BC_ENABLE_EXTRA_MATH
+		0,
+	},
+	['o' - 'a'] = { BC_LEX_KW_OBASE, 0 },
+	['p' - 'a'] = { BC_LEX_KW_PRINT, 0 },
+	['q' - 'a'] = { BC_LEX_KW_QUIT, 0 },
+	['r' - 'a'] = {
+		BC_LEX_KW_RETURN,
+		BC_LEX_KW_READ,
+#if BC_ENABLE_EXTRA_MATH
+		BC_LEX_KW_RAND,
+#endif // BC_ENABLE_EXTRA_MATH
+		0,
+	},
+	['s' - 'a'] = {
+		BC_LEX_KW_SCALE,
+#if BC_ENABLE_EXTRA_MATH
+		BC_LEX_KW_SEED,
+#endif // BC_ENABLE_EXTRA_MATH
+		BC_LEX_KW_SQRT,
+		BC_LEX_KW_STREAM,
+		0,
+	},
+	['w' - 'a'] = { BC_LEX_KW_WHILE, 0 },
+};
+
 #if BC_C11
 
 // This is here to ensure that BC_LEX_NKWS, which is needed for the
@@ -38,6 +38,7 @@
 #include <string.h>
 
 #ifndef _WIN32
+#include <sys/uio.h>
 #include <unistd.h>
 #endif // _WIN32
 
@@ -117,6 +118,77 @@ bc_file_output(int fd, const char* buf, size_t n)
 	return BC_STATUS_SUCCESS;
 }
 
+/**
+ * Output the file's buffer and then another buffer to the file directly, in
+ * one system call, if possible.
+ * @param f    The file.
+ * @param buf  The buffer of data to output after the file's buffer.
+ * @param n    The number of bytes to output.
+ * @return     A status indicating error or success. We could have a fatal I/O
+ *             error or EOF.
+ */
+static BcStatus
+bc_file_outputv(BcFile* restrict f, const char* buf, size_t n)
+{
+#ifndef _WIN32
+
+	struct iovec iov[2];
+	size_t len = f->len;
+	sig_atomic_t lock;
+
+	BC_SIG_TRYLOCK(lock);
+
+	iov[0].iov_base = f->buf;
+	iov[0].iov_len = len;
+	iov[1].iov_base = (void*) buf;
+	iov[1].iov_len = n;
+
+	// Write both; if the write is short, just fall back to writing the rest
+	// normally.
+	while (len)
+	{
+		ssize_t written = writev(f->fd, iov, 2);
+
+		if (BC_ERR(written == -1))
+		{
+			BC_SIG_TRYUNLOCK(lock);
+
+			return errno == EPIPE ? BC_STATUS_EOF : BC_STATUS_ERROR_FATAL;
+		}
+
+		// If the write got into the second buffer, the first is done.
+		if ((size_t) written >= len)
+		{
+			written -= (ssize_t) len;
+			len = 0;
+			buf += written;
+			n -= (size_t) written;
+		}
+		else
+		{
+			len -= (size_t) written;
+			iov[0].iov_base = f->buf + f->len - len;
+			iov[0].iov_len = len;
+		}
+	}
+
+	f->len = 0;
+
+	BC_SIG_TRYUNLOCK(lock);
+
+	return bc_file_output(f->fd, buf, n);
+
+#else // _WIN32
+
+	BcStatus s = bc_file_output(f->fd, f->buf, f->len);
+
+	f->len = 0;
+
+	return s ? s : bc_file_output(f->fd, buf, n);
+
+#endif // _WIN32
+}
+
 #endif // !BC_ENABLE_LINE_LIB
 
 BcStatus
@@ -221,18 +293,36 @@ bc_file_write(BcFile* restrict f, BcFlushType type, const char* buf, size_t n)
 
 	BC_SIG_TRYLOCK(lock);
 
-	// If we have enough to flush, do it.
-	if (n > f->cap - f->len)
+	// If it does not fit, but would fit in an empty buffer, fill the buffer,
+	// flush it, and put the rest in the buffer. This keeps writes as big as
+	// the buffer.
+	if (n > f->cap - f->len && n <= f->cap)
 	{
+		size_t part = f->cap - f->len;
+
+		// NOLINTNEXTLINE
+		memcpy(f->buf + f->len, buf, part);
+		f->len = f->cap;
+
 		bc_file_flush(f, type);
 		assert(!f->len);
+
+		buf += part;
+		n -= part;
 	}
 
-	// If the output is large enough to flush by itself, just output it.
-	// Otherwise, put it into the buffer.
+	// If the output is large enough to flush by itself, output it and the
+	// buffer together. Otherwise, put it into the buffer.
 	if (BC_UNLIKELY(n > f->cap - f->len))
 	{
-		BcStatus s = bc_file_output(f->fd, buf, n);
+		BcStatus s;
+
+#if BC_ENABLE_HISTORY
+		// History needs to see what is flushed on a TTY, so do it normally.
+		if (BC_TTY) bc_file_flush(f, type);
+#endif // BC_ENABLE_HISTORY
+
+		s = bc_file_outputv(f, buf, n);
 
 		if (BC_ERR(s))
 		{
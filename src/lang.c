@@ -113,6 +113,10 @@ bc_func_init(BcFunc* f, const char* name)
 
 #endif // BC_ENABLED
 
+#if BC_ENABLE_IMAGES
+	f->img = NULL;
+#endif // BC_ENABLE_IMAGES
+
 	f->name = name;
 }
 
@@ -122,6 +126,15 @@ bc_func_reset(BcFunc* f)
 	BC_SIG_ASSERT_LOCKED;
 	assert(f != NULL);
 
+#if BC_ENABLE_IMAGES
+	// A stub has nothing to reset, but it needs its vectors.
+	if (f->img != NULL)
+	{
+		bc_func_init(f, f->name);
+		return;
+	}
+#endif // BC_ENABLE_IMAGES
+
 	bc_vec_popAll(&f->code);
 
 #if BC_ENABLED
@@ -136,6 +149,60 @@ bc_func_reset(BcFunc* f)
 #endif // BC_ENABLED
 }
 
+#if BC_ENABLE_IMAGES
+
+void
+bc_func_stub(BcFunc* f, const char* name, const BcImageFunc* img)
+{
+	BC_SIG_ASSERT_LOCKED;
+
+	assert(f != NULL && name != NULL && img != NULL);
+
+	// The vectors are empty and not allocated. Everything that pushes onto them
+	// goes through bc_func_load() or bc_func_reset() first.
+	bc_vec_clear(&f->code);
+	bc_vec_clear(&f->labels);
+	bc_vec_clear(&f->autos);
+
+	// These are needed before loading, to check calls.
+	f->nparams = img->nparams;
+	f->voidfn = img->voidfn;
+
+	f->name = name;
+	f->img = img;
+}
+
+void
+bc_func_append(BcFunc* f, const BcImageFunc* img)
+{
+	assert(f != NULL && f->img == NULL && img != NULL);
+
+	// Empty arrays are NULL in the image.
+	if (img->code_len) bc_vec_npush(&f->code, img->code_len, img->code);
+	if (img->labels_len) bc_vec_npush(&f->labels, img->labels_len, img->labels);
+	if (img->autos_len) bc_vec_npush(&f->autos, img->autos_len, img->autos);
+
+	f->nparams = img->nparams;
+	f->voidfn = img->voidfn;
+}
+
+void
+bc_func_load(BcFunc* f)
+{
+	const BcImageFunc* img;
+
+	BC_SIG_ASSERT_LOCKED;
+
+	assert(f != NULL && f->img != NULL);
+
+	img = f->img;
+
+	bc_func_init(f, f->name);
+	bc_func_append(f, img);
+}
+
+#endif // BC_ENABLE_IMAGES
+
 #if BC_DEBUG
 void
 bc_func_free(void* func)
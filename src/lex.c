@@ -49,20 +49,37 @@ bc_lex_invalidChar(BcLex* l, char c)
 	bc_lex_verr(l, BC_ERR_PARSE_CHAR, c);
 }
 
+size_t
+bc_lex_find(const char* buf, size_t i, char c, size_t* nlines)
+{
+	const char* ptr = strchr(buf + i, c);
+	const char* end = ptr != NULL ? ptr : buf + i + strlen(buf + i);
+	const char* nl;
+
+	// strchr() and memchr() look at many bytes at a time, so they are much
+	// faster than a loop over the characters when there is a lot to skip.
+	for (nl = buf + i; (nl = memchr(nl, '\n', (size_t) (end - nl))) != NULL;
+	     ++nl)
+	{
+		*nlines += 1;
+	}
+
+	return (size_t) (end - buf);
+}
+
 void
 bc_lex_lineComment(BcLex* l)
 {
+	const char* nl = memchr(l->buf + l->i, '\n', l->len - l->i);
+
 	l->t = BC_LEX_WHITESPACE;
-	while (l->i < l->len && l->buf[l->i] != '\n')
-	{
-		l->i += 1;
-	}
+	l->i = nl != NULL ? (size_t) (nl - l->buf) : l->len;
 }
 
 void
 bc_lex_comment(BcLex* l)
 {
-	size_t i, nlines = 0;
+	size_t i, nlines;
 	const char* buf;
 	bool end = false, got_more;
 	char c;
@@ -78,6 +95,10 @@ bc_lex_comment(BcLex* l)
 		buf = l->buf;
 		got_more = false;
 
+		// Every pass scans the comment from the start, so the newlines that
+		// the last pass found must not be counted again.
+		nlines = 0;
+
 		// If we are in stdin mode, the buffer must be the one used for stdin.
 		assert(vm->mode != BC_MODE_STDIN || buf == vm->buffer.v);
 
@@ -85,10 +106,8 @@ bc_lex_comment(BcLex* l)
 		for (i = l->i; !end; i += !end)
 		{
 			// While we don't have an asterisk, eat, but increment nlines.
-			for (; (c = buf[i]) && c != '*'; ++i)
-			{
-				nlines += (c == '\n');
-			}
+			i = bc_lex_find(buf, i, '*', &nlines);
+			c = buf[i];
 
 			// If this is true, we need to request more data.
 			if (BC_ERR(!c || buf[i + 1] == '\0'))
@@ -141,6 +160,27 @@ bc_lex_commonTokens(BcLex* l, char c)
 	else bc_lex_whitespace(l);
 }
 
+/**
+ * Returns the length of the run of digits at the start of a buffer. Digits are
+ * the characters that BC_LEX_NUM_CHAR() accepts other than the radix point.
+ * @param buf  The buffer.
+ * @return     The length of the run of digits.
+ */
+static size_t
+bc_lex_digits(const char* buf)
+{
+	const char last = BC_LEX_LAST_NUM_CHAR;
+	size_t i;
+	char c;
+
+	for (i = 0, c = buf[0]; isdigit(c) || (c >= 'A' && c <= last); c = buf[++i])
+	{
+		continue;
+	}
+
+	return i;
+}
+
 /**
  * Parses a number.
  * @param l         The lexer.
@@ -152,9 +192,9 @@ static size_t
 bc_lex_num(BcLex* l, char start, bool int_only)
 {
 	const char* buf = l->buf + l->i;
-	size_t i;
+	size_t i, n;
 	char c;
-	bool last_pt, pt = (start == '.');
+	bool pt = (start == '.');
 
 	// This loop looks complex. It is not. It is asking if the character is not
 	// a nul byte and it if it a valid num character based on what we have found
@@ -182,15 +222,21 @@ bc_lex_num(BcLex* l, char start, bool int_only)
 			if (!BC_LEX_NUM_CHAR(c, pt, int_only)) break;
 		}
 
-		// Did we find the radix point?
-		last_pt = (c == '.');
+		// Numbers can have 100,000 digits or more, so push all of the digits
+		// up to the next radix point or backslash at once.
+		if (c != '.')
+		{
+			n = bc_lex_digits(buf + i);
+			bc_vec_npush(&l->str, n, buf + i);
+			i += n - 1;
+			continue;
+		}
 
-		// If we did, and we already have one, then break because it's not part
-		// of this number.
-		if (pt && last_pt) break;
+		// We found the radix point, and if we already have one, then break
+		// because it's not part of this number.
+		if (pt) break;
 
-		// Set whether we have found a radix point.
-		pt = pt || last_pt;
+		pt = true;
 
 		bc_vec_push(&l->str, &c);
 	}
@@ -296,6 +342,20 @@ bc_lex_file(BcLex* l, const char* file)
 	vm->file = file;
 }
 
+/**
+ * Updates the buffer and len so that they are not invalidated when the stdin
+ * buffer grows.
+ * @param l     The lexer.
+ * @param text  The text.
+ * @param len   The length of the text.
+ */
+static void
+bc_lex_fixText(BcLex* l, const char* text, size_t len)
+{
+	l->buf = text;
+	l->len = len;
+}
+
 void
 bc_lex_next(BcLex* l)
 {
@@ -313,6 +373,34 @@ bc_lex_next(BcLex* l)
 
 	l->t = BC_LEX_EOF;
 
+#if BC_ENABLED
+	// In stream mode, the end of the text is just the end of a piece of the
+	// file, so bc gets the next piece and keeps going, which it needs to do
+	// because expressions can go across lines. This is safe because pieces
+	// always end with a newline, which is a token by itself. dc does not do this
+	// because it parses everything it is given before executing any of it.
+	if (l->i == l->len && BC_IS_BC && l->mode == BC_MODE_STREAM)
+	{
+		bool more;
+
+		// bc_vm_readFile() needs signals unlocked.
+		BC_SIG_UNLOCK;
+		more = bc_vm_readFile(true);
+		BC_SIG_LOCK;
+
+		if (more)
+		{
+			bc_lex_fixText(l, vm->buffer.v, vm->buffer.len - 1);
+			l->i = 0;
+		}
+	}
+#endif // BC_ENABLED
+
+	// In stdin mode, a newline ends the text, even if there is more after it.
+	// This is so stdin is processed a line at a time, as it has always been,
+	// even when it is read in blocks. See bc_vm_stdin().
+	if (l->last == BC_LEX_NLINE && l->mode == BC_MODE_STDIN) return;
+
 	// We are done if this is true.
 	if (l->i == l->len) return;
 
@@ -325,18 +413,26 @@ bc_lex_next(BcLex* l)
 	while (l->t == BC_LEX_WHITESPACE);
 }
 
-/**
- * Updates the buffer and len so that they are not invalidated when the stdin
- * buffer grows.
- * @param l     The lexer.
- * @param text  The text.
- * @param len   The length of the text.
- */
-static void
-bc_lex_fixText(BcLex* l, const char* text, size_t len)
+bool
+bc_lex_nextLine(BcLex* l)
 {
-	l->buf = text;
-	l->len = len;
+	BC_SIG_ASSERT_LOCKED;
+
+	assert(l != NULL && l->t == BC_LEX_EOF);
+
+	if (l->i >= l->len) return false;
+
+	// The line number was already updated when the newline was passed, so this
+	// does not call bc_lex_next().
+	l->t = l->last = BC_LEX_INVALID;
+
+	do
+	{
+		vm->next(l);
+	}
+	while (l->t == BC_LEX_WHITESPACE);
+
+	return true;
 }
 
 bool
@@ -369,6 +465,12 @@ bc_lex_readLine(BcLex* l)
 			break;
 		}
 
+		case BC_MODE_STREAM:
+		{
+			good = bc_vm_readFile(false);
+			break;
+		}
+
 #ifdef __GNUC__
 #ifndef __clang__
 		default:
@@ -35,6 +35,7 @@
 
 #if BC_ENABLE_LIBRARY
 
+#include <ctype.h>
 #include <setjmp.h>
 #include <string.h>
 #include <time.h>
@@ -47,6 +48,7 @@
 
 #ifndef _WIN32
 #include <pthread.h>
+#include <unistd.h>
 #endif // _WIN32
 
 // The asserts in this file are important to testing; in many cases, the test
@@ -85,6 +87,10 @@ bcl_numIdxOutOfRange(void)
 static BclTls* tls = NULL;
 static BclTls tls_real;
 
+#ifdef BCL_THREAD_LOCAL
+BCL_THREAD_LOCAL BcVm* bcl_vm = NULL;
+#endif // BCL_THREAD_LOCAL
+
 BclError
 bcl_start(void)
 {
@@ -142,9 +148,15 @@ bcl_setspecific(BcVm* vm)
 
 #endif // _WIN32
 
+#ifdef BCL_THREAD_LOCAL
+	bcl_vm = vm;
+#endif // BCL_THREAD_LOCAL
+
 	return BCL_ERROR_NONE;
 }
 
+#ifndef BCL_THREAD_LOCAL
+
 BcVm*
 bcl_getspecific(void)
 {
@@ -163,6 +175,8 @@ bcl_getspecific(void)
 	return vm;
 }
 
+#endif // BCL_THREAD_LOCAL
+
 BclError
 bcl_init(void)
 {
@@ -206,6 +220,7 @@ bcl_init(void)
 	vm->abrt = false;
 	vm->leading_zeroes = false;
 	vm->digit_clamp = true;
+	vm->arena = NULL;
 
 	// The jmp_bufs always has to be initialized first.
 	bc_vec_init(&vm->jmp_bufs, sizeof(sigjmp_buf), BC_DTOR_NONE);
@@ -242,6 +257,29 @@ err:
 	return e;
 }
 
+static BclContext
+bcl_contextHelper(BcVm* vm)
+{
+	if (!vm->ctxts.len) return NULL;
+	return *((BclContext*) bc_vec_top(&vm->ctxts));
+}
+
+/**
+ * Sets the arena that numbers get their limbs from to the arena of a context.
+ * @param vm    The BcVm.
+ * @param ctxt  The context, or NULL for none.
+ * @return      The old arena, so it can be restored.
+ */
+static BclArena*
+bcl_setArena(BcVm* vm, BclContext ctxt)
+{
+	BclArena* old = vm->arena;
+
+	vm->arena = ctxt != NULL && ctxt->arena.first != NULL ? &ctxt->arena : NULL;
+
+	return old;
+}
+
 BclError
 bcl_pushContext(BclContext ctxt)
 {
@@ -252,6 +290,8 @@ bcl_pushContext(BclContext ctxt)
 
 	bc_vec_push(&vm->ctxts, &ctxt);
 
+	bcl_setArena(vm, ctxt);
+
 err:
 
 	BC_FUNC_FOOTER(vm, e);
@@ -264,13 +304,8 @@ bcl_popContext(void)
 	BcVm* vm = bcl_getspecific();
 
 	if (vm->ctxts.len) bc_vec_pop(&vm->ctxts);
-}
 
-static BclContext
-bcl_contextHelper(BcVm* vm)
-{
-	if (!vm->ctxts.len) return NULL;
-	return *((BclContext*) bc_vec_top(&vm->ctxts));
+	bcl_setArena(vm, bcl_contextHelper(vm));
 }
 
 BclContext
@@ -311,6 +346,9 @@ bcl_free(void)
 void
 bcl_end(void)
 {
+	// The workers have thread data, so they have to be gone first.
+	bcl_jobs_stop();
+
 #ifndef _WIN32
 
 	// We ignore the return value.
@@ -332,6 +370,75 @@ bcl_gc(void)
 	bc_vm_freeTemps();
 }
 
+BclThread
+bcl_thread(void)
+{
+	return bcl_getspecific();
+}
+
+void
+bcl_cancel(BclThread thread)
+{
+	BCL_ATOMIC_SET(&thread->cancel, 1);
+}
+
+/**
+ * Returns the time from a monotonic clock.
+ * @return  The time in nanoseconds.
+ */
+static uint64_t
+bcl_now(void)
+{
+#ifndef _WIN32
+
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+
+#else // _WIN32
+
+	LARGE_INTEGER count, freq;
+
+	QueryPerformanceCounter(&count);
+	QueryPerformanceFrequency(&freq);
+
+	return (uint64_t) ((double) count.QuadPart * 1e9 / (double) freq.QuadPart);
+
+#endif // _WIN32
+}
+
+void
+bcl_poll(BcVm* vm)
+{
+	BclContext ctxt;
+	uint64_t now;
+
+	vm->poll = BCL_POLL_STEPS;
+
+	if (BC_NO_ERR(!BCL_ATOMIC_GET(&vm->cancel)))
+	{
+		ctxt = bcl_contextHelper(vm);
+		if (ctxt == NULL || !ctxt->deadline) return;
+
+		// The clock is only read once the call is long enough to get here, so
+		// the first poll starts the clock instead of every call.
+		now = bcl_now();
+
+		if (!vm->call_start)
+		{
+			vm->call_start = now;
+			return;
+		}
+
+		if (BC_NO_ERR(now - vm->call_start <= ctxt->deadline)) return;
+	}
+
+	vm->err = BCL_ERROR_SIGNAL;
+	BC_JMP;
+}
+
 bool
 bcl_abortOnFatalError(void)
 {
@@ -380,8 +487,98 @@ bcl_setDigitClamp(bool digitClamp)
 	vm->digit_clamp = digitClamp;
 }
 
-BclContext
-bcl_ctxt_create(void)
+/**
+ * Allocates a new chunk for an arena.
+ * @param cap  The number of bytes the chunk should have.
+ * @return     The new chunk.
+ */
+static BclArenaChunk*
+bcl_arena_chunk(size_t cap)
+{
+	BclArenaChunk* c;
+
+	c = bc_vm_malloc(bc_vm_growSize(sizeof(BclArenaChunk), cap));
+	c->next = NULL;
+	c->cap = cap;
+
+	return c;
+}
+
+void*
+bcl_arena_malloc(BclArena* a, size_t size)
+{
+	void* ptr;
+
+	assert(a != NULL && a->first != NULL && a->cur != NULL);
+
+	// Move to the next chunk that is big enough, reusing chunks from before
+	// the last reset, and adding a bigger one at the end if necessary.
+	while (a->cur->cap - a->used < size)
+	{
+		if (a->cur->next == NULL)
+		{
+			size_t cap = bc_vm_growSize(a->cur->cap, a->cur->cap);
+			a->cur->next = bcl_arena_chunk(cap >= size ? cap : size);
+		}
+
+		a->cur = a->cur->next;
+		a->used = 0;
+	}
+
+	ptr = BCL_ARENA_DATA(a->cur) + a->used;
+	a->used += size;
+
+	return ptr;
+}
+
+void*
+bcl_arena_realloc(BclArena* a, void* ptr, size_t oldsize, size_t size)
+{
+	void* new_ptr;
+
+	assert(a != NULL && a->cur != NULL);
+	assert(size >= oldsize);
+
+	// If this is the last allocation, and there is room, just grow it.
+	if (ptr != NULL &&
+	    (char*) ptr + oldsize == BCL_ARENA_DATA(a->cur) + a->used &&
+	    a->cur->cap - a->used >= size - oldsize)
+	{
+		a->used += size - oldsize;
+		return ptr;
+	}
+
+	new_ptr = bcl_arena_malloc(a, size);
+
+	// NOLINTNEXTLINE
+	if (ptr != NULL) memcpy(new_ptr, ptr, oldsize);
+
+	return new_ptr;
+}
+
+void
+bcl_arena_free(BclArena* a, void* ptr, size_t size)
+{
+	assert(a != NULL && a->cur != NULL);
+
+	// Only the last allocation can be given back. This catches the temporaries
+	// in the math code, which are freed in the reverse order they are
+	// allocated.
+	if (ptr != NULL && (char*) ptr + size == BCL_ARENA_DATA(a->cur) + a->used)
+	{
+		a->used -= size;
+	}
+}
+
+/**
+ * Creates a context.
+ * @param hint   The size of the first chunk of the arena, or 0 for the default.
+ *               This is ignored if @a arena is false.
+ * @param arena  True if the context should have an arena, false otherwise.
+ * @return       The new context, or NULL on error.
+ */
+static BclContext
+bcl_ctxt_create_helper(size_t hint, bool arena)
 {
 	BcVm* vm = bcl_getspecific();
 	BclContext ctxt = NULL;
@@ -392,18 +589,45 @@ bcl_ctxt_create(void)
 	// malloc() is appropriate here.
 	ctxt = bc_vm_malloc(sizeof(BclCtxt));
 
-	bc_vec_init(&ctxt->nums, sizeof(BclNum), BC_DTOR_BCL_NUM);
+	// Setting these to NULL ensures that if an error occurs, we only free what
+	// is necessary.
+	ctxt->nums.v = NULL;
+	ctxt->free_nums.v = NULL;
+	ctxt->expr_stack.v = NULL;
+	ctxt->arena.first = NULL;
+
+	// With an arena, numbers are not destructed one by one; their limbs all go
+	// away when the arena is reset.
+	bc_vec_init(&ctxt->nums, sizeof(BclNum),
+	            arena ? BC_DTOR_NONE : BC_DTOR_BCL_NUM);
 	bc_vec_init(&ctxt->free_nums, sizeof(BclNumber), BC_DTOR_NONE);
 
+	// The scratch number is allocated by the first operation that needs it.
+	bc_num_clear(&ctxt->scratch);
+
+	bc_vec_init(&ctxt->expr_stack, sizeof(BcNum),
+	            arena ? BC_DTOR_NONE : BC_DTOR_NUM);
+
 	ctxt->scale = 0;
 	ctxt->ibase = 10;
 	ctxt->obase = 10;
+	ctxt->fixed = false;
+	ctxt->deadline = 0;
+
+	if (arena)
+	{
+		ctxt->arena.first = bcl_arena_chunk(hint ? hint : BCL_ARENA_DEF_SIZE);
+		ctxt->arena.cur = ctxt->arena.first;
+		ctxt->arena.used = 0;
+	}
 
 err:
 
 	if (BC_ERR(vm->err && ctxt != NULL))
 	{
 		if (ctxt->nums.v != NULL) bc_vec_free(&ctxt->nums);
+		if (ctxt->free_nums.v != NULL) bc_vec_free(&ctxt->free_nums);
+		if (ctxt->expr_stack.v != NULL) bc_vec_free(&ctxt->expr_stack);
 		free(ctxt);
 		ctxt = NULL;
 	}
@@ -413,19 +637,69 @@ err:
 	return ctxt;
 }
 
+BclContext
+bcl_ctxt_create(void)
+{
+	return bcl_ctxt_create_helper(0, false);
+}
+
+BclContext
+bcl_ctxt_create_arena(size_t hint)
+{
+	return bcl_ctxt_create_helper(hint, true);
+}
+
 void
 bcl_ctxt_free(BclContext ctxt)
 {
+	BcVm* vm = bcl_getspecific();
+	BclArena* arena;
+	BclArenaChunk* c;
+
+	// The numbers have to be freed the way the context allocated them, no
+	// matter which context is current.
+	arena = bcl_setArena(vm, ctxt);
+
+	if (ctxt->scratch.num != NULL) bc_num_free(&ctxt->scratch);
+	bc_vec_free(&ctxt->expr_stack);
 	bc_vec_free(&ctxt->free_nums);
 	bc_vec_free(&ctxt->nums);
+
+	vm->arena = arena;
+
+	for (c = ctxt->arena.first; c != NULL; c = ctxt->arena.first)
+	{
+		ctxt->arena.first = c->next;
+		free(c);
+	}
+
 	free(ctxt);
 }
 
 void
 bcl_ctxt_freeNums(BclContext ctxt)
 {
+	BcVm* vm = bcl_getspecific();
+	BclArena* arena;
+
+	arena = bcl_setArena(vm, ctxt);
+
 	bc_vec_popAll(&ctxt->nums);
 	bc_vec_popAll(&ctxt->free_nums);
+
+	vm->arena = arena;
+
+	// With an arena, the numbers above had no destructor, and resetting the
+	// arena frees them all at once. The scratch number and the expression
+	// stack are in the arena too, so they have to go as well.
+	if (ctxt->arena.first != NULL)
+	{
+		bc_num_clear(&ctxt->scratch);
+		bc_vec_popAll(&ctxt->expr_stack);
+
+		ctxt->arena.cur = ctxt->arena.first;
+		ctxt->arena.used = 0;
+	}
 }
 
 size_t
@@ -440,6 +714,30 @@ bcl_ctxt_setScale(BclContext ctxt, size_t scale)
 	ctxt->scale = scale;
 }
 
+bool
+bcl_ctxt_fixed(BclContext ctxt)
+{
+	return ctxt->fixed;
+}
+
+void
+bcl_ctxt_setFixed(BclContext ctxt, bool fixed)
+{
+	ctxt->fixed = fixed;
+}
+
+uint64_t
+bcl_ctxt_deadline(BclContext ctxt)
+{
+	return ctxt->deadline;
+}
+
+void
+bcl_ctxt_setDeadline(BclContext ctxt, uint64_t ns)
+{
+	ctxt->deadline = ns;
+}
+
 size_t
 bcl_ctxt_ibase(BclContext ctxt)
 {
@@ -488,6 +786,25 @@ bcl_err(BclNumber n)
 	else return BCL_ERROR_NONE;
 }
 
+/**
+ * Swaps two BcNums. This is used to keep the limbs of temporaries around so that
+ * they can be reused instead of reallocated.
+ * @param a  The first number.
+ * @param b  The second number.
+ */
+static void
+bcl_num_swap(BcNum* restrict a, BcNum* restrict b)
+{
+	BcNum temp;
+
+	// NOLINTNEXTLINE
+	memcpy(&temp, a, sizeof(BcNum));
+	// NOLINTNEXTLINE
+	memcpy(a, b, sizeof(BcNum));
+	// NOLINTNEXTLINE
+	memcpy(b, &temp, sizeof(BcNum));
+}
+
 /**
  * Inserts a BcNum into a context's list of numbers.
  * @param ctxt  The context to insert into.
@@ -877,92 +1194,314 @@ err:
 	return idx;
 }
 
-/**
- * Sets up and executes a binary operator operation.
- * @param a         The first operand.
- * @param b         The second operand.
- * @param op        The operation.
- * @param req       The function to get the size of the result for
- *                  preallocation.
- * @param destruct  True if the parameters should be consumed, false otherwise.
- * @return          The result of the operation.
- */
-static BclNumber
-bcl_binary(BclNumber a, BclNumber b, const BcNumBinaryOp op,
-           const BcNumBinaryOpReq req, bool destruct)
+BclNumber
+bcl_import_bytes(const unsigned char* restrict bytes, size_t len,
+                 bool bigEndian, bool twosComp)
 {
 	BclError e = BCL_ERROR_NONE;
-	BclNum* aptr;
-	BclNum* bptr;
-	BclNum c;
+	BclNum n;
 	BclNumber idx;
 	BclContext ctxt;
 	BcVm* vm = bcl_getspecific();
 
 	BC_CHECK_CTXT(vm, ctxt);
 
-	BC_CHECK_NUM(ctxt, a);
-	BC_CHECK_NUM(ctxt, b);
+	// This needs to be cleared before anything can jump or go to err.
+	bc_num_clear(BCL_NUM_NUM_NP(n));
 
 	BC_FUNC_HEADER(vm, err);
 
 	BCL_GROW_NUMS(ctxt);
 
-	assert(BCL_NO_GEN(a) < ctxt->nums.len && BCL_NO_GEN(b) < ctxt->nums.len);
+	assert(bytes != NULL || !len);
 
-	aptr = BCL_NUM(ctxt, a);
-	bptr = BCL_NUM(ctxt, b);
+	bc_num_init(BCL_NUM_NUM_NP(n), BC_NUM_DEF_SIZE);
 
-	assert(aptr != NULL && bptr != NULL);
-	assert(BCL_NUM_ARRAY(aptr) != NULL && BCL_NUM_ARRAY(bptr) != NULL);
+	bc_num_fromBytes(BCL_NUM_NUM_NP(n), bytes, len, bigEndian, twosComp);
 
-	// Clear and initialize the result.
-	bc_num_clear(BCL_NUM_NUM_NP(c));
-	bc_num_init(BCL_NUM_NUM_NP(c),
-	            req(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr), ctxt->scale));
+err:
+
+	BC_FUNC_FOOTER(vm, e);
+	BC_MAYBE_SETUP(ctxt, e, n, idx);
+
+	return idx;
+}
+
+/**
+ * Converts a number to bytes.
+ * @param n          The number.
+ * @param bytes      The bytes to write into.
+ * @param len        The number of bytes.
+ * @param bigEndian  True for big endian, false for little endian.
+ * @param twosComp   True for two's complement, false for a magnitude.
+ * @param destruct   True if @a n should be consumed, false otherwise.
+ * @return           An error code, if any.
+ */
+static BclError
+bcl_export_bytes_helper(BclNumber n, unsigned char* restrict bytes, size_t len,
+                        bool bigEndian, bool twosComp, bool destruct)
+{
+	BclError e = BCL_ERROR_NONE;
+	BclNum* nptr;
+	BclContext ctxt;
+	BcVm* vm = bcl_getspecific();
+
+	BC_CHECK_CTXT_ERR(vm, ctxt);
 
-	op(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr), BCL_NUM_NUM_NP(c), ctxt->scale);
+	BCL_CHECK_NUM_VALID(ctxt, n);
+
+	BC_FUNC_HEADER(vm, err);
+
+	assert(BCL_NO_GEN(n) < ctxt->nums.len);
+	assert(bytes != NULL || !len);
+
+	nptr = BCL_NUM(ctxt, n);
+
+	assert(nptr != NULL && BCL_NUM_ARRAY(nptr) != NULL);
+
+	// A negative number has no magnitude representation. The fractional part
+	// is ignored, so this does not count numbers in (-1, 0).
+	if (BC_ERR(!twosComp && BC_NUM_NEG(BCL_NUM_NUM(nptr)) &&
+	           BCL_NUM_NUM(nptr)->len > BC_NUM_RDX_VAL(BCL_NUM_NUM(nptr))))
+	{
+		vm->err = BCL_ERROR_MATH_NEGATIVE;
+		goto err;
+	}
+
+	if (BC_ERR(!bc_num_toBytes(BCL_NUM_NUM(nptr), &ctxt->scratch, bytes, len,
+	                           bigEndian, twosComp)))
+	{
+		vm->err = BCL_ERROR_MATH_OVERFLOW;
+		goto err;
+	}
 
 err:
 
+	// Do not leave a partial number behind.
+	if (BC_ERR(vm->err && len)) memset(bytes, 0, len);
+
 	if (destruct)
 	{
-		// Eat the operands.
-		bcl_num_dtor(ctxt, a, aptr);
-		if (b.i != a.i) bcl_num_dtor(ctxt, b, bptr);
+		bcl_num_dtor(ctxt, n, nptr);
 	}
 
 	BC_FUNC_FOOTER(vm, e);
-	BC_MAYBE_SETUP(ctxt, e, c, idx);
 
-	return idx;
+	return e;
 }
 
-BclNumber
-bcl_add(BclNumber a, BclNumber b)
+BclError
+bcl_export_bytes(BclNumber n, unsigned char* restrict bytes, size_t len,
+                 bool bigEndian, bool twosComp)
 {
-	return bcl_binary(a, b, bc_num_add, bc_num_addReq, true);
+	return bcl_export_bytes_helper(n, bytes, len, bigEndian, twosComp, true);
 }
 
-BclNumber
-bcl_add_keep(BclNumber a, BclNumber b)
+BclError
+bcl_export_bytes_keep(BclNumber n, unsigned char* restrict bytes, size_t len,
+                      bool bigEndian, bool twosComp)
 {
-	return bcl_binary(a, b, bc_num_add, bc_num_addReq, false);
+	return bcl_export_bytes_helper(n, bytes, len, bigEndian, twosComp, false);
 }
 
 BclNumber
-bcl_sub(BclNumber a, BclNumber b)
+bcl_from_double(double val)
 {
-	return bcl_binary(a, b, bc_num_sub, bc_num_addReq, true);
-}
+	BclError e = BCL_ERROR_NONE;
+	BclNum n;
+	BclNumber idx;
+	BclContext ctxt;
+	BcVm* vm = bcl_getspecific();
 
-BclNumber
-bcl_sub_keep(BclNumber a, BclNumber b)
-{
-	return bcl_binary(a, b, bc_num_sub, bc_num_addReq, false);
-}
+	BC_CHECK_CTXT(vm, ctxt);
 
-BclNumber
+	// This needs to be cleared before anything can jump or go to err.
+	bc_num_clear(BCL_NUM_NUM_NP(n));
+
+	BC_FUNC_HEADER(vm, err);
+
+	BCL_GROW_NUMS(ctxt);
+
+	bc_num_init(BCL_NUM_NUM_NP(n), BC_NUM_DEF_SIZE);
+
+	// Infinity and NaN are too big for any number.
+	if (BC_ERR(!bc_num_fromDouble(BCL_NUM_NUM_NP(n), val, ctxt->scale)))
+	{
+		vm->err = BCL_ERROR_MATH_OVERFLOW;
+	}
+
+err:
+
+	BC_FUNC_FOOTER(vm, e);
+	BC_MAYBE_SETUP(ctxt, e, n, idx);
+
+	return idx;
+}
+
+/**
+ * Converts a number to a double.
+ * @param n         The number.
+ * @param result    The return parameter for the double.
+ * @param destruct  True if @a n should be consumed, false otherwise.
+ * @return          An error code, if any.
+ */
+static BclError
+bcl_to_double_helper(BclNumber n, double* result, bool destruct)
+{
+	BclError e = BCL_ERROR_NONE;
+	BclNum* nptr;
+	BclContext ctxt;
+	BcVm* vm = bcl_getspecific();
+
+	BC_CHECK_CTXT_ERR(vm, ctxt);
+
+	BCL_CHECK_NUM_VALID(ctxt, n);
+
+	BC_FUNC_HEADER(vm, err);
+
+	assert(BCL_NO_GEN(n) < ctxt->nums.len);
+	assert(result != NULL);
+
+	nptr = BCL_NUM(ctxt, n);
+
+	assert(nptr != NULL && BCL_NUM_ARRAY(nptr) != NULL);
+
+	if (BC_ERR(!bc_num_toDouble(BCL_NUM_NUM(nptr), result)))
+	{
+		vm->err = BCL_ERROR_MATH_OVERFLOW;
+	}
+
+err:
+
+	if (destruct)
+	{
+		bcl_num_dtor(ctxt, n, nptr);
+	}
+
+	BC_FUNC_FOOTER(vm, e);
+
+	return e;
+}
+
+BclError
+bcl_to_double(BclNumber n, double* result)
+{
+	return bcl_to_double_helper(n, result, true);
+}
+
+BclError
+bcl_to_double_keep(BclNumber n, double* result)
+{
+	return bcl_to_double_helper(n, result, false);
+}
+
+/**
+ * Returns the function to use for a binary operator in a context. In
+ * fixed-scale mode, that is the fixed-scale version of the operator, if there
+ * is one. Addition and subtraction do not have one because they do not
+ * allocate, and they are already as fast on limbs.
+ * @param ctxt  The context.
+ * @param op    The operation.
+ * @return      The function to use for @a op.
+ */
+static BcNumBinaryOp
+bcl_op(BclContext ctxt, BcNumBinaryOp op)
+{
+	if (!ctxt->fixed) return op;
+
+	if (op == bc_num_mul) return bc_num_mulFixed;
+	if (op == bc_num_div) return bc_num_divFixed;
+
+	return op;
+}
+
+/**
+ * Sets up and executes a binary operator operation.
+ * @param a         The first operand.
+ * @param b         The second operand.
+ * @param op        The operation.
+ * @param req       The function to get the size of the result for
+ *                  preallocation.
+ * @param destruct  True if the parameters should be consumed, false otherwise.
+ * @return          The result of the operation.
+ */
+static BclNumber
+bcl_binary(BclNumber a, BclNumber b, const BcNumBinaryOp op,
+           const BcNumBinaryOpReq req, bool destruct)
+{
+	BclError e = BCL_ERROR_NONE;
+	BclNum* aptr;
+	BclNum* bptr;
+	BclNum c;
+	BclNumber idx;
+	BclContext ctxt;
+	BcVm* vm = bcl_getspecific();
+
+	BC_CHECK_CTXT(vm, ctxt);
+
+	BC_CHECK_NUM(ctxt, a);
+	BC_CHECK_NUM(ctxt, b);
+
+	BC_FUNC_HEADER(vm, err);
+
+	BCL_GROW_NUMS(ctxt);
+
+	assert(BCL_NO_GEN(a) < ctxt->nums.len && BCL_NO_GEN(b) < ctxt->nums.len);
+
+	aptr = BCL_NUM(ctxt, a);
+	bptr = BCL_NUM(ctxt, b);
+
+	assert(aptr != NULL && bptr != NULL);
+	assert(BCL_NUM_ARRAY(aptr) != NULL && BCL_NUM_ARRAY(bptr) != NULL);
+
+	// Clear and initialize the result.
+	bc_num_clear(BCL_NUM_NUM_NP(c));
+	bc_num_init(BCL_NUM_NUM_NP(c),
+	            req(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr), ctxt->scale));
+
+	bcl_op(ctxt, op)(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr), BCL_NUM_NUM_NP(c),
+	                 ctxt->scale);
+
+err:
+
+	if (destruct)
+	{
+		// Eat the operands.
+		bcl_num_dtor(ctxt, a, aptr);
+		if (b.i != a.i) bcl_num_dtor(ctxt, b, bptr);
+	}
+
+	BC_FUNC_FOOTER(vm, e);
+	BC_MAYBE_SETUP(ctxt, e, c, idx);
+
+	return idx;
+}
+
+BclNumber
+bcl_add(BclNumber a, BclNumber b)
+{
+	return bcl_binary(a, b, bc_num_add, bc_num_addReq, true);
+}
+
+BclNumber
+bcl_add_keep(BclNumber a, BclNumber b)
+{
+	return bcl_binary(a, b, bc_num_add, bc_num_addReq, false);
+}
+
+BclNumber
+bcl_sub(BclNumber a, BclNumber b)
+{
+	return bcl_binary(a, b, bc_num_sub, bc_num_addReq, true);
+}
+
+BclNumber
+bcl_sub_keep(BclNumber a, BclNumber b)
+{
+	return bcl_binary(a, b, bc_num_sub, bc_num_addReq, false);
+}
+
+BclNumber
 bcl_mul(BclNumber a, BclNumber b)
 {
 	return bcl_binary(a, b, bc_num_mul, bc_num_mulReq, true);
@@ -1034,387 +1573,1800 @@ bcl_rshift_keep(BclNumber a, BclNumber b)
 	return bcl_binary(a, b, bc_num_rshift, bc_num_placesReq, false);
 }
 
-static BclNumber
-bcl_sqrt_helper(BclNumber a, bool destruct)
+/**
+ * Executes a binary operator operation, putting the result into an existing
+ * number. The numbers must have already been checked, and the caller must have
+ * set up the jump.
+ * @param ctxt  The context.
+ * @param d     The destination. It can be the same as either operand.
+ * @param a     The first operand.
+ * @param b     The second operand.
+ * @param op    The operation.
+ */
+static void
+bcl_num_into(BclContext ctxt, BclNumber d, BclNumber a, BclNumber b,
+             const BcNumBinaryOp op)
 {
-	BclError e = BCL_ERROR_NONE;
 	BclNum* aptr;
-	BclNum b;
-	BclNumber idx;
+	BclNum* bptr;
+	BclNum* dptr;
+	BcNum* dst;
+
+	assert(BCL_NO_GEN(d) < ctxt->nums.len);
+	assert(BCL_NO_GEN(a) < ctxt->nums.len && BCL_NO_GEN(b) < ctxt->nums.len);
+
+	aptr = BCL_NUM(ctxt, a);
+	bptr = BCL_NUM(ctxt, b);
+	dptr = BCL_NUM(ctxt, d);
+
+	assert(aptr != NULL && bptr != NULL && dptr != NULL);
+	assert(BCL_NUM_ARRAY(aptr) != NULL && BCL_NUM_ARRAY(bptr) != NULL);
+	assert(BCL_NUM_ARRAY(dptr) != NULL);
+
+	// If the destination is also an operand, the result goes into the scratch
+	// number of the context first, and then the two are swapped. That way, the
+	// limbs of both are kept for the next operation, and there is no
+	// allocation once they are big enough. Otherwise, the operation just
+	// expands the destination if it needs to.
+	dst = (d.i == a.i || d.i == b.i) ? &ctxt->scratch : BCL_NUM_NUM(dptr);
+
+	bcl_op(ctxt, op)(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr), dst, ctxt->scale);
+
+	if (dst == &ctxt->scratch)
+	{
+		BC_SIG_LOCK;
+		bcl_num_swap(BCL_NUM_NUM(dptr), dst);
+		BC_SIG_UNLOCK;
+	}
+}
+
+/**
+ * Sets up and executes a binary operator operation, putting the result into an
+ * existing number instead of a new one.
+ * @param d   The destination. It can be the same as either operand.
+ * @param a   The first operand.
+ * @param b   The second operand.
+ * @param op  The operation.
+ * @return    An error code, if any.
+ */
+static BclError
+bcl_binary_into(BclNumber d, BclNumber a, BclNumber b, const BcNumBinaryOp op)
+{
+	BclError e = BCL_ERROR_NONE;
 	BclContext ctxt;
 	BcVm* vm = bcl_getspecific();
 
-	BC_CHECK_CTXT(vm, ctxt);
+	BC_CHECK_CTXT_ERR(vm, ctxt);
 
-	BC_CHECK_NUM(ctxt, a);
+	BC_CHECK_NUM_ERR(ctxt, d);
+	BC_CHECK_NUM_ERR(ctxt, a);
+	BC_CHECK_NUM_ERR(ctxt, b);
 
 	BC_FUNC_HEADER(vm, err);
 
-	BCL_GROW_NUMS(ctxt);
+	bcl_num_into(ctxt, d, a, b, op);
 
-	assert(BCL_NO_GEN(a) < ctxt->nums.len);
+err:
 
-	aptr = BCL_NUM(ctxt, a);
+	BC_FUNC_FOOTER(vm, e);
 
-	bc_num_sqrt(BCL_NUM_NUM(aptr), BCL_NUM_NUM_NP(b), ctxt->scale);
+	return e;
+}
 
-err:
+BclError
+bcl_add_into(BclNumber d, BclNumber a, BclNumber b)
+{
+	return bcl_binary_into(d, a, b, bc_num_add);
+}
 
-	if (destruct)
-	{
-		bcl_num_dtor(ctxt, a, aptr);
-	}
+BclError
+bcl_sub_into(BclNumber d, BclNumber a, BclNumber b)
+{
+	return bcl_binary_into(d, a, b, bc_num_sub);
+}
 
-	BC_FUNC_FOOTER(vm, e);
-	BC_MAYBE_SETUP(ctxt, e, b, idx);
+BclError
+bcl_mul_into(BclNumber d, BclNumber a, BclNumber b)
+{
+	return bcl_binary_into(d, a, b, bc_num_mul);
+}
 
-	return idx;
+BclError
+bcl_div_into(BclNumber d, BclNumber a, BclNumber b)
+{
+	return bcl_binary_into(d, a, b, bc_num_div);
 }
 
-BclNumber
-bcl_sqrt(BclNumber a)
+BclError
+bcl_mod_into(BclNumber d, BclNumber a, BclNumber b)
 {
-	return bcl_sqrt_helper(a, true);
+	return bcl_binary_into(d, a, b, bc_num_mod);
 }
 
-BclNumber
-bcl_sqrt_keep(BclNumber a)
+BclError
+bcl_pow_into(BclNumber d, BclNumber a, BclNumber b)
 {
-	return bcl_sqrt_helper(a, false);
+	return bcl_binary_into(d, a, b, bc_num_pow);
 }
 
-static BclError
-bcl_divmod_helper(BclNumber a, BclNumber b, BclNumber* c, BclNumber* d,
-                  bool destruct)
+BclError
+bcl_lshift_into(BclNumber d, BclNumber a, BclNumber b)
+{
+	return bcl_binary_into(d, a, b, bc_num_lshift);
+}
+
+BclError
+bcl_rshift_into(BclNumber d, BclNumber a, BclNumber b)
+{
+	return bcl_binary_into(d, a, b, bc_num_rshift);
+}
+
+BclError
+bcl_add_n(BclNumber* d, const BclNumber* a, const BclNumber* b, size_t n)
 {
 	BclError e = BCL_ERROR_NONE;
-	size_t req;
-	BclNum* aptr;
-	BclNum* bptr;
-	BclNum cnum, dnum;
+	size_t i;
 	BclContext ctxt;
 	BcVm* vm = bcl_getspecific();
 
 	BC_CHECK_CTXT_ERR(vm, ctxt);
 
-	BC_CHECK_NUM_ERR(ctxt, a);
-	BC_CHECK_NUM_ERR(ctxt, b);
+	assert(n == 0 || (d != NULL && a != NULL && b != NULL));
+
+	// Check everything first so that nothing is changed if a number is bad.
+	for (i = 0; i < n; ++i)
+	{
+		BC_CHECK_NUM_ERR(ctxt, d[i]);
+		BC_CHECK_NUM_ERR(ctxt, a[i]);
+		BC_CHECK_NUM_ERR(ctxt, b[i]);
+	}
 
 	BC_FUNC_HEADER(vm, err);
 
-	BCL_GROW_NUMS(ctxt);
+	for (i = 0; i < n; ++i)
+	{
+		bcl_num_into(ctxt, d[i], a[i], b[i], bc_num_add);
+	}
+
+err:
+
+	BC_FUNC_FOOTER(vm, e);
+
+	return e;
+}
+
+BclError
+bcl_mul_scalar_n(BclNumber* d, const BclNumber* a, BclNumber s, size_t n)
+{
+	BclError e = BCL_ERROR_NONE;
+	size_t i;
+	BclContext ctxt;
+	BcVm* vm = bcl_getspecific();
+
+	BC_CHECK_CTXT_ERR(vm, ctxt);
+
+	assert(n == 0 || (d != NULL && a != NULL));
+
+	BC_CHECK_NUM_ERR(ctxt, s);
+
+	// Check everything first so that nothing is changed if a number is bad.
+	for (i = 0; i < n; ++i)
+	{
+		BC_CHECK_NUM_ERR(ctxt, d[i]);
+		BC_CHECK_NUM_ERR(ctxt, a[i]);
+	}
+
+	BC_FUNC_HEADER(vm, err);
+
+	for (i = 0; i < n; ++i)
+	{
+		bcl_num_into(ctxt, d[i], a[i], s, bc_num_mul);
+	}
+
+err:
+
+	BC_FUNC_FOOTER(vm, e);
+
+	return e;
+}
+
+/**
+ * Sums a list of numbers, or the products of pairs of numbers from two lists,
+ * and returns the result in a new number. The operands are not consumed.
+ * @param a  The first list of numbers.
+ * @param b  The second list of numbers, or NULL to just sum @a a.
+ * @param n  The length of the lists.
+ * @return   The sum.
+ */
+static BclNumber
+bcl_sum_helper(const BclNumber* a, const BclNumber* b, size_t n)
+{
+	BclError e = BCL_ERROR_NONE;
+	size_t i;
+	BclNum c;
+	BcNum temp, prod;
+	BclNumber idx;
+	BclContext ctxt;
+	BcNumBinaryOp mul;
+	BcVm* vm = bcl_getspecific();
+
+	BC_CHECK_CTXT(vm, ctxt);
+
+	assert(n == 0 || a != NULL);
+
+	mul = bcl_op(ctxt, bc_num_mul);
+
+	for (i = 0; i < n; ++i)
+	{
+		BC_CHECK_NUM(ctxt, a[i]);
+		if (b != NULL) BC_CHECK_NUM(ctxt, b[i]);
+	}
+
+	// These need to be cleared before anything can jump.
+	bc_num_clear(BCL_NUM_NUM_NP(c));
+	bc_num_clear(&temp);
+	bc_num_clear(&prod);
+
+	BC_FUNC_HEADER(vm, err);
+
+	BCL_GROW_NUMS(ctxt);
+
+	bc_num_init(BCL_NUM_NUM_NP(c), BC_NUM_DEF_SIZE);
+	bc_num_init(&temp, BC_NUM_DEF_SIZE);
+	if (b != NULL) bc_num_init(&prod, BC_NUM_DEF_SIZE);
+
+	// The running total and the temp are swapped after every addition, so
+	// their limbs are reused, and there is only allocation when the total
+	// grows. The same goes for the product.
+	for (i = 0; i < n; ++i)
+	{
+		BcNum* x = BCL_NUM_NUM(BCL_NUM(ctxt, a[i]));
+
+		if (b != NULL)
+		{
+			mul(x, BCL_NUM_NUM(BCL_NUM(ctxt, b[i])), &prod, ctxt->scale);
+			x = &prod;
+		}
+
+		bc_num_add(BCL_NUM_NUM_NP(c), x, &temp, 0);
+
+		BC_SIG_LOCK;
+		bcl_num_swap(BCL_NUM_NUM_NP(c), &temp);
+		BC_SIG_UNLOCK;
+	}
+
+err:
+
+	if (temp.num != NULL) bc_num_free(&temp);
+	if (prod.num != NULL) bc_num_free(&prod);
+
+	BC_FUNC_FOOTER(vm, e);
+	BC_MAYBE_SETUP(ctxt, e, c, idx);
+
+	return idx;
+}
+
+BclNumber
+bcl_sum(const BclNumber* nums, size_t n)
+{
+	return bcl_sum_helper(nums, NULL, n);
+}
+
+BclNumber
+bcl_dot(const BclNumber* a, const BclNumber* b, size_t n)
+{
+	assert(n == 0 || b != NULL);
+	return bcl_sum_helper(a, b, n);
+}
+
+static BclNumber
+bcl_sqrt_helper(BclNumber a, bool destruct)
+{
+	BclError e = BCL_ERROR_NONE;
+	BclNum* aptr;
+	BclNum b;
+	BclNumber idx;
+	BclContext ctxt;
+	BcVm* vm = bcl_getspecific();
+
+	BC_CHECK_CTXT(vm, ctxt);
+
+	BC_CHECK_NUM(ctxt, a);
+
+	BC_FUNC_HEADER(vm, err);
+
+	BCL_GROW_NUMS(ctxt);
+
+	assert(BCL_NO_GEN(a) < ctxt->nums.len);
+
+	aptr = BCL_NUM(ctxt, a);
+
+	bc_num_sqrt(BCL_NUM_NUM(aptr), BCL_NUM_NUM_NP(b), ctxt->scale);
+
+err:
+
+	if (destruct)
+	{
+		bcl_num_dtor(ctxt, a, aptr);
+	}
+
+	BC_FUNC_FOOTER(vm, e);
+	BC_MAYBE_SETUP(ctxt, e, b, idx);
+
+	return idx;
+}
+
+BclNumber
+bcl_sqrt(BclNumber a)
+{
+	return bcl_sqrt_helper(a, true);
+}
+
+BclNumber
+bcl_sqrt_keep(BclNumber a)
+{
+	return bcl_sqrt_helper(a, false);
+}
+
+static BclError
+bcl_divmod_helper(BclNumber a, BclNumber b, BclNumber* c, BclNumber* d,
+                  bool destruct)
+{
+	BclError e = BCL_ERROR_NONE;
+	size_t req;
+	BclNum* aptr;
+	BclNum* bptr;
+	BclNum cnum, dnum;
+	BclContext ctxt;
+	BcVm* vm = bcl_getspecific();
+
+	BC_CHECK_CTXT_ERR(vm, ctxt);
+
+	BC_CHECK_NUM_ERR(ctxt, a);
+	BC_CHECK_NUM_ERR(ctxt, b);
+
+	BC_FUNC_HEADER(vm, err);
+
+	BCL_GROW_NUMS(ctxt);
+
+	assert(c != NULL && d != NULL);
+
+	aptr = BCL_NUM(ctxt, a);
+	bptr = BCL_NUM(ctxt, b);
+
+	assert(aptr != NULL && bptr != NULL);
+	assert(BCL_NUM_ARRAY(aptr) != NULL && BCL_NUM_ARRAY(bptr) != NULL);
+
+	bc_num_clear(BCL_NUM_NUM_NP(cnum));
+	bc_num_clear(BCL_NUM_NUM_NP(dnum));
+
+	req = bc_num_divReq(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr), ctxt->scale);
+
+	// Initialize the numbers.
+	bc_num_init(BCL_NUM_NUM_NP(cnum), req);
+	BC_UNSETJMP(vm);
+	BC_SETJMP(vm, err);
+	bc_num_init(BCL_NUM_NUM_NP(dnum), req);
+
+	bc_num_divmod(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr), BCL_NUM_NUM_NP(cnum),
+	              BCL_NUM_NUM_NP(dnum), ctxt->scale);
+
+err:
+
+	if (destruct)
+	{
+		// Eat the operands.
+		bcl_num_dtor(ctxt, a, aptr);
+		if (b.i != a.i) bcl_num_dtor(ctxt, b, bptr);
+	}
+
+	// If there was an error...
+	if (BC_ERR(vm->err))
+	{
+		// Free the results.
+		if (BCL_NUM_ARRAY_NP(cnum) != NULL) bc_num_free(&cnum);
+		if (BCL_NUM_ARRAY_NP(cnum) != NULL) bc_num_free(&dnum);
+
+		// Make sure the return values are invalid.
+		c->i = 0 - (size_t) BCL_ERROR_INVALID_NUM;
+		d->i = c->i;
+
+		BC_FUNC_FOOTER(vm, e);
+	}
+	else
+	{
+		BC_FUNC_FOOTER(vm, e);
+
+		// Insert the results into the context.
+		*c = bcl_num_insert(ctxt, &cnum);
+		*d = bcl_num_insert(ctxt, &dnum);
+	}
+
+	return e;
+}
+
+BclError
+bcl_divmod(BclNumber a, BclNumber b, BclNumber* c, BclNumber* d)
+{
+	return bcl_divmod_helper(a, b, c, d, true);
+}
+
+BclError
+bcl_divmod_keep(BclNumber a, BclNumber b, BclNumber* c, BclNumber* d)
+{
+	return bcl_divmod_helper(a, b, c, d, false);
+}
+
+static BclNumber
+bcl_modexp_helper(BclNumber a, BclNumber b, BclNumber c, bool destruct)
+{
+	BclError e = BCL_ERROR_NONE;
+	size_t req;
+	BclNum* aptr;
+	BclNum* bptr;
+	BclNum* cptr;
+	BclNum d;
+	BclNumber idx;
+	BclContext ctxt;
+	BcVm* vm = bcl_getspecific();
+
+	BC_CHECK_CTXT(vm, ctxt);
+
+	BC_CHECK_NUM(ctxt, a);
+	BC_CHECK_NUM(ctxt, b);
+	BC_CHECK_NUM(ctxt, c);
+
+	BC_FUNC_HEADER(vm, err);
+
+	BCL_GROW_NUMS(ctxt);
+
+	assert(BCL_NO_GEN(a) < ctxt->nums.len && BCL_NO_GEN(b) < ctxt->nums.len);
+	assert(BCL_NO_GEN(c) < ctxt->nums.len);
+
+	aptr = BCL_NUM(ctxt, a);
+	bptr = BCL_NUM(ctxt, b);
+	cptr = BCL_NUM(ctxt, c);
+
+	assert(aptr != NULL && bptr != NULL && cptr != NULL);
+	assert(BCL_NUM_NUM(aptr) != NULL && BCL_NUM_NUM(bptr) != NULL &&
+	       BCL_NUM_NUM(cptr) != NULL);
+
+	// Prepare the result.
+	bc_num_clear(BCL_NUM_NUM_NP(d));
+
+	req = bc_num_divReq(BCL_NUM_NUM(aptr), BCL_NUM_NUM(cptr), 0);
+
+	// Initialize the result.
+	bc_num_init(BCL_NUM_NUM_NP(d), req);
+
+	bc_num_modexp(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr), BCL_NUM_NUM(cptr),
+	              BCL_NUM_NUM_NP(d));
+
+err:
+
+	if (destruct)
+	{
+		// Eat the operands.
+		bcl_num_dtor(ctxt, a, aptr);
+		if (b.i != a.i) bcl_num_dtor(ctxt, b, bptr);
+		if (c.i != a.i && c.i != b.i) bcl_num_dtor(ctxt, c, cptr);
+	}
+
+	BC_FUNC_FOOTER(vm, e);
+	BC_MAYBE_SETUP(ctxt, e, d, idx);
+
+	return idx;
+}
+
+BclNumber
+bcl_modexp(BclNumber a, BclNumber b, BclNumber c)
+{
+	return bcl_modexp_helper(a, b, c, true);
+}
+
+BclNumber
+bcl_modexp_keep(BclNumber a, BclNumber b, BclNumber c)
+{
+	return bcl_modexp_helper(a, b, c, false);
+}
+
+/// The pool of worker threads for jobs.
+static BclJobPool bcl_pool = {
+	BCL_MUTEX_INIT, BCL_COND_INIT, BCL_COND_INIT, NULL, NULL, NULL, 0, false,
+};
+
+/// The number of operands for each job operation.
+static const uchar bcl_job_nargs[] = {
+	2, 2, 2, 2, 2, 2, 2, 2, 1, 3,
+};
+
+/// The functions for the binary job operations.
+static const BcNumBinaryOp bcl_job_ops[] = {
+	bc_num_add, bc_num_sub,    bc_num_mul,    bc_num_div,
+	bc_num_mod, bc_num_pow,    bc_num_lshift, bc_num_rshift,
+};
+
+/// The functions for the result sizes of the binary job operations.
+static const BcNumBinaryOpReq bcl_job_reqs[] = {
+	bc_num_addReq, bc_num_addReq, bc_num_mulReq,    bc_num_divReq,
+	bc_num_divReq, bc_num_powReq, bc_num_placesReq, bc_num_placesReq,
+};
+
+/**
+ * Does a job. This runs on a worker thread, and it consumes the operands.
+ * @param vm    The worker's thread data.
+ * @param ctxt  The worker's context.
+ * @param t     The job.
+ */
+static void
+bcl_task_run(BcVm* vm, BclContext ctxt, BclTask* t)
+{
+	size_t i;
+	BcNum* args = t->args;
+
+	// The deadline is checked against the current context.
+	ctxt->deadline = t->deadline;
+
+	BC_FUNC_HEADER(vm, err);
+
+	if (t->op == BCL_JOB_SQRT) bc_num_sqrt(&args[0], &t->res, t->scale);
+	else if (t->op == BCL_JOB_MODEXP)
+	{
+		bc_num_init(&t->res, bc_num_divReq(&args[0], &args[2], 0));
+		bc_num_modexp(&args[0], &args[1], &args[2], &t->res);
+	}
+	else
+	{
+		bc_num_init(&t->res, t->req(&args[0], &args[1], t->scale));
+		t->fn(&args[0], &args[1], &t->res, t->scale);
+	}
+
+err:
+
+	BC_FUNC_FOOTER(vm, t->err);
+
+	for (i = 0; i < bcl_job_nargs[t->op]; ++i)
+	{
+		bc_num_free(&args[i]);
+	}
+
+	if (BC_ERR(t->err != BCL_ERROR_NONE) && t->res.num != NULL)
+	{
+		bc_num_free(&t->res);
+		bc_num_clear(&t->res);
+	}
+}
+
+/**
+ * The loop for a worker thread. It takes jobs off of the queue until the pool
+ * is stopped and the queue is empty.
+ */
+static void
+bcl_worker(void)
+{
+	size_t i;
+	BclTask* t;
+	BclContext ctxt = NULL;
+	bool ok = (bcl_init() == BCL_ERROR_NONE);
+	BcVm* vm = bcl_getspecific();
+
+	// The worker needs a context of its own for deadlines. It is freed by
+	// bcl_free() because it is still pushed.
+	if (BC_NO_ERR(ok))
+	{
+		ctxt = bcl_ctxt_create();
+		ok = (ctxt != NULL && bcl_pushContext(ctxt) == BCL_ERROR_NONE);
+
+		if (BC_ERR(!ok))
+		{
+			if (ctxt != NULL) bcl_ctxt_free(ctxt);
+			bcl_free();
+		}
+	}
+
+	BCL_LOCK(&bcl_pool.lock);
+
+	for (;;)
+	{
+		while (bcl_pool.head == NULL && !bcl_pool.stop)
+		{
+			BCL_WAIT(&bcl_pool.work, &bcl_pool.lock);
+		}
+
+		if (bcl_pool.head == NULL) break;
+
+		t = bcl_pool.head;
+		bcl_pool.head = t->next;
+		if (bcl_pool.head == NULL) bcl_pool.tail = NULL;
+
+		BCL_UNLOCK(&bcl_pool.lock);
+
+		if (BC_NO_ERR(ok)) bcl_task_run(vm, ctxt, t);
+		else
+		{
+			// Without a BcVm, the operands cannot go back to a cache, but they
+			// were allocated normally.
+			for (i = 0; i < bcl_job_nargs[t->op]; ++i)
+			{
+				free(t->args[i].num);
+			}
+
+			t->err = BCL_ERROR_FATAL_ALLOC_ERR;
+		}
+
+		BCL_LOCK(&bcl_pool.lock);
+
+		t->done = true;
+		BCL_BROADCAST(&bcl_pool.done);
+	}
+
+	BCL_UNLOCK(&bcl_pool.lock);
+
+	if (BC_NO_ERR(ok)) bcl_free();
+}
+
+#ifndef _WIN32
+
+/**
+ * The start routine for a worker thread.
+ * @param arg  Unused.
+ * @return     NULL.
+ */
+static void*
+bcl_worker_start(void* arg)
+{
+	BC_UNUSED(arg);
+	bcl_worker();
+	return NULL;
+}
+
+#else // _WIN32
+
+/**
+ * The start routine for a worker thread.
+ * @param arg  Unused.
+ * @return     0.
+ */
+static DWORD WINAPI
+bcl_worker_start(LPVOID arg)
+{
+	BC_UNUSED(arg);
+	bcl_worker();
+	return 0;
+}
+
+#endif // _WIN32
+
+/**
+ * Starts the worker threads if they have not been started. There is one for
+ * each online processor. The pool lock must be held.
+ * @return  True on success, false if no thread could be started.
+ */
+static bool
+bcl_jobs_start(void)
+{
+	size_t i, n;
+
+	if (bcl_pool.threads != NULL) return true;
+
+#ifndef _WIN32
+	{
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		n = cpus > 0 ? (size_t) cpus : 1;
+	}
+#else // _WIN32
+	{
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		n = info.dwNumberOfProcessors ? (size_t) info.dwNumberOfProcessors : 1;
+	}
+#endif // _WIN32
+
+	bcl_pool.threads = malloc(n * sizeof(BclWorker));
+	if (BC_ERR(bcl_pool.threads == NULL)) return false;
+
+	// If only some of the threads start, the pool just has fewer.
+	for (i = 0; i < n; ++i)
+	{
+#ifndef _WIN32
+		if (pthread_create(&bcl_pool.threads[i], NULL, bcl_worker_start,
+		                   NULL) != 0)
+		{
+			break;
+		}
+#else // _WIN32
+		bcl_pool.threads[i] = CreateThread(NULL, 0, bcl_worker_start, NULL, 0,
+		                                   NULL);
+		if (bcl_pool.threads[i] == NULL) break;
+#endif // _WIN32
+	}
+
+	if (BC_ERR(i == 0))
+	{
+		free(bcl_pool.threads);
+		bcl_pool.threads = NULL;
+		return false;
+	}
+
+	bcl_pool.nthreads = i;
+
+	return true;
+}
+
+void
+bcl_jobs_stop(void)
+{
+	size_t i;
+
+	BCL_LOCK(&bcl_pool.lock);
+
+	if (bcl_pool.threads == NULL)
+	{
+		BCL_UNLOCK(&bcl_pool.lock);
+		return;
+	}
+
+	bcl_pool.stop = true;
+	BCL_BROADCAST(&bcl_pool.work);
+
+	BCL_UNLOCK(&bcl_pool.lock);
+
+	for (i = 0; i < bcl_pool.nthreads; ++i)
+	{
+#ifndef _WIN32
+		pthread_join(bcl_pool.threads[i], NULL);
+#else // _WIN32
+		WaitForSingleObject(bcl_pool.threads[i], INFINITE);
+		CloseHandle(bcl_pool.threads[i]);
+#endif // _WIN32
+	}
+
+	free(bcl_pool.threads);
+
+	bcl_pool.threads = NULL;
+	bcl_pool.nthreads = 0;
+	bcl_pool.stop = false;
+}
+
+BclJob
+bcl_submit(BclJobOp op, const BclNumber* args)
+{
+	BclTask* t = NULL;
+	BclContext ctxt;
+	BclArena* arena;
+	size_t i, nargs;
+	bool started;
+	BcVm* vm = bcl_getspecific();
+
+	ctxt = bcl_contextHelper(vm);
+	if (BC_ERR(ctxt == NULL || op >= BCL_JOB_NELEMS)) return NULL;
+
+	nargs = bcl_job_nargs[op];
+
+	assert(args != NULL);
+
+	for (i = 0; i < nargs; ++i)
+	{
+		if (BC_ERR(BCL_NO_GEN(args[i]) >= ctxt->nums.len)) return NULL;
+		BCL_CHECK_NUM_GEN(ctxt, args[i]);
+	}
+
+	BCL_LOCK(&bcl_pool.lock);
+	started = bcl_jobs_start();
+	BCL_UNLOCK(&bcl_pool.lock);
+
+	if (BC_ERR(!started)) return NULL;
+
+	// The copies are freed by a worker, so they cannot come from an arena.
+	arena = bcl_setArena(vm, NULL);
+
+	BC_FUNC_HEADER(vm, err);
+
+	t = bc_vm_malloc(sizeof(BclTask));
+
+	t->next = NULL;
+	t->op = op;
+	t->scale = ctxt->scale;
+	t->deadline = ctxt->deadline;
+	t->err = BCL_ERROR_NONE;
+	t->done = false;
+
+	if (op < BCL_JOB_SQRT)
+	{
+		t->fn = bcl_op(ctxt, bcl_job_ops[op]);
+		t->req = bcl_job_reqs[op];
+	}
+
+	bc_num_clear(&t->res);
+
+	for (i = 0; i < nargs; ++i)
+	{
+		bc_num_clear(&t->args[i]);
+	}
+
+	for (i = 0; i < nargs; ++i)
+	{
+		bc_num_createCopy(&t->args[i], BCL_NUM_NUM(BCL_NUM(ctxt, args[i])));
+	}
+
+err:
+
+	if (BC_ERR(vm->err && t != NULL))
+	{
+		for (i = 0; i < nargs; ++i)
+		{
+			if (t->args[i].num != NULL) bc_num_free(&t->args[i]);
+		}
+
+		free(t);
+		t = NULL;
+	}
+
+	vm->arena = arena;
+
+	BC_FUNC_FOOTER_NO_ERR(vm);
+
+	if (t != NULL)
+	{
+		BCL_LOCK(&bcl_pool.lock);
+
+		if (bcl_pool.tail != NULL) bcl_pool.tail->next = t;
+		else bcl_pool.head = t;
+		bcl_pool.tail = t;
+
+		BCL_SIGNAL(&bcl_pool.work);
+
+		BCL_UNLOCK(&bcl_pool.lock);
+	}
+
+	return t;
+}
+
+bool
+bcl_job_poll(BclJob job)
+{
+	bool done;
+
+	assert(job != NULL);
+
+	BCL_LOCK(&bcl_pool.lock);
+	done = job->done;
+	BCL_UNLOCK(&bcl_pool.lock);
+
+	return done;
+}
+
+BclNumber
+bcl_job_wait(BclJob job)
+{
+	BclError e;
+	BcNum res;
+	BclNum n;
+	BclNumber idx;
+	BclContext ctxt;
+	BclArena* arena;
+	BcVm* vm = bcl_getspecific();
+
+	assert(job != NULL);
+
+	BCL_LOCK(&bcl_pool.lock);
+
+	while (!job->done)
+	{
+		BCL_WAIT(&bcl_pool.done, &bcl_pool.lock);
+	}
+
+	BCL_UNLOCK(&bcl_pool.lock);
+
+	// NOLINTNEXTLINE
+	memcpy(&res, &job->res, sizeof(BcNum));
+	e = job->err;
+
+	free(job);
+
+	bc_num_clear(BCL_NUM_NUM_NP(n));
+
+	ctxt = bcl_contextHelper(vm);
+	if (BC_ERR(ctxt == NULL && e == BCL_ERROR_NONE))
+	{
+		e = BCL_ERROR_INVALID_CONTEXT;
+	}
+
+	if (BC_NO_ERR(e == BCL_ERROR_NONE))
+	{
+		BC_FUNC_HEADER(vm, err);
+
+		BCL_GROW_NUMS(ctxt);
+
+		// The result was allocated normally, so an arena context needs a copy
+		// in its arena. Otherwise, the result can just be moved in.
+		if (vm->arena != NULL)
+		{
+			bc_num_createCopy(BCL_NUM_NUM_NP(n), &res);
+		}
+		else
+		{
+			// NOLINTNEXTLINE
+			memcpy(BCL_NUM_NUM_NP(n), &res, sizeof(BcNum));
+			bc_num_clear(&res);
+		}
+
+err:
+
+		BC_FUNC_FOOTER(vm, e);
+	}
+
+	if (res.num != NULL)
+	{
+		arena = bcl_setArena(vm, NULL);
+		bc_num_free(&res);
+		vm->arena = arena;
+	}
+
+	BC_MAYBE_SETUP(ctxt, e, n, idx);
+
+	return idx;
+}
+
+ssize_t
+bcl_cmp(BclNumber a, BclNumber b)
+{
+	BclNum* aptr;
+	BclNum* bptr;
+	BclContext ctxt;
+	BcVm* vm = bcl_getspecific();
+
+	BC_CHECK_CTXT_ASSERT(vm, ctxt);
+
+	BCL_CHECK_NUM_VALID(ctxt, a);
+	BCL_CHECK_NUM_VALID(ctxt, b);
+
+	assert(BCL_NO_GEN(a) < ctxt->nums.len && BCL_NO_GEN(b) < ctxt->nums.len);
+
+	aptr = BCL_NUM(ctxt, a);
+	bptr = BCL_NUM(ctxt, b);
+
+	assert(aptr != NULL && bptr != NULL);
+	assert(BCL_NUM_NUM(aptr) != NULL && BCL_NUM_NUM(bptr));
+
+	return bc_num_cmp(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr));
+}
+
+void
+bcl_zero(BclNumber n)
+{
+	BclNum* nptr;
+	BclContext ctxt;
+	BcVm* vm = bcl_getspecific();
+
+	BC_CHECK_CTXT_ASSERT(vm, ctxt);
+
+	BCL_CHECK_NUM_VALID(ctxt, n);
+
+	assert(BCL_NO_GEN(n) < ctxt->nums.len);
+
+	nptr = BCL_NUM(ctxt, n);
+
+	assert(nptr != NULL && BCL_NUM_NUM(nptr) != NULL);
+
+	bc_num_zero(BCL_NUM_NUM(nptr));
+}
+
+void
+bcl_one(BclNumber n)
+{
+	BclNum* nptr;
+	BclContext ctxt;
+	BcVm* vm = bcl_getspecific();
+
+	BC_CHECK_CTXT_ASSERT(vm, ctxt);
+
+	BCL_CHECK_NUM_VALID(ctxt, n);
+
+	assert(BCL_NO_GEN(n) < ctxt->nums.len);
+
+	nptr = BCL_NUM(ctxt, n);
+
+	assert(nptr != NULL && BCL_NUM_NUM(nptr) != NULL);
+
+	bc_num_one(BCL_NUM_NUM(nptr));
+}
+
+/**
+ * Parses a number string of a known length.
+ * @param val  The string.
+ * @param len  The length of the string.
+ * @return     The new number, or an error.
+ */
+static BclNumber
+bcl_parse_helper(const char* restrict val, size_t len)
+{
+	BclError e = BCL_ERROR_NONE;
+	BclNum n;
+	BclNumber idx;
+	BclContext ctxt;
+	BcVm* vm = bcl_getspecific();
+	bool neg;
+
+	BC_CHECK_CTXT(vm, ctxt);
+
+	// This needs to be cleared before anything can jump or go to err.
+	bc_num_clear(BCL_NUM_NUM_NP(n));
+
+	BC_FUNC_HEADER(vm, err);
+
+	BCL_GROW_NUMS(ctxt);
+
+	assert(val != NULL);
+
+	// We have to take care of negative here because bc's number parsing does
+	// not.
+	neg = (len && val[0] == '-');
+
+	if (neg)
+	{
+		val += 1;
+		len -= 1;
+	}
+
+	if (!bc_num_strValidLen(val, len))
+	{
+		vm->err = BCL_ERROR_PARSE_INVALID_STR;
+		goto err;
+	}
+
+	// Initialize the number.
+	bc_num_init(BCL_NUM_NUM_NP(n), BC_NUM_DEF_SIZE);
+
+	bc_num_parseLen(BCL_NUM_NUM_NP(n), val, len, (BcBigDig) ctxt->ibase);
+
+	// Set the negative.
+#if BC_ENABLE_MEMCHECK
+	n.n.rdx = BC_NUM_NEG_VAL(BCL_NUM_NUM_NP(n), neg);
+#else // BC_ENABLE_MEMCHECK
+	n.rdx = BC_NUM_NEG_VAL_NP(n, neg);
+#endif // BC_ENABLE_MEMCHECK
+
+err:
+
+	BC_FUNC_FOOTER(vm, e);
+	BC_MAYBE_SETUP(ctxt, e, n, idx);
+
+	return idx;
+}
+
+BclNumber
+bcl_parse(const char* restrict val)
+{
+	assert(val != NULL);
+	return bcl_parse_helper(val, strlen(val));
+}
+
+BclNumber
+bcl_parse_n(const char* restrict val, size_t len)
+{
+	assert(val != NULL || !len);
+	return bcl_parse_helper(val, len);
+}
+
+/**
+ * Gets a number ready to be turned into a string and returns the length of the
+ * string. In decimal, this just calculates the length, and bcl_string_write()
+ * will write the digits straight into the destination. In other bases, the
+ * number is printed into the vm's output buffer, which is reused between calls.
+ * @param vm    The thread data.
+ * @param ctxt  The context.
+ * @param n     The number.
+ * @return      The length of the string, not counting the nul terminator.
+ */
+static size_t
+bcl_string_prep(BcVm* vm, BclContext ctxt, BcNum* n)
+{
+	if (ctxt->obase == BC_BASE) return bc_num_decimalLen(n);
+
+	// Clear the buffer.
+	bc_vec_popAll(&vm->out);
+
+	// Print to the buffer.
+	bc_num_print(n, (BcBigDig) ctxt->obase, false);
+
+	return vm->out.len;
+}
+
+/**
+ * Writes the string for a number that was prepared by bcl_string_prep() and
+ * nul-terminates it.
+ * @param vm    The thread data.
+ * @param ctxt  The context.
+ * @param n     The number.
+ * @param buf   The destination. It must have room for @a len + 1 characters.
+ * @param len   The length returned by bcl_string_prep().
+ */
+static void
+bcl_string_write(BcVm* vm, BclContext ctxt, const BcNum* n, char* buf,
+                 size_t len)
+{
+	if (ctxt->obase == BC_BASE)
+	{
+		size_t written = bc_num_decimalStr(n, buf);
+		assert(written == len);
+		BC_UNUSED(written);
+	}
+	// NOLINTNEXTLINE
+	else memcpy(buf, vm->out.v, len);
+
+	buf[len] = '\0';
+}
+
+static char*
+bcl_string_helper(BclNumber n, bool destruct)
+{
+	BclNum* nptr;
+	char* str = NULL;
+	size_t len;
+	BclContext ctxt;
+	BcVm* vm = bcl_getspecific();
+
+	BC_CHECK_CTXT_ASSERT(vm, ctxt);
+
+	BCL_CHECK_NUM_VALID(ctxt, n);
+
+	if (BC_ERR(BCL_NO_GEN(n) >= ctxt->nums.len)) return str;
+
+	BC_FUNC_HEADER(vm, err);
+
+	assert(BCL_NO_GEN(n) < ctxt->nums.len);
+
+	nptr = BCL_NUM(ctxt, n);
+
+	assert(nptr != NULL && BCL_NUM_NUM(nptr) != NULL);
+
+	len = bcl_string_prep(vm, ctxt, BCL_NUM_NUM(nptr));
+
+	// The caller is responsible for the string.
+	str = bc_vm_malloc(len + 1);
+
+	bcl_string_write(vm, ctxt, BCL_NUM_NUM(nptr), str, len);
+
+err:
+
+	if (destruct)
+	{
+		// Eat the operand.
+		bcl_num_dtor(ctxt, n, nptr);
+	}
+
+	BC_FUNC_FOOTER_NO_ERR(vm);
+
+	return str;
+}
+
+char*
+bcl_string(BclNumber n)
+{
+	return bcl_string_helper(n, true);
+}
+
+char*
+bcl_string_keep(BclNumber n)
+{
+	return bcl_string_helper(n, false);
+}
+
+size_t
+bcl_string_len(BclNumber n)
+{
+	BclNum* nptr;
+	size_t len = 0;
+	BclContext ctxt;
+	BcVm* vm = bcl_getspecific();
+
+	BC_CHECK_CTXT_ASSERT(vm, ctxt);
+
+	BCL_CHECK_NUM_VALID(ctxt, n);
+
+	if (BC_ERR(BCL_NO_GEN(n) >= ctxt->nums.len)) return len;
+
+	BC_FUNC_HEADER(vm, err);
+
+	nptr = BCL_NUM(ctxt, n);
+
+	assert(nptr != NULL && BCL_NUM_NUM(nptr) != NULL);
+
+	len = bcl_string_prep(vm, ctxt, BCL_NUM_NUM(nptr));
+
+err:
+
+	// Any error means there is no string.
+	if (BC_ERR(vm->err)) len = 0;
+
+	BC_FUNC_FOOTER_NO_ERR(vm);
+
+	return len;
+}
+
+BclError
+bcl_string_into(BclNumber n, char* restrict buf, size_t cap,
+                size_t* restrict needed)
+{
+	BclError e = BCL_ERROR_NONE;
+	BclNum* nptr;
+	size_t len;
+	BclContext ctxt;
+	BcVm* vm = bcl_getspecific();
+
+	BC_CHECK_CTXT_ERR(vm, ctxt);
+
+	BCL_CHECK_NUM_VALID(ctxt, n);
+
+	BC_FUNC_HEADER(vm, err);
+
+	assert(BCL_NO_GEN(n) < ctxt->nums.len);
+	assert(buf != NULL || !cap);
+
+	nptr = BCL_NUM(ctxt, n);
+
+	assert(nptr != NULL && BCL_NUM_NUM(nptr) != NULL);
+
+	len = bcl_string_prep(vm, ctxt, BCL_NUM_NUM(nptr));
+
+	if (needed != NULL) *needed = len;
+
+	// There must be room for the nul terminator too.
+	if (BC_ERR(len >= cap))
+	{
+		if (cap) buf[0] = '\0';
+		vm->err = BCL_ERROR_MATH_OVERFLOW;
+		goto err;
+	}
+
+	bcl_string_write(vm, ctxt, BCL_NUM_NUM(nptr), buf, len);
+
+err:
+
+	BC_FUNC_FOOTER(vm, e);
+
+	return e;
+}
+
+/// The operations for the bc operator instructions, in the same order as the
+/// instructions, starting at BC_INST_POWER.
+static const BcNumBinaryOp bcl_expr_ops[] = {
+	bc_num_pow, bc_num_mul, bc_num_div, bc_num_mod, bc_num_add, bc_num_sub,
+};
+
+/**
+ * Reads an index from bytecode. This is the same as bc_program_index(), which
+ * is not in the library.
+ * @param code  The bytecode.
+ * @param bgn   An in/out parameter; the index of the index in @a code.
+ * @return      The index at @a bgn in the bytecode vector.
+ */
+static size_t
+bcl_expr_index(const char* restrict code, size_t* restrict bgn)
+{
+	uchar amt = (uchar) code[(*bgn)++], i = 0;
+	size_t res = 0;
+
+	for (; i < amt; ++i, ++(*bgn))
+	{
+		size_t temp = ((size_t) ((int) (uchar) code[*bgn]) & UCHAR_MAX);
+		res |= (temp << (i * CHAR_BIT));
+	}
+
+	return res;
+}
+
+/**
+ * Skips whitespace in the source of an expression.
+ * @param p  The parser.
+ */
+static void
+bcl_expr_skip(BclExprParser* p)
+{
+	while (isspace((uchar) *p->s))
+	{
+		p->s += 1;
+	}
+}
+
+/**
+ * Returns the length of the name at the start of a string. Names are like bc
+ * names: lowercase letters, digits, and underscores.
+ * @param s  The string.
+ * @return   The length of the name.
+ */
+static size_t
+bcl_expr_nameLen(const char* s)
+{
+	size_t i = 0;
+
+	while (islower((uchar) s[i]) || isdigit((uchar) s[i]) || s[i] == '_')
+	{
+		i += 1;
+	}
+
+	return i;
+}
+
+/**
+ * Pushes an instruction that pushes an item onto the stack, along with its
+ * index.
+ * @param p     The parser.
+ * @param inst  The instruction.
+ * @param idx   The index of the constant or argument.
+ */
+static void
+bcl_expr_pushItem(BclExprParser* p, uchar inst, size_t idx)
+{
+	bc_vec_pushByte(&p->e->code, inst);
+	bc_vec_pushIndex(&p->e->code, idx);
+
+	p->sp += 1;
+	if (p->sp > p->e->depth) p->e->depth = p->sp;
+}
+
+/**
+ * Pushes an operator instruction, which takes two items off the stack and
+ * pushes one.
+ * @param p     The parser.
+ * @param inst  The instruction.
+ */
+static void
+bcl_expr_pushOp(BclExprParser* p, uchar inst)
+{
+	assert(p->sp >= 2);
+
+	bc_vec_pushByte(&p->e->code, inst);
+	p->sp -= 1;
+}
+
+/**
+ * Compiles a number constant.
+ * @param p  The parser.
+ * @return   True if the constant was valid, false otherwise.
+ */
+static bool
+bcl_expr_num(BclExprParser* p)
+{
+	size_t len = 0;
+	BcNum* n;
+
+	while (isdigit((uchar) p->s[len]) || isupper((uchar) p->s[len]) ||
+	       p->s[len] == '.')
+	{
+		len += 1;
+	}
+
+	if (!bc_num_strValidLen(p->s, len)) return false;
+
+	// The number is cleared first so it is safe to free if parsing fails.
+	n = bc_vec_pushEmpty(&p->e->consts);
+	bc_num_clear(n);
+	bc_num_init(n, BC_NUM_DEF_SIZE);
+	bc_num_parseLen(n, p->s, len, (BcBigDig) p->ibase);
+
+	p->s += len;
+
+	bcl_expr_pushItem(p, BC_INST_NUM, p->e->consts.len - 1);
+
+	return true;
+}
+
+/**
+ * Compiles a name, which is an argument.
+ * @param p  The parser.
+ */
+static void
+bcl_expr_name(BclExprParser* p)
+{
+	size_t i, len = bcl_expr_nameLen(p->s);
+
+	for (i = 0; i < p->names.len; ++i)
+	{
+		const char* name = *((const char**) bc_vec_item(&p->names, i));
+
+		if (bcl_expr_nameLen(name) == len && !strncmp(name, p->s, len)) break;
+	}
+
+	// Arguments are numbered in the order they first appear.
+	if (i == p->names.len)
+	{
+		bc_vec_push(&p->names, &p->s);
+		p->e->nargs += 1;
+	}
+
+	p->s += len;
+
+	bcl_expr_pushItem(p, BC_INST_VAR, i);
+}
+
+static bool
+bcl_expr_expr(BclExprParser* p);
+
+/**
+ * Compiles a unary expression: a number, a name, or a parenthesized
+ * expression, with any number of unary minus signs in front.
+ * @param p  The parser.
+ * @return   True if the expression was valid, false otherwise.
+ */
+static bool
+bcl_expr_unary(BclExprParser* p)
+{
+	bool neg = false;
+	char c;
+
+	bcl_expr_skip(p);
+
+	// Like in bc, unary minus binds tighter than everything else, even power.
+	while (*p->s == '-')
+	{
+		neg = !neg;
+		p->s += 1;
+		bcl_expr_skip(p);
+	}
+
+	c = *p->s;
+
+	if (c == '(')
+	{
+		if (BC_ERR(p->nest >= BCL_EXPR_MAX_DEPTH)) return false;
+
+		p->s += 1;
+		p->nest += 1;
+
+		if (!bcl_expr_expr(p)) return false;
+
+		p->nest -= 1;
+
+		bcl_expr_skip(p);
+		if (*p->s != ')') return false;
+		p->s += 1;
+	}
+	else if (isdigit((uchar) c) || isupper((uchar) c) || c == '.')
+	{
+		if (!bcl_expr_num(p)) return false;
+	}
+	else if (islower((uchar) c)) bcl_expr_name(p);
+	else return false;
 
-	assert(c != NULL && d != NULL);
+	if (neg) bc_vec_pushByte(&p->e->code, BC_INST_NEG);
 
-	aptr = BCL_NUM(ctxt, a);
-	bptr = BCL_NUM(ctxt, b);
+	return true;
+}
 
-	assert(aptr != NULL && bptr != NULL);
-	assert(BCL_NUM_ARRAY(aptr) != NULL && BCL_NUM_ARRAY(bptr) != NULL);
+/**
+ * Compiles a power expression. Power is right associative, so all of the
+ * operands are pushed first, and then all of the operators.
+ * @param p  The parser.
+ * @return   True if the expression was valid, false otherwise.
+ */
+static bool
+bcl_expr_power(BclExprParser* p)
+{
+	size_t ops = 0;
 
-	bc_num_clear(BCL_NUM_NUM_NP(cnum));
-	bc_num_clear(BCL_NUM_NUM_NP(dnum));
+	if (!bcl_expr_unary(p)) return false;
 
-	req = bc_num_divReq(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr), ctxt->scale);
+	bcl_expr_skip(p);
 
-	// Initialize the numbers.
-	bc_num_init(BCL_NUM_NUM_NP(cnum), req);
-	BC_UNSETJMP(vm);
-	BC_SETJMP(vm, err);
-	bc_num_init(BCL_NUM_NUM_NP(dnum), req);
+	while (*p->s == '^')
+	{
+		p->s += 1;
 
-	bc_num_divmod(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr), BCL_NUM_NUM_NP(cnum),
-	              BCL_NUM_NUM_NP(dnum), ctxt->scale);
+		if (!bcl_expr_unary(p)) return false;
 
-err:
+		ops += 1;
+		bcl_expr_skip(p);
+	}
 
-	if (destruct)
+	for (; ops; --ops)
 	{
-		// Eat the operands.
-		bcl_num_dtor(ctxt, a, aptr);
-		if (b.i != a.i) bcl_num_dtor(ctxt, b, bptr);
+		bcl_expr_pushOp(p, BC_INST_POWER);
 	}
 
-	// If there was an error...
-	if (BC_ERR(vm->err))
-	{
-		// Free the results.
-		if (BCL_NUM_ARRAY_NP(cnum) != NULL) bc_num_free(&cnum);
-		if (BCL_NUM_ARRAY_NP(cnum) != NULL) bc_num_free(&dnum);
+	return true;
+}
 
-		// Make sure the return values are invalid.
-		c->i = 0 - (size_t) BCL_ERROR_INVALID_NUM;
-		d->i = c->i;
+/**
+ * Compiles a multiplicative expression.
+ * @param p  The parser.
+ * @return   True if the expression was valid, false otherwise.
+ */
+static bool
+bcl_expr_term(BclExprParser* p)
+{
+	if (!bcl_expr_power(p)) return false;
 
-		BC_FUNC_FOOTER(vm, e);
-	}
-	else
+	while (*p->s == '*' || *p->s == '/' || *p->s == '%')
 	{
-		BC_FUNC_FOOTER(vm, e);
+		uchar inst = *p->s == '*' ? BC_INST_MULTIPLY :
+		             *p->s == '/' ? BC_INST_DIVIDE :
+		                            BC_INST_MODULUS;
 
-		// Insert the results into the context.
-		*c = bcl_num_insert(ctxt, &cnum);
-		*d = bcl_num_insert(ctxt, &dnum);
+		p->s += 1;
+
+		if (!bcl_expr_power(p)) return false;
+
+		bcl_expr_pushOp(p, inst);
 	}
 
-	return e;
+	return true;
 }
 
-BclError
-bcl_divmod(BclNumber a, BclNumber b, BclNumber* c, BclNumber* d)
+/**
+ * Compiles an additive expression, which is a full expression.
+ * @param p  The parser.
+ * @return   True if the expression was valid, false otherwise.
+ */
+static bool
+bcl_expr_expr(BclExprParser* p)
 {
-	return bcl_divmod_helper(a, b, c, d, true);
-}
+	if (!bcl_expr_term(p)) return false;
 
-BclError
-bcl_divmod_keep(BclNumber a, BclNumber b, BclNumber* c, BclNumber* d)
-{
-	return bcl_divmod_helper(a, b, c, d, false);
+	while (*p->s == '+' || *p->s == '-')
+	{
+		uchar inst = *p->s == '+' ? BC_INST_PLUS : BC_INST_MINUS;
+
+		p->s += 1;
+
+		if (!bcl_expr_term(p)) return false;
+
+		bcl_expr_pushOp(p, inst);
+	}
+
+	return true;
 }
 
-static BclNumber
-bcl_modexp_helper(BclNumber a, BclNumber b, BclNumber c, bool destruct)
+BclExpr
+bcl_expr_compile(const char* restrict expr)
 {
-	BclError e = BCL_ERROR_NONE;
-	size_t req;
-	BclNum* aptr;
-	BclNum* bptr;
-	BclNum* cptr;
-	BclNum d;
-	BclNumber idx;
+	BclExprParser p;
+	BclExpression* e = NULL;
 	BclContext ctxt;
+	BclArena* arena;
 	BcVm* vm = bcl_getspecific();
 
-	BC_CHECK_CTXT(vm, ctxt);
+	ctxt = bcl_contextHelper(vm);
+	if (BC_ERR(ctxt == NULL)) return NULL;
 
-	BC_CHECK_NUM(ctxt, a);
-	BC_CHECK_NUM(ctxt, b);
-	BC_CHECK_NUM(ctxt, c);
+	assert(expr != NULL);
 
-	BC_FUNC_HEADER(vm, err);
+	// These need to be set before anything can jump.
+	p.names.v = NULL;
 
-	BCL_GROW_NUMS(ctxt);
+	// The constants outlive the context, so they cannot come from its arena.
+	arena = bcl_setArena(vm, NULL);
 
-	assert(BCL_NO_GEN(a) < ctxt->nums.len && BCL_NO_GEN(b) < ctxt->nums.len);
-	assert(BCL_NO_GEN(c) < ctxt->nums.len);
+	BC_FUNC_HEADER(vm, err);
 
-	aptr = BCL_NUM(ctxt, a);
-	bptr = BCL_NUM(ctxt, b);
-	cptr = BCL_NUM(ctxt, c);
+	e = bc_vm_malloc(sizeof(BclExpression));
 
-	assert(aptr != NULL && bptr != NULL && cptr != NULL);
-	assert(BCL_NUM_NUM(aptr) != NULL && BCL_NUM_NUM(bptr) != NULL &&
-	       BCL_NUM_NUM(cptr) != NULL);
+	e->code.v = NULL;
+	e->consts.v = NULL;
+	e->nargs = 0;
+	e->depth = 0;
 
-	// Prepare the result.
-	bc_num_clear(BCL_NUM_NUM_NP(d));
+	bc_vec_init(&e->code, sizeof(uchar), BC_DTOR_NONE);
+	bc_vec_init(&e->consts, sizeof(BcNum), BC_DTOR_NUM);
+	bc_vec_init(&p.names, sizeof(const char*), BC_DTOR_NONE);
 
-	req = bc_num_divReq(BCL_NUM_NUM(aptr), BCL_NUM_NUM(cptr), 0);
+	p.s = expr;
+	p.e = e;
+	p.sp = 0;
+	p.nest = 0;
+	p.ibase = ctxt->ibase;
 
-	// Initialize the result.
-	bc_num_init(BCL_NUM_NUM_NP(d), req);
+	if (!bcl_expr_expr(&p) || (bcl_expr_skip(&p), *p.s != '\0'))
+	{
+		vm->err = BCL_ERROR_PARSE_INVALID_STR;
+		goto err;
+	}
 
-	bc_num_modexp(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr), BCL_NUM_NUM(cptr),
-	              BCL_NUM_NUM_NP(d));
+	assert(p.sp == 1);
 
 err:
 
-	if (destruct)
+	if (p.names.v != NULL) bc_vec_free(&p.names);
+
+	if (BC_ERR(vm->err && e != NULL))
 	{
-		// Eat the operands.
-		bcl_num_dtor(ctxt, a, aptr);
-		if (b.i != a.i) bcl_num_dtor(ctxt, b, bptr);
-		if (c.i != a.i && c.i != b.i) bcl_num_dtor(ctxt, c, cptr);
+		bcl_expr_free(e);
+		e = NULL;
 	}
 
-	BC_FUNC_FOOTER(vm, e);
-	BC_MAYBE_SETUP(ctxt, e, d, idx);
-
-	return idx;
-}
+	vm->arena = arena;
 
-BclNumber
-bcl_modexp(BclNumber a, BclNumber b, BclNumber c)
-{
-	return bcl_modexp_helper(a, b, c, true);
-}
+	BC_FUNC_FOOTER_NO_ERR(vm);
 
-BclNumber
-bcl_modexp_keep(BclNumber a, BclNumber b, BclNumber c)
-{
-	return bcl_modexp_helper(a, b, c, false);
+	return e;
 }
 
-ssize_t
-bcl_cmp(BclNumber a, BclNumber b)
+void
+bcl_expr_free(BclExpr expr)
 {
-	BclNum* aptr;
-	BclNum* bptr;
-	BclContext ctxt;
+	BclArena* arena;
 	BcVm* vm = bcl_getspecific();
 
-	BC_CHECK_CTXT_ASSERT(vm, ctxt);
+	if (expr == NULL) return;
 
-	BCL_CHECK_NUM_VALID(ctxt, a);
-	BCL_CHECK_NUM_VALID(ctxt, b);
+	// The constants were not allocated from any arena.
+	arena = bcl_setArena(vm, NULL);
 
-	assert(BCL_NO_GEN(a) < ctxt->nums.len && BCL_NO_GEN(b) < ctxt->nums.len);
+	if (expr->code.v != NULL) bc_vec_free(&expr->code);
+	if (expr->consts.v != NULL) bc_vec_free(&expr->consts);
 
-	aptr = BCL_NUM(ctxt, a);
-	bptr = BCL_NUM(ctxt, b);
+	vm->arena = arena;
 
-	assert(aptr != NULL && bptr != NULL);
-	assert(BCL_NUM_NUM(aptr) != NULL && BCL_NUM_NUM(bptr));
+	free(expr);
+}
 
-	return bc_num_cmp(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr));
+size_t
+bcl_expr_nargs(BclExpr expr)
+{
+	return expr->nargs;
 }
 
-void
-bcl_zero(BclNumber n)
+/**
+ * Runs a compiled expression. The result is left in the first number of the
+ * context's expression stack. The arguments must have already been checked, and
+ * the caller must have set up the jump.
+ * @param ctxt  The context.
+ * @param e     The expression.
+ * @param args  The arguments.
+ */
+static void
+bcl_expr_run(BclContext ctxt, const BclExpression* e, const BclNumber* args)
 {
-	BclNum* nptr;
-	BclContext ctxt;
-	BcVm* vm = bcl_getspecific();
+	const char* code = e->code.v;
+	size_t i = 0, sp = 0;
+	BcNum* stack;
+	BcNumBinaryOp op;
 
-	BC_CHECK_CTXT_ASSERT(vm, ctxt);
+	// The stack keeps its numbers between evaluations. New ones start cleared
+	// and are only allocated when something is copied into them.
+	while (ctxt->expr_stack.len < e->depth)
+	{
+		bc_num_clear(bc_vec_pushEmpty(&ctxt->expr_stack));
+	}
 
-	BCL_CHECK_NUM_VALID(ctxt, n);
+	stack = (BcNum*) ctxt->expr_stack.v;
 
-	assert(BCL_NO_GEN(n) < ctxt->nums.len);
+	while (i < e->code.len)
+	{
+		uchar inst = (uchar) code[i++];
 
-	nptr = BCL_NUM(ctxt, n);
+		switch (inst)
+		{
+			case BC_INST_NUM:
+			{
+				size_t idx = bcl_expr_index(code, &i);
 
-	assert(nptr != NULL && BCL_NUM_NUM(nptr) != NULL);
+				bc_num_copy(&stack[sp], bc_vec_item(&e->consts, idx));
+				sp += 1;
 
-	bc_num_zero(BCL_NUM_NUM(nptr));
-}
+				break;
+			}
 
-void
-bcl_one(BclNumber n)
-{
-	BclNum* nptr;
-	BclContext ctxt;
-	BcVm* vm = bcl_getspecific();
+			case BC_INST_VAR:
+			{
+				size_t idx = bcl_expr_index(code, &i);
 
-	BC_CHECK_CTXT_ASSERT(vm, ctxt);
+				bc_num_copy(&stack[sp], BCL_NUM_NUM(BCL_NUM(ctxt, args[idx])));
+				sp += 1;
 
-	BCL_CHECK_NUM_VALID(ctxt, n);
+				break;
+			}
 
-	assert(BCL_NO_GEN(n) < ctxt->nums.len);
+			case BC_INST_NEG:
+			{
+				assert(sp >= 1);
 
-	nptr = BCL_NUM(ctxt, n);
+				if (BC_NUM_NONZERO(&stack[sp - 1]))
+				{
+					BC_NUM_NEG_TGL(&stack[sp - 1]);
+				}
 
-	assert(nptr != NULL && BCL_NUM_NUM(nptr) != NULL);
+				break;
+			}
 
-	bc_num_one(BCL_NUM_NUM(nptr));
+			default:
+			{
+				assert(inst >= BC_INST_POWER && inst <= BC_INST_MINUS);
+				assert(sp >= 2);
+
+				// The result goes into the scratch number, which is then
+				// swapped in, so the old limbs are kept for next time.
+				op = bcl_op(ctxt, bcl_expr_ops[inst - BC_INST_POWER]);
+				op(&stack[sp - 2], &stack[sp - 1], &ctxt->scratch,
+				   ctxt->scale);
+
+				bcl_num_swap(&stack[sp - 2], &ctxt->scratch);
+				sp -= 1;
+
+				break;
+			}
+		}
+	}
+
+	assert(sp == 1);
 }
 
 BclNumber
-bcl_parse(const char* restrict val)
+bcl_expr_eval(BclExpr expr, const BclNumber* args)
 {
 	BclError e = BCL_ERROR_NONE;
-	BclNum n;
+	size_t i;
+	BclNum c;
 	BclNumber idx;
 	BclContext ctxt;
 	BcVm* vm = bcl_getspecific();
-	bool neg;
 
 	BC_CHECK_CTXT(vm, ctxt);
 
-	BC_FUNC_HEADER(vm, err);
-
-	BCL_GROW_NUMS(ctxt);
-
-	assert(val != NULL);
-
-	// We have to take care of negative here because bc's number parsing does
-	// not.
-	neg = (val[0] == '-');
-
-	if (neg) val += 1;
+	assert(expr != NULL && (!expr->nargs || args != NULL));
 
-	if (!bc_num_strValid(val))
+	for (i = 0; i < expr->nargs; ++i)
 	{
-		vm->err = BCL_ERROR_PARSE_INVALID_STR;
-		goto err;
+		BC_CHECK_NUM(ctxt, args[i]);
 	}
 
-	// Clear and initialize the number.
-	bc_num_clear(BCL_NUM_NUM_NP(n));
-	bc_num_init(BCL_NUM_NUM_NP(n), BC_NUM_DEF_SIZE);
+	// This needs to be cleared before anything can jump.
+	bc_num_clear(BCL_NUM_NUM_NP(c));
 
-	bc_num_parse(BCL_NUM_NUM_NP(n), val, (BcBigDig) ctxt->ibase);
+	BC_FUNC_HEADER(vm, err);
 
-	// Set the negative.
-#if BC_ENABLE_MEMCHECK
-	n.n.rdx = BC_NUM_NEG_VAL(BCL_NUM_NUM_NP(n), neg);
-#else // BC_ENABLE_MEMCHECK
-	n.rdx = BC_NUM_NEG_VAL_NP(n, neg);
-#endif // BC_ENABLE_MEMCHECK
+	BCL_GROW_NUMS(ctxt);
+
+	bcl_expr_run(ctxt, expr, args);
+
+	// Move the result out of the stack. Its spot is refilled on the next
+	// evaluation.
+	// NOLINTNEXTLINE
+	memcpy(BCL_NUM_NUM_NP(c), bc_vec_item(&ctxt->expr_stack, 0), sizeof(BcNum));
+	bc_num_clear(bc_vec_item(&ctxt->expr_stack, 0));
 
 err:
 
 	BC_FUNC_FOOTER(vm, e);
-	BC_MAYBE_SETUP(ctxt, e, n, idx);
+	BC_MAYBE_SETUP(ctxt, e, c, idx);
 
 	return idx;
 }
 
-static char*
-bcl_string_helper(BclNumber n, bool destruct)
+BclError
+bcl_expr_eval_into(BclNumber d, BclExpr expr, const BclNumber* args)
 {
-	BclNum* nptr;
-	char* str = NULL;
+	BclError e = BCL_ERROR_NONE;
+	size_t i;
 	BclContext ctxt;
 	BcVm* vm = bcl_getspecific();
 
-	BC_CHECK_CTXT_ASSERT(vm, ctxt);
-
-	BCL_CHECK_NUM_VALID(ctxt, n);
-
-	if (BC_ERR(BCL_NO_GEN(n) >= ctxt->nums.len)) return str;
-
-	BC_FUNC_HEADER(vm, err);
+	BC_CHECK_CTXT_ERR(vm, ctxt);
 
-	assert(BCL_NO_GEN(n) < ctxt->nums.len);
+	assert(expr != NULL && (!expr->nargs || args != NULL));
 
-	nptr = BCL_NUM(ctxt, n);
+	BC_CHECK_NUM_ERR(ctxt, d);
 
-	assert(nptr != NULL && BCL_NUM_NUM(nptr) != NULL);
+	for (i = 0; i < expr->nargs; ++i)
+	{
+		BC_CHECK_NUM_ERR(ctxt, args[i]);
+	}
 
-	// Clear the buffer.
-	bc_vec_popAll(&vm->out);
+	BC_FUNC_HEADER(vm, err);
 
-	// Print to the buffer.
-	bc_num_print(BCL_NUM_NUM(nptr), (BcBigDig) ctxt->obase, false);
-	bc_vec_pushByte(&vm->out, '\0');
+	bcl_expr_run(ctxt, expr, args);
 
-	// Just dup the string; the caller is responsible for it.
-	str = bc_vm_strdup(vm->out.v);
+	// Swapping keeps the old limbs of the destination on the stack for next
+	// time. It is done after the run, so the destination can be an argument.
+	bcl_num_swap(BCL_NUM_NUM(BCL_NUM(ctxt, d)),
+	             bc_vec_item(&ctxt->expr_stack, 0));
 
 err:
 
-	if (destruct)
-	{
-		// Eat the operand.
-		bcl_num_dtor(ctxt, n, nptr);
-	}
-
-	BC_FUNC_FOOTER_NO_ERR(vm);
-
-	return str;
-}
-
-char*
-bcl_string(BclNumber n)
-{
-	return bcl_string_helper(n, true);
-}
+	BC_FUNC_FOOTER(vm, e);
 
-char*
-bcl_string_keep(BclNumber n)
-{
-	return bcl_string_helper(n, false);
+	return e;
 }
 
 #if BC_ENABLE_EXTRA_MATH
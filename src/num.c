@@ -40,6 +40,10 @@
 #include <string.h>
 #include <setjmp.h>
 #include <limits.h>
+#if BC_ENABLE_LIBRARY
+#include <float.h>
+#include <math.h>
+#endif // BC_ENABLE_LIBRARY
 
 #include <num.h>
 #include <rand.h>
@@ -48,6 +52,14 @@
 #include <library.h>
 #endif // BC_ENABLE_LIBRARY
 
+// In the library, long-running loops check for cancellation and deadlines with
+// this. It must only be used where a jump would be safe.
+#if BC_ENABLE_LIBRARY
+#define BC_NUM_POLL(vm, work) BCL_POLL(vm, work)
+#else // BC_ENABLE_LIBRARY
+#define BC_NUM_POLL(vm, work)
+#endif // BC_ENABLE_LIBRARY
+
 // Before you try to understand this code, see the development manual
 // (manuals/development.md#numbers).
 
@@ -110,6 +122,10 @@ bc_num_int(const BcNum* n)
 static void
 bc_num_expand(BcNum* restrict n, size_t req)
 {
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
+
 	assert(n != NULL);
 
 	req = req >= BC_NUM_DEF_SIZE ? req : BC_NUM_DEF_SIZE;
@@ -118,7 +134,18 @@ bc_num_expand(BcNum* restrict n, size_t req)
 	{
 		BC_SIG_LOCK;
 
-		n->num = bc_vm_realloc(n->num, BC_NUM_SIZE(req));
+#if BC_ENABLE_LIBRARY
+		if (vm->arena != NULL)
+		{
+			n->num = bcl_arena_realloc(vm->arena, n->num, BC_NUM_SIZE(n->cap),
+			                           BC_NUM_SIZE(req));
+		}
+		else
+#endif // BC_ENABLE_LIBRARY
+		{
+			n->num = bc_vm_realloc(n->num, BC_NUM_SIZE(req));
+		}
+
 		n->cap = req;
 
 		BC_SIG_UNLOCK;
@@ -1199,6 +1226,9 @@ bc_num_m_simp(const BcNum* a, const BcNum* b, BcNum* restrict c)
 	BcDig* ptr_b = b->num;
 	BcDig* ptr_c;
 	BcBigDig sum = 0, carry = 0;
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
 
 	assert(sizeof(sum) >= sizeof(BcDig) * 2);
 	assert(!BC_NUM_RDX_VAL(a) && !BC_NUM_RDX_VAL(b));
@@ -1225,6 +1255,9 @@ bc_num_m_simp(const BcNum* a, const BcNum* b, BcNum* restrict c)
 		j = (size_t) BC_MAX(0, sidx);
 		k = BC_MIN(i, blen - 1);
 
+		// The work is the multiplications that the inner loop does.
+		BC_NUM_POLL(vm, BC_MIN(alen - j, k + 1) + 1);
+
 		// On every iteration of this loop, a multiplication happens, then the
 		// sum is automatically calculated.
 		for (; j < alen && k < blen; ++j, --k)
@@ -1352,6 +1385,10 @@ bc_num_k(const BcNum* a, const BcNum* b, BcNum* restrict c)
 
 	BC_SIG_UNLOCK;
 
+	// The recursive calls poll for themselves, so this only counts the adds and
+	// subtracts done here.
+	BC_NUM_POLL(vm, max);
+
 	// First, set up c.
 	bc_num_expand(c, max);
 	c->len = max;
@@ -1758,6 +1795,10 @@ bc_num_d_long(BcNum* restrict a, BcNum* restrict b, BcNum* restrict c,
 		BcDig* n;
 		BcBigDig result;
 
+		// Every trip around the inner loop works on len limbs, and it usually
+		// takes only one or two.
+		BC_NUM_POLL(vm, len);
+
 		n = a->num + i;
 		assert(n >= a->num);
 		result = 0;
@@ -2111,6 +2152,9 @@ bc_num_p(BcNum* a, BcNum* b, BcNum* restrict c, size_t scale)
 	// reaches the first time where the square is actually used.
 	for (powrdx = a->scale; !(exp & 1); exp >>= 1)
 	{
+		// The multiplication polls for itself.
+		BC_NUM_POLL(vm, 1);
+
 		powrdx <<= 1;
 		assert(BC_NUM_RDX_VALID_NP(copy));
 		bc_num_mul(&copy, &copy, &copy, powrdx);
@@ -2125,6 +2169,9 @@ bc_num_p(BcNum* a, BcNum* b, BcNum* restrict c, size_t scale)
 	// as necessary.
 	while (exp >>= 1)
 	{
+		// The multiplication polls for itself.
+		BC_NUM_POLL(vm, 1);
+
 		powrdx <<= 1;
 		assert(BC_NUM_RDX_VALID_NP(copy));
 		bc_num_mul(&copy, &copy, &copy, powrdx);
@@ -2305,9 +2352,15 @@ err:
  */
 bool
 bc_num_strValid(const char* restrict val)
+{
+	return bc_num_strValidLen(val, strlen(val));
+}
+
+bool
+bc_num_strValidLen(const char* restrict val, size_t len)
 {
 	bool radix = false;
-	size_t i, len = strlen(val);
+	size_t i;
 
 	// Notice that I don't check if there is a negative sign. That is not part
 	// of a valid number, except in the library. The library-specific code takes
@@ -2377,11 +2430,12 @@ bc_num_parseChar(char c, size_t base)
  * be the most used, and it can be heavily optimized for decimal only.
  * @param n    The number to parse into and return. Must be preallocated.
  * @param val  The string to parse.
+ * @param len  The length of the string.
  */
 static void
-bc_num_parseDecimal(BcNum* restrict n, const char* restrict val)
+bc_num_parseDecimal(BcNum* restrict n, const char* restrict val, size_t len)
 {
-	size_t len, i, temp, mod;
+	size_t i, temp, mod;
 	const char* ptr;
 	bool zero = true, rdx;
 #if BC_ENABLE_LIBRARY
@@ -2389,24 +2443,25 @@ bc_num_parseDecimal(BcNum* restrict n, const char* restrict val)
 #endif // BC_ENABLE_LIBRARY
 
 	// Eat leading zeroes.
-	for (i = 0; val[i] == '0'; ++i)
+	for (i = 0; i < len && val[i] == '0'; ++i)
 	{
 		continue;
 	}
 
 	val += i;
-	assert(!val[0] || isalnum(val[0]) || val[0] == '.');
+	len -= i;
 
 	// All 0's. We can just return, since this procedure expects a virgin
 	// (already 0) BcNum.
-	if (!val[0]) return;
+	if (!len) return;
+
+	assert(isalnum(val[0]) || val[0] == '.');
 
 	// The length of the string is the length of the number, except it might be
 	// one bigger because of a decimal point.
-	len = strlen(val);
 
 	// Find the location of the decimal point.
-	ptr = strchr(val, '.');
+	ptr = memchr(val, '.', len);
 	rdx = (ptr != NULL);
 
 	// We eat leading zeroes again. These leading zeroes are different because
@@ -2514,10 +2569,12 @@ bc_num_parseDecimal(BcNum* restrict n, const char* restrict val)
  * Parse a number in any base (besides decimal).
  * @param n     The number to parse into and return. Must be preallocated.
  * @param val   The string to parse.
+ * @param len   The length of the string.
  * @param base  The base to parse as.
  */
 static void
-bc_num_parseBase(BcNum* restrict n, const char* restrict val, BcBigDig base)
+bc_num_parseBase(BcNum* restrict n, const char* restrict val, size_t len,
+                 BcBigDig base)
 {
 	BcNum temp, mult1, mult2, result1, result2;
 	BcNum* m1;
@@ -2526,7 +2583,7 @@ bc_num_parseBase(BcNum* restrict n, const char* restrict val, BcBigDig base)
 	char c = 0;
 	bool zero = true;
 	BcBigDig v;
-	size_t digs, len = strlen(val);
+	size_t digs;
 	// This is volatile to quiet a warning on GCC about longjmp() clobbering.
 	volatile size_t i;
 #if BC_ENABLE_LIBRARY
@@ -2569,7 +2626,7 @@ bc_num_parseBase(BcNum* restrict n, const char* restrict val, BcBigDig base)
 
 	// If this condition is true, then we are done. We still need to do cleanup
 	// though.
-	if (i == len && !val[i]) goto int_err;
+	if (i == len) goto int_err;
 
 	// If we get here, we *must* be at the radix point.
 	assert(val[i] == '.');
@@ -2683,6 +2740,47 @@ bc_num_putchar(int c, bool bslash)
 	bc_vm_putchar(c, bc_flush_save);
 }
 
+/**
+ * Prints a string of characters, none of which are newlines. This does the
+ * same as calling bc_num_putchar() on each character, with true for all but the
+ * last, but it puts as many characters on the output as it can at once.
+ * @param str     The characters to print.
+ * @param len     The number of characters.
+ * @param bslash  Whether to print a backslash+newline before the last
+ *                character, if needed.
+ */
+static void
+bc_num_putchars(const char* restrict str, size_t len, bool bslash)
+{
+#if !BC_ENABLE_LIBRARY
+	while (len)
+	{
+		size_t n = len;
+
+		// Figure out how many characters fit before the next backslash+newline.
+		if (vm->line_len)
+		{
+			size_t max = (size_t) (vm->line_len - 1);
+
+			if (vm->nchars < max) n = BC_MIN(len, max - vm->nchars);
+			else if (len > 1 || bslash)
+			{
+				bc_num_printNewline();
+				continue;
+			}
+		}
+
+		bc_vm_write(str, n, bc_flush_save);
+
+		str += n;
+		len -= n;
+	}
+#else // !BC_ENABLE_LIBRARY
+	BC_UNUSED(bslash);
+	bc_vm_write(str, len, bc_flush_save);
+#endif // !BC_ENABLE_LIBRARY
+}
+
 #if !BC_ENABLE_LIBRARY
 
 /**
@@ -2779,15 +2877,16 @@ bc_num_printHex(size_t n, size_t len, bool rdx, bool bslash)
 static void
 bc_num_printDecimal(const BcNum* restrict n, bool newline)
 {
-	size_t i, j, rdx = BC_NUM_RDX_VAL(n);
+	size_t i, j, temp, rdx = BC_NUM_RDX_VAL(n), len = 0;
 	bool zero = true;
-	size_t buffer[BC_BASE_DIGS];
+	char digs[BC_BASE_DIGS];
+	char buf[BC_NUM_PRINT_BUF_SIZE];
 
-	// Print loop.
+	// Print loop. The digits are put into buf and printed a buffer at a time,
+	// which is much faster than printing them one at a time.
 	for (i = n->len - 1; i < n->len; --i)
 	{
 		BcDig n9 = n->num[i];
-		size_t temp;
 		bool irdx = (i == rdx - 1);
 
 		// Calculate the number of digits in the limb.
@@ -2795,37 +2894,39 @@ bc_num_printDecimal(const BcNum* restrict n, bool newline)
 		temp = n->scale % BC_BASE_DIGS;
 		temp = i || !temp ? 0 : BC_BASE_DIGS - temp;
 
-		// NOLINTNEXTLINE
-		memset(buffer, 0, BC_BASE_DIGS * sizeof(size_t));
+		// Make sure there is room for a whole limb and a decimal point. This is
+		// never the last print, so the last character can have a
+		// backslash+newline before it.
+		if (len > BC_NUM_PRINT_BUF_SIZE - BC_BASE_DIGS - 1)
+		{
+			bc_num_putchars(buf, len, true);
+			len = 0;
+		}
 
-		// Fill the buffer with individual digits.
-		for (j = 0; n9 && j < BC_BASE_DIGS; ++j)
+		// Fill the digits, least significant first.
+		for (j = 0; j < BC_BASE_DIGS; ++j)
 		{
-			buffer[j] = ((size_t) n9) % BC_BASE;
+			digs[j] = (char) (n9 % BC_BASE) + '0';
 			n9 /= BC_BASE;
 		}
 
-		// Print the digits in the buffer.
+		// Put the digits in the buffer.
 		for (j = BC_BASE_DIGS - 1; j < BC_BASE_DIGS && j >= temp; --j)
 		{
-			// Figure out whether to print the decimal point.
-			bool print_rdx = (irdx & (j == BC_BASE_DIGS - 1));
+			// Put the decimal point, if necessary.
+			if (irdx && j == BC_BASE_DIGS - 1) buf[len++] = '.';
 
 			// The zero variable helps us skip leading zero digits in the limb.
-			zero = (zero && buffer[j] == 0);
+			zero = (zero && digs[j] == '0');
 
-			if (!zero)
-			{
-				// While the first three arguments should be self-explanatory,
-				// the last needs explaining. I don't want to print a newline
-				// when the last digit to be printed could take the place of the
-				// backslash rather than being pushed, as a single character, to
-				// the next line. That's what that last argument does for bc.
-				bc_num_printHex(buffer[j], 1, print_rdx,
-				                !newline || (j > temp || i != 0));
-			}
+			if (!zero) buf[len++] = digs[j];
 		}
 	}
+
+	// I don't want to print a newline when the last digit to be printed could
+	// take the place of the backslash rather than being pushed, as a single
+	// character, to the next line. That's what the last argument does for bc.
+	bc_num_putchars(buf, len, !newline);
 }
 
 #if BC_ENABLE_EXTRA_MATH
@@ -3009,11 +3110,16 @@ static void
 bc_num_printPrepare(BcNum* restrict n, BcBigDig rem, BcBigDig pow)
 {
 	size_t i;
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
 
 	// Loop from the least significant limb to the most significant limb and
 	// convert limbs in each pass.
 	for (i = 0; i < n->len; ++i)
 	{
+		// The fixup works on all of the limbs above this one.
+		BC_NUM_POLL(vm, n->len - i);
 		bc_num_printFixup(n, rem, pow, i);
 	}
 
@@ -3172,6 +3278,8 @@ bc_num_printNum(BcNum* restrict n, BcBigDig base, size_t len,
 	// Fill the stack of digits for the integer part.
 	for (i = 0; i < intp.len; ++i)
 	{
+		BC_NUM_POLL(vm, exp);
+
 		// Get the limb.
 		acc = (BcBigDig) intp.num[i];
 
@@ -3373,6 +3481,9 @@ void
 bc_num_init(BcNum* restrict n, size_t req)
 {
 	BcDig* num;
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
 
 	BC_SIG_ASSERT_LOCKED;
 
@@ -3382,6 +3493,15 @@ bc_num_init(BcNum* restrict n, size_t req)
 	// malloc() returns in practice, so just use it.
 	req = req >= BC_NUM_DEF_SIZE ? req : BC_NUM_DEF_SIZE;
 
+#if BC_ENABLE_LIBRARY
+	// Temps come from malloc(), so they cannot be mixed with arena memory.
+	if (vm->arena != NULL)
+	{
+		bc_num_setup(n, bcl_arena_malloc(vm->arena, BC_NUM_SIZE(req)), req);
+		return;
+	}
+#endif // BC_ENABLE_LIBRARY
+
 	// If we can't use a temp, allocate.
 	if (req != BC_NUM_DEF_SIZE) num = bc_vm_malloc(BC_NUM_SIZE(req));
 	else
@@ -3404,11 +3524,22 @@ void
 bc_num_free(void* num)
 {
 	BcNum* n = (BcNum*) num;
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
 
 	BC_SIG_ASSERT_LOCKED;
 
 	assert(n != NULL);
 
+#if BC_ENABLE_LIBRARY
+	if (vm->arena != NULL)
+	{
+		bcl_arena_free(vm->arena, n->num, BC_NUM_SIZE(n->cap));
+		return;
+	}
+#endif // BC_ENABLE_LIBRARY
+
 	if (n->cap == BC_NUM_DEF_SIZE) bc_vm_addTemp(n->num);
 	else free(n->num);
 }
@@ -3491,6 +3622,13 @@ bc_num_len(const BcNum* restrict n)
 
 void
 bc_num_parse(BcNum* restrict n, const char* restrict val, BcBigDig base)
+{
+	bc_num_parseLen(n, val, strlen(val), base);
+}
+
+void
+bc_num_parseLen(BcNum* restrict n, const char* restrict val, size_t len,
+                BcBigDig base)
 {
 #if BC_DEBUG
 #if BC_ENABLE_LIBRARY
@@ -3500,17 +3638,18 @@ bc_num_parse(BcNum* restrict n, const char* restrict val, BcBigDig base)
 
 	assert(n != NULL && val != NULL && base);
 	assert(base >= BC_NUM_MIN_BASE && base <= vm->maxes[BC_PROG_GLOBALS_IBASE]);
-	assert(bc_num_strValid(val));
+	assert(bc_num_strValidLen(val, len));
 
 	// A one character number is *always* parsed as though the base was the
-	// maximum allowed ibase, per the bc spec.
-	if (!val[1])
+	// maximum allowed ibase, per the bc spec. A lone radix point is zero, and
+	// the parsers below handle that.
+	if (len == 1 && val[0] != '.')
 	{
 		BcBigDig dig = bc_num_parseChar(val[0], BC_NUM_MAX_LBASE);
 		bc_num_bigdig2num(n, dig);
 	}
-	else if (base == BC_BASE) bc_num_parseDecimal(n, val);
-	else bc_num_parseBase(n, val, base);
+	else if (base == BC_BASE) bc_num_parseDecimal(n, val, len);
+	else bc_num_parseBase(n, val, len, base);
 
 	assert(BC_NUM_RDX_VALID(n));
 }
@@ -3555,6 +3694,737 @@ bc_num_print(BcNum* restrict n, BcBigDig base, bool newline)
 	if (newline) bc_num_putchar('\n', false);
 }
 
+#if BC_ENABLE_LIBRARY
+
+size_t
+bc_num_decimalLen(const BcNum* restrict n)
+{
+	size_t len;
+	BcVm* vm = bcl_getspecific();
+
+	if (BC_NUM_ZERO(n)) return 1;
+
+	// The sign, the leading zero, the integer digits, and the radix point and
+	// the fractional digits, exactly as bc_num_decimalStr() writes them.
+	len = BC_NUM_NEG(n) != 0;
+	len += (BC_Z && BC_NUM_RDX_VAL(n) == n->len);
+	len += bc_num_intDigits(n);
+	if (n->scale) len += n->scale + 1;
+
+	return len;
+}
+
+size_t
+bc_num_decimalStr(const BcNum* restrict n, char* restrict buf)
+{
+	size_t i, j, temp, rdx = BC_NUM_RDX_VAL(n), len = 0;
+	bool zero = true;
+	char digs[BC_BASE_DIGS];
+	BcVm* vm = bcl_getspecific();
+
+	if (BC_NUM_ZERO(n))
+	{
+		buf[0] = '0';
+		return 1;
+	}
+
+	if (BC_NUM_NEG(n)) buf[len++] = '-';
+	if (BC_Z && rdx == n->len) buf[len++] = '0';
+
+	// This is the same loop as bc_num_printDecimal(), but it writes straight
+	// into the buffer.
+	for (i = n->len - 1; i < n->len; --i)
+	{
+		BcDig n9 = n->num[i];
+		bool irdx = (i == rdx - 1);
+
+		if (irdx) buf[len++] = '.';
+
+		// Leading zeroes are only skipped in the integer part.
+		zero = (zero & !irdx);
+
+		// Calculate the number of digits to skip at the end of the last limb.
+		temp = n->scale % BC_BASE_DIGS;
+		temp = i || !temp ? 0 : BC_BASE_DIGS - temp;
+
+		for (j = 0; j < BC_BASE_DIGS; ++j)
+		{
+			digs[j] = (char) ('0' + n9 % BC_BASE);
+			n9 /= BC_BASE;
+		}
+
+		for (j = BC_BASE_DIGS - 1; j < BC_BASE_DIGS && j >= temp; --j)
+		{
+			zero = (zero && digs[j] == '0');
+			if (!zero) buf[len++] = digs[j];
+		}
+	}
+
+	return len;
+}
+
+/**
+ * Multiplies an integer by a value no bigger than a limb and adds a value
+ * smaller than a limb, in place. This is what builds numbers out of bytes and
+ * bits. The number must already have room for any new limbs.
+ * @param n    The number. It must be an integer.
+ * @param m    The value to multiply by.
+ * @param add  The value to add.
+ */
+static void
+bc_num_mulAddSmall(BcNum* restrict n, BcBigDig m, BcBigDig add)
+{
+	size_t i;
+	BcBigDig carry = add;
+
+	assert(!BC_NUM_RDX_VAL(n));
+	assert(m <= BC_BASE_POW && add < BC_BASE_POW);
+
+	for (i = 0; i < n->len; ++i)
+	{
+		BcBigDig in = ((BcBigDig) n->num[i]) * m + carry;
+		n->num[i] = (BcDig) (in % BC_BASE_POW);
+		carry = in / BC_BASE_POW;
+	}
+
+	// Push the carry, which can take more than one limb when the number starts
+	// out as zero.
+	while (carry)
+	{
+		assert(n->len < n->cap);
+		n->num[n->len] = (BcDig) (carry % BC_BASE_POW);
+		n->len += 1;
+		carry /= BC_BASE_POW;
+	}
+}
+
+/**
+ * Divides an integer by a value no bigger than a limb, in place, and returns
+ * the remainder.
+ * @param n  The number. It must be an integer.
+ * @param d  The value to divide by.
+ * @return   The remainder.
+ */
+static BcBigDig
+bc_num_divSmall(BcNum* restrict n, BcBigDig d)
+{
+	size_t i;
+	BcBigDig carry = 0;
+
+	assert(!BC_NUM_RDX_VAL(n));
+	assert(d && d <= BC_BASE_POW);
+
+	for (i = n->len - 1; i < n->len; --i)
+	{
+		BcBigDig in = ((BcBigDig) n->num[i]) + carry * BC_BASE_POW;
+		n->num[i] = (BcDig) (in / d);
+		carry = in % d;
+	}
+
+	bc_num_clean(n);
+
+	return carry;
+}
+
+/**
+ * Returns the number of limbs that are always enough to hold a number with
+ * @a bits bits. This is generous; a bit is less than a third of a decimal digit.
+ * @param bits  The number of bits.
+ * @return      The number of limbs.
+ */
+#define BC_NUM_BITS_LIMBS(bits) ((bits) / 3 / BC_BASE_DIGS + 2)
+
+/// The number of bytes that bc_num_fromBytes() and bc_num_toBytes() handle in
+/// one pass over the limbs. The value of that many bytes must fit in a limb.
+#if BC_LONG_BIT >= 64
+#define BC_NUM_BYTES_STEP (3)
+#else // BC_LONG_BIT >= 64
+#define BC_NUM_BYTES_STEP (1)
+#endif // BC_LONG_BIT >= 64
+
+void
+bc_num_fromBytes(BcNum* restrict n, const uchar* restrict bytes, size_t len,
+                 bool bigEndian, bool twosComp)
+{
+	size_t i, j, step;
+	bool neg;
+	uchar mask;
+
+	bc_num_zero(n);
+
+	if (!len) return;
+
+	// A negative two's complement number is the inverse of its magnitude minus
+	// one, so the bytes are inverted as they are read, and one is added back.
+	neg = twosComp && (bytes[bigEndian ? 0 : len - 1] & 0x80);
+	mask = neg ? UCHAR_MAX : 0;
+
+	bc_num_expand(n, BC_NUM_BITS_LIMBS(len * CHAR_BIT));
+
+	// Go from the most significant bytes to the least.
+	for (i = 0; i < len; i += step)
+	{
+		BcBigDig chunk = 0;
+
+		step = len - i < BC_NUM_BYTES_STEP ? len - i : BC_NUM_BYTES_STEP;
+
+		for (j = i; j < i + step; ++j)
+		{
+			uchar byte = bytes[bigEndian ? j : len - 1 - j] ^ mask;
+			chunk = (chunk << CHAR_BIT) | byte;
+		}
+
+		bc_num_mulAddSmall(n, ((BcBigDig) 1) << (step * CHAR_BIT), chunk);
+	}
+
+	if (neg)
+	{
+		bc_num_mulAddSmall(n, 1, 1);
+		n->rdx = BC_NUM_NEG_VAL(n, true);
+	}
+}
+
+bool
+bc_num_toBytes(const BcNum* restrict n, BcNum* restrict temp,
+               uchar* restrict bytes, size_t len, bool bigEndian, bool twosComp)
+{
+	size_t i, j, step, rdx = BC_NUM_RDX_VAL(n), int_len = bc_num_int(n);
+	uchar byte = 0, mask;
+	bool neg;
+
+	// Only the integer part is converted.
+	bc_num_zero(temp);
+	bc_num_expand(temp, int_len);
+	// NOLINTNEXTLINE
+	memcpy(temp->num, n->num + rdx, BC_NUM_SIZE(int_len));
+	temp->len = int_len;
+
+	neg = (BC_NUM_NEG(n) && BC_NUM_NONZERO(temp));
+
+	assert(twosComp || !neg);
+
+	// The reverse of bc_num_fromBytes(): subtract one from the magnitude, then
+	// invert the bytes as they are written.
+	if (neg)
+	{
+		for (i = 0; !temp->num[i]; ++i)
+		{
+			temp->num[i] = BC_BASE_POW - 1;
+		}
+
+		temp->num[i] -= 1;
+
+		bc_num_clean(temp);
+	}
+
+	mask = neg ? UCHAR_MAX : 0;
+
+	// Go from the least significant bytes to the most.
+	for (i = 0; i < len; i += step)
+	{
+		BcBigDig chunk;
+
+		step = len - i < BC_NUM_BYTES_STEP ? len - i : BC_NUM_BYTES_STEP;
+
+		chunk = BC_NUM_ZERO(temp) ?
+		            0 :
+		            bc_num_divSmall(temp, ((BcBigDig) 1) << (step * CHAR_BIT));
+
+		for (j = i; j < i + step; ++j)
+		{
+			byte = (uchar) (chunk & UCHAR_MAX);
+			chunk >>= CHAR_BIT;
+			bytes[bigEndian ? len - 1 - j : j] = byte ^ mask;
+		}
+	}
+
+	// It fits if nothing is left, and in two's complement, if the top bit is
+	// still free for the sign. With no bytes, there is no bit for the sign, so
+	// only non-negative numbers can fit.
+	return BC_NUM_ZERO(temp) && (!twosComp || !(byte & 0x80)) && (len || !neg);
+}
+
+bool
+bc_num_fromDouble(BcNum* restrict n, double val, size_t scale)
+{
+	int exp;
+	size_t i, places, bits;
+	double frac;
+	bool neg = (val < 0);
+
+	bc_num_zero(n);
+
+	// NaN and infinity have no value to convert.
+	if (BC_ERR(val != val || val - val != 0)) return false;
+
+	if (val == 0) return true;
+
+	// The value is frac * 2^exp, with frac in [0.5, 1).
+	frac = frexp(neg ? -val : val, &exp);
+
+	// Figure out the most bits the number could need, which is 64 for the
+	// fraction, plus the exponent if it is positive, and then 4 bits for every
+	// decimal digit in the scale.
+	bits = 64 + (exp > 0 ? (size_t) exp : 0) + 4 * scale;
+	bc_num_expand(n, BC_NUM_BITS_LIMBS(bits));
+
+	// Pull the bits of the fraction out a byte at a time, which is exact,
+	// until there are no more. This makes the fraction an integer.
+	while (frac != 0)
+	{
+		uchar byte;
+
+		frac *= UCHAR_MAX + 1;
+		byte = (uchar) frac;
+		frac -= byte;
+		exp -= CHAR_BIT;
+
+		bc_num_mulAddSmall(n, UCHAR_MAX + 1, byte);
+	}
+
+	if (exp >= 0)
+	{
+		// The value is an integer, so just multiply by 2^exp.
+		for (; exp >= CHAR_BIT; exp -= CHAR_BIT)
+		{
+			bc_num_mulAddSmall(n, UCHAR_MAX + 1, 0);
+		}
+
+		bc_num_mulAddSmall(n, ((BcBigDig) 1) << exp, 0);
+	}
+	else
+	{
+		// The value is n / 2^bits, which has exactly bits decimal places, so
+		// it is exact if the scale allows. Otherwise, multiply by 10^places
+		// first, and the division truncates to that many places.
+		bits = (size_t) -exp;
+
+		// Take out factors of two so the number does not get more places than
+		// it needs. This works because the limb base is even.
+		while (bits && !(n->num[0] & 1))
+		{
+			bc_num_divSmall(n, 2);
+			bits -= 1;
+		}
+
+		places = scale < bits ? scale : bits;
+
+		for (i = places; i >= BC_BASE_DIGS; i -= BC_BASE_DIGS)
+		{
+			bc_num_mulAddSmall(n, BC_BASE_POW, 0);
+		}
+
+		bc_num_mulAddSmall(n, bc_num_pow10[i], 0);
+
+		for (; bits >= CHAR_BIT; bits -= CHAR_BIT)
+		{
+			bc_num_divSmall(n, UCHAR_MAX + 1);
+		}
+
+		bc_num_divSmall(n, ((BcBigDig) 1) << bits);
+
+		bc_num_shiftRight(n, places);
+	}
+
+	if (BC_NUM_NONZERO(n)) n->rdx = BC_NUM_NEG_VAL(n, neg);
+
+	return true;
+}
+
+/// The most significant digits of a number that bc_num_toDouble() uses. No
+/// halfway point between two doubles has more than 767 significant digits, so
+/// with a sticky digit for anything that is cut off, this always rounds right.
+#define BC_NUM_DOUBLE_DIGS (800)
+
+/// The most digits that a double can hold exactly.
+#define BC_NUM_DOUBLE_EXACT_DIGS (15)
+
+/// The powers of ten that a double can hold exactly.
+static const double bc_num_double_pow10[] = {
+	1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+/// The number of exact powers of ten.
+#define BC_NUM_DOUBLE_POW10_LEN \
+	(sizeof(bc_num_double_pow10) / sizeof(bc_num_double_pow10[0]))
+
+bool
+bc_num_toDouble(const BcNum* restrict n, double* restrict result)
+{
+	char buf[BC_NUM_DOUBLE_DIGS + 32];
+	char* ptr = buf;
+	char* digits;
+	char digs[BC_BASE_DIGS];
+	char exp_buf[sizeof(size_t) * CHAR_BIT];
+	size_t i, j, ndigs = 0, rdx = BC_NUM_RDX_VAL(n), uexp;
+	ssize_t exp = 0;
+	bool sticky = false;
+	double val = 0;
+
+	if (BC_NUM_ZERO(n))
+	{
+		*result = 0;
+		return true;
+	}
+
+	if (BC_NUM_NEG(n)) *ptr++ = '-';
+
+	digits = ptr;
+
+	// Write the significant digits as an integer and remember the power of ten
+	// of the last one. Doing it that way means there is no radix point, so the
+	// locale does not matter.
+	for (i = n->len - 1; i < n->len && !sticky; --i)
+	{
+		BcBigDig n9 = (BcBigDig) n->num[i];
+
+		for (j = 0; j < BC_BASE_DIGS; ++j)
+		{
+			digs[j] = (char) (n9 % BC_BASE);
+			n9 /= BC_BASE;
+		}
+
+		for (j = BC_BASE_DIGS - 1; j < BC_BASE_DIGS; --j)
+		{
+			if (ndigs < BC_NUM_DOUBLE_DIGS)
+			{
+				// Skip leading zeroes.
+				if (!ndigs && !digs[j]) continue;
+
+				*ptr++ = (char) ('0' + digs[j]);
+				ndigs += 1;
+				exp = ((ssize_t) i - (ssize_t) rdx) * BC_BASE_DIGS + (ssize_t) j;
+			}
+			else sticky = (sticky || digs[j]);
+		}
+	}
+
+	// Trailing zeroes, which come from the scale, do not matter.
+	while (!sticky && ndigs > 1 && digits[ndigs - 1] == '0')
+	{
+		ndigs -= 1;
+		ptr -= 1;
+		exp += 1;
+	}
+
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+
+	// If the digits and the power of ten are both exact as doubles, one
+	// operation gives the correctly rounded result, and strtod() is not needed.
+	// This is only true if doubles are not kept in more precision.
+	if (ndigs <= BC_NUM_DOUBLE_EXACT_DIGS &&
+	    (size_t) (exp < 0 ? -exp : exp) < BC_NUM_DOUBLE_POW10_LEN)
+	{
+		for (i = 0; i < ndigs; ++i)
+		{
+			val = val * BC_BASE + (digits[i] - '0');
+		}
+
+		if (exp < 0) val /= bc_num_double_pow10[-exp];
+		else val *= bc_num_double_pow10[exp];
+
+		*result = BC_NUM_NEG(n) ? -val : val;
+
+		return true;
+	}
+
+#endif // defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+
+	// Anything cut off makes the value a little bigger than what was written.
+	if (sticky)
+	{
+		*ptr++ = '1';
+		exp -= 1;
+	}
+
+	*ptr++ = 'e';
+
+	if (exp < 0)
+	{
+		*ptr++ = '-';
+		uexp = (size_t) -exp;
+	}
+	else uexp = (size_t) exp;
+
+	// Write the exponent backwards, then reverse it in.
+	j = 0;
+
+	do
+	{
+		exp_buf[j++] = (char) ('0' + uexp % BC_BASE);
+		uexp /= BC_BASE;
+	}
+	while (uexp);
+
+	while (j)
+	{
+		*ptr++ = exp_buf[--j];
+	}
+
+	*ptr = '\0';
+
+	*result = strtod(buf, NULL);
+
+	return *result != HUGE_VAL && *result != -HUGE_VAL;
+}
+
+/// Whether the fixed-scale fast paths are compiled in. They need a native
+/// 128-bit integer and 64-bit limbs.
+#if BC_LONG_BIT >= 64 && defined(__SIZEOF_INT128__) && defined(__GNUC__)
+#define BC_NUM_FIXED (1)
+#else // BC_LONG_BIT >= 64 && defined(__SIZEOF_INT128__) && defined(__GNUC__)
+#define BC_NUM_FIXED (0)
+#endif // BC_LONG_BIT >= 64 && defined(__SIZEOF_INT128__) && defined(__GNUC__)
+
+#if BC_NUM_FIXED
+
+/// The most limbs an operand of the fixed-scale fast paths can have. A number
+/// with this many limbs is less than 10^36, so it always fits in 128 bits.
+#define BC_NUM_FIXED_LIMBS (4)
+
+/// The most limbs it takes to hold any 128-bit value.
+#define BC_NUM_FIXED_MAX_LIMBS (5)
+
+/// The largest power of 10 in bc_num_fixedPow10.
+#define BC_NUM_FIXED_POW_MAX (19)
+
+/// The value of two limbs' worth of digits, BC_BASE_POW squared.
+#define BC_NUM_FIXED_POW_LIMBS2 (1000000000000000000ULL)
+
+/// An unsigned 128-bit integer. The fixed-scale fast paths use it to hold the
+/// magnitude of a number with all of its limbs, including the ones after the
+/// decimal point, as one scaled integer.
+__extension__ typedef unsigned __int128 BcFixed;
+
+/// The powers of 10 that fit in 64 bits.
+static const uint64_t bc_num_fixedPow10[] = {
+	1ULL,
+	10ULL,
+	100ULL,
+	1000ULL,
+	10000ULL,
+	100000ULL,
+	1000000ULL,
+	10000000ULL,
+	100000000ULL,
+	1000000000ULL,
+	10000000000ULL,
+	100000000000ULL,
+	1000000000000ULL,
+	10000000000000ULL,
+	100000000000000ULL,
+	1000000000000000ULL,
+	10000000000000000ULL,
+	100000000000000000ULL,
+	1000000000000000000ULL,
+	10000000000000000000ULL,
+};
+
+/**
+ * Gets the magnitude of @a n as a scaled integer, if it is small enough.
+ * @param n  The number.
+ * @param m  The return parameter for the magnitude.
+ * @return   True if @a n was small enough, false otherwise.
+ */
+static bool
+bc_num_fixedGet(const BcNum* restrict n, BcFixed* restrict m)
+{
+	uint64_t low, high;
+
+	if (n->len > BC_NUM_FIXED_LIMBS) return false;
+
+	// Two limbs always fit in 64 bits, so only one 128-bit multiply is needed.
+	low = n->len > 1 ? (uint64_t) n->num[1] * BC_BASE_POW : 0;
+	low += n->len ? (uint64_t) n->num[0] : 0;
+	high = n->len > 3 ? (uint64_t) n->num[3] * BC_BASE_POW : 0;
+	high += n->len > 2 ? (uint64_t) n->num[2] : 0;
+
+	*m = (BcFixed) high * BC_NUM_FIXED_POW_LIMBS2 + low;
+
+	return true;
+}
+
+/**
+ * Multiplies @a m by 10 to the power of @a places.
+ * @param m       The scaled integer to shift.
+ * @param places  The number of decimal places to shift by.
+ * @return        True if the result fit, false on overflow.
+ */
+static bool
+bc_num_fixedShiftLeft(BcFixed* restrict m, size_t places)
+{
+	while (places)
+	{
+		size_t p = BC_MIN(places, BC_NUM_FIXED_POW_MAX);
+
+		if (__builtin_mul_overflow(*m, (BcFixed) bc_num_fixedPow10[p], m))
+		{
+			return false;
+		}
+
+		places -= p;
+	}
+
+	return true;
+}
+
+/**
+ * Divides @a m by 10 to the power of @a places, truncating.
+ * @param m       The scaled integer to shift.
+ * @param places  The number of decimal places to shift by.
+ */
+static void
+bc_num_fixedShiftRight(BcFixed* restrict m, size_t places)
+{
+	while (places && *m)
+	{
+		size_t p = BC_MIN(places, BC_NUM_FIXED_POW_MAX);
+
+		*m /= bc_num_fixedPow10[p];
+		places -= p;
+	}
+}
+
+/**
+ * Sets @a n to a scaled integer. The result is the same as what the regular
+ * operations leave after cleaning the number.
+ * @param n      The number to set.
+ * @param m      The magnitude, scaled so it has @a rdx limbs after the decimal
+ *               point.
+ * @param rdx    The number of limbs after the decimal point.
+ * @param scale  The scale of the result.
+ * @param neg    True if the result is negative.
+ */
+static void
+bc_num_fixedSet(BcNum* restrict n, BcFixed m, size_t rdx, size_t scale,
+                bool neg)
+{
+	size_t i;
+	uint64_t low;
+
+	if (!m)
+	{
+		bc_num_setToZero(n, scale);
+		return;
+	}
+
+	bc_num_expand(n, BC_MAX(rdx, BC_NUM_FIXED_MAX_LIMBS));
+
+	// Only the top limbs need 128-bit divisions, and each one gives two limbs.
+	for (i = 0; m > UINT64_MAX; i += 2)
+	{
+		BcFixed q = m / BC_NUM_FIXED_POW_LIMBS2;
+
+		low = (uint64_t) (m - q * BC_NUM_FIXED_POW_LIMBS2);
+		n->num[i] = (BcDig) (low % BC_BASE_POW);
+		n->num[i + 1] = (BcDig) (low / BC_BASE_POW);
+		m = q;
+	}
+
+	for (low = (uint64_t) m; low; ++i)
+	{
+		n->num[i] = (BcDig) (low % BC_BASE_POW);
+		low /= BC_BASE_POW;
+	}
+
+	// len must be at least as much as rdx.
+	for (; i < rdx; ++i)
+	{
+		n->num[i] = 0;
+	}
+
+	n->len = i;
+	n->scale = scale;
+	BC_NUM_RDX_SET_NEG(n, rdx, neg);
+
+	assert(BC_NUM_RDX_VALID(n));
+	assert(n->num[n->len - 1] || BC_NUM_RDX_VAL(n) == n->len);
+}
+
+#endif // BC_NUM_FIXED
+
+void
+bc_num_mulFixed(BcNum* a, BcNum* b, BcNum* c, size_t scale)
+{
+#if BC_NUM_FIXED
+	BcFixed ma, mb, mc;
+	size_t ascale, bscale, realscale, rdx;
+
+	if (BC_NUM_NONZERO(a) && BC_NUM_NONZERO(b) && bc_num_fixedGet(a, &ma) &&
+	    bc_num_fixedGet(b, &mb) && !__builtin_mul_overflow(ma, mb, &mc))
+	{
+		// This sets the final scale according to the bc spec, like
+		// bc_num_m() does.
+		ascale = a->scale;
+		bscale = b->scale;
+		realscale = BC_MIN(ascale + bscale,
+		                   BC_MAX(BC_MAX(scale, ascale), bscale));
+		rdx = BC_NUM_RDX(realscale);
+
+		// The product has all of the limbs after the decimal point of both
+		// operands. Truncate it to the scale, then pad it out to whole limbs.
+		bc_num_fixedShiftRight(&mc, (BC_NUM_RDX_VAL(a) + BC_NUM_RDX_VAL(b)) *
+		                                    BC_BASE_DIGS -
+		                                realscale);
+
+		if (bc_num_fixedShiftLeft(&mc, rdx * BC_BASE_DIGS - realscale))
+		{
+			bc_num_fixedSet(c, mc, rdx, realscale,
+			                BC_NUM_NEG(a) != BC_NUM_NEG(b));
+			return;
+		}
+	}
+#endif // BC_NUM_FIXED
+
+	bc_num_mul(a, b, c, scale);
+}
+
+void
+bc_num_divFixed(BcNum* a, BcNum* b, BcNum* c, size_t scale)
+{
+#if BC_NUM_FIXED
+	BcFixed ma, mb, mc;
+	size_t places, aplaces, rdx;
+	bool good;
+
+	// Dividing zero and dividing by zero are left to the regular code.
+	if (BC_NUM_NONZERO(a) && BC_NUM_NONZERO(b) && bc_num_fixedGet(a, &ma) &&
+	    bc_num_fixedGet(b, &mb))
+	{
+		// The quotient needs scale decimal places, so a has to be shifted by
+		// that much, plus the places in b, minus the places it already has.
+		places = BC_NUM_RDX_VAL(b) * BC_BASE_DIGS + scale;
+		aplaces = BC_NUM_RDX_VAL(a) * BC_BASE_DIGS;
+
+		if (places >= aplaces)
+		{
+			good = bc_num_fixedShiftLeft(&ma, places - aplaces);
+		}
+		else good = bc_num_fixedShiftLeft(&mb, aplaces - places);
+
+		rdx = BC_NUM_RDX(scale);
+
+		// The division truncates, just like bc_num_d() does.
+		if (good)
+		{
+			mc = ma / mb;
+			good = bc_num_fixedShiftLeft(&mc, rdx * BC_BASE_DIGS - scale);
+		}
+
+		if (good)
+		{
+			bc_num_fixedSet(c, mc, rdx, scale, BC_NUM_NEG(a) != BC_NUM_NEG(b));
+			return;
+		}
+	}
+#endif // BC_NUM_FIXED
+
+	bc_num_div(a, b, c, scale);
+}
+
+#endif // BC_ENABLE_LIBRARY
+
 BcBigDig
 bc_num_bigdig2(const BcNum* restrict n)
 {
@@ -107,7 +107,8 @@ bc_opt_error(BcErr err, int c, const char* str, bool use_short)
 		}
 		else bc_error(err, 0, str);
 	}
-	else bc_error(err, 0, (int) c, str);
+	// Options without a short option have no char to print.
+	else bc_error(err, 0, c > UCHAR_MAX ? '-' : c, str);
 }
 
 /**
@@ -116,7 +116,7 @@ bc_parse_addNum(BcParse* p, const char* string)
 	if (bc_map_insert(&prog->const_map, string, prog->consts.len, &idx))
 	{
 		BcConst* c;
-		BcId* id = bc_vec_item(&prog->const_map, idx);
+		BcId* id = bc_map_item(&prog->const_map, idx);
 
 		// Get the index.
 		idx = id->idx;
@@ -135,7 +135,7 @@ bc_parse_addNum(BcParse* p, const char* string)
 	}
 	else
 	{
-		BcId* id = bc_vec_item(&prog->const_map, idx);
+		BcId* id = bc_map_item(&prog->const_map, idx);
 		idx = id->idx;
 	}
 
@@ -180,6 +180,10 @@ bc_program_dereference(const BcProgram* p, BcVec* vec)
 	// We want to be sure we have a reference vector.
 	assert(vec->size == sizeof(uchar));
 
+	// Copy-on-write arrays are read exactly like references; they just have a
+	// marker in front.
+	if (BC_PROG_ARR_IS_COW(vec)) i = 1;
+
 	// Get the index of the vector in arrs, then the index of the original
 	// referenced vector.
 	vidx = bc_program_index(vec->v, &i);
@@ -227,7 +231,7 @@ bc_program_addString(BcProgram* p, const char* str)
 	if (bc_map_insert(&p->str_map, str, p->strs.len, &idx))
 	{
 		char** str_ptr;
-		BcId* id = bc_vec_item(&p->str_map, idx);
+		BcId* id = bc_map_item(&p->str_map, idx);
 
 		// Get the index.
 		idx = id->idx;
@@ -241,7 +245,7 @@ bc_program_addString(BcProgram* p, const char* str)
 	}
 	else
 	{
-		BcId* id = bc_vec_item(&p->str_map, idx);
+		BcId* id = bc_map_item(&p->str_map, idx);
 		idx = id->idx;
 	}
 
@@ -252,7 +256,7 @@ size_t
 bc_program_search(BcProgram* p, const char* name, bool var)
 {
 	BcVec* v;
-	BcVec* map;
+	BcMap* map;
 	size_t i;
 
 	BC_SIG_ASSERT_LOCKED;
@@ -271,7 +275,7 @@ bc_program_search(BcProgram* p, const char* name, bool var)
 		bc_array_init(temp, var);
 	}
 
-	return ((BcId*) bc_vec_item(map, i))->idx;
+	return bc_map_item(map, i)->idx;
 }
 
 /**
@@ -289,6 +293,247 @@ bc_program_vec(const BcProgram* p, size_t idx, BcType type)
 	return bc_vec_item(v, idx);
 }
 
+#if BC_ENABLED
+
+/**
+ * Finds a copy-on-write array in the list of them. It must exist.
+ * @param p          The program.
+ * @param loc        The index of the array in the arrs vector.
+ * @param stack_idx  The index of the copy-on-write array in the array's stack.
+ * @return           The index of the copy-on-write array in p->arr_cows.
+ */
+static size_t
+bc_program_arrCowFind(const BcProgram* p, size_t loc, size_t stack_idx)
+{
+	size_t i;
+
+	// Search from the top because the most recent calls are the most likely.
+	for (i = p->arr_cows.len; i-- > 0;)
+	{
+		BcLoc* l = bc_vec_item(&p->arr_cows, i);
+		if (l->loc == loc && l->stack_idx == stack_idx) return i;
+	}
+
+	BC_UNREACHABLE
+
+#if !BC_CLANG
+	return BC_VEC_INVALID_IDX;
+#endif // !BC_CLANG
+}
+
+/**
+ * Removes a copy-on-write array from the list of them.
+ * @param p  The program.
+ * @param i  The index of the copy-on-write array in p->arr_cows.
+ */
+static void
+bc_program_arrCowRemove(BcProgram* p, size_t i)
+{
+	BC_SIG_ASSERT_LOCKED;
+
+	if (i == p->arr_cows.len - 1) bc_vec_pop(&p->arr_cows);
+	else bc_vec_npopAt(&p->arr_cows, 1, i);
+}
+
+/**
+ * Gives a copy-on-write array its own deep copy of the array it shares and
+ * removes it from the list of copy-on-write arrays.
+ * @param p  The program.
+ * @param i  The index of the copy-on-write array in p->arr_cows.
+ */
+static void
+bc_program_arrCopy(BcProgram* p, size_t i)
+{
+	BcLoc* l;
+	BcVec* v;
+	BcVec temp;
+
+	BC_SIG_ASSERT_LOCKED;
+
+	l = bc_vec_item(&p->arr_cows, i);
+	v = bc_vec_item(bc_program_vec(p, l->loc, BC_TYPE_ARRAY), l->stack_idx);
+
+	assert(BC_PROG_ARR_IS_COW(v));
+
+	bc_array_init(&temp, true);
+	bc_array_copy(&temp, bc_program_dereference(p, v));
+
+	// Replace the reference with the copy. This does not touch the array
+	// stacks themselves, so no pointers are invalidated.
+	bc_vec_free(v);
+
+	// NOLINTNEXTLINE
+	memcpy(v, &temp, sizeof(BcVec));
+
+	bc_program_arrCowRemove(p, i);
+}
+
+/**
+ * Prepares an array to be written to and returns the real array. If the array
+ * is a copy-on-write array, it gets its own copy. Otherwise, references are
+ * followed, and any copy-on-write arrays that still share the real array get
+ * their own copies first.
+ * @param p          The program.
+ * @param loc        The index of the array in the arrs vector.
+ * @param stack_idx  The index of the array in its stack.
+ * @return           The real array, which is safe to write to.
+ */
+static BcVec*
+bc_program_arrWrite(BcProgram* p, size_t loc, size_t stack_idx)
+{
+	BcVec* v;
+	size_t i;
+
+	BC_SIG_ASSERT_LOCKED;
+
+	assert(BC_IS_BC);
+
+	v = bc_vec_item(bc_program_vec(p, loc, BC_TYPE_ARRAY), stack_idx);
+
+	// The fast path: nothing is shared.
+	if (!p->arr_cows.len)
+	{
+		return v->size == sizeof(uchar) ? bc_program_dereference(p, v) : v;
+	}
+
+	if (v->size == sizeof(uchar))
+	{
+		// If this is a copy-on-write array, it is the only thing that needs a
+		// copy.
+		if (BC_PROG_ARR_IS_COW(v))
+		{
+			bc_program_arrCopy(p, bc_program_arrCowFind(p, loc, stack_idx));
+			return v;
+		}
+
+		// Follow the reference to the real array.
+		i = 0;
+		loc = bc_program_index(v->v, &i);
+		stack_idx = bc_program_index(v->v, &i);
+		v = bc_vec_item(bc_program_vec(p, loc, BC_TYPE_ARRAY), stack_idx);
+	}
+
+	// Go backwards because bc_program_arrCopy() removes items.
+	for (i = p->arr_cows.len; i-- > 0;)
+	{
+		BcLoc* l = bc_vec_item(&p->arr_cows, i);
+		BcVec* cow;
+		size_t j = 1;
+
+		cow = bc_vec_item(bc_program_vec(p, l->loc, BC_TYPE_ARRAY),
+		                  l->stack_idx);
+
+		if (bc_program_index(cow->v, &j) == loc &&
+		    bc_program_index(cow->v, &j) == stack_idx)
+		{
+			bc_program_arrCopy(p, i);
+		}
+	}
+
+	return v;
+}
+
+/**
+ * Initializes a number for a function parameter or auto, reusing one from the
+ * pool if possible. The number is *not* set to zero if it is reused.
+ * @param p    The program.
+ * @param n    The number to initialize.
+ * @param req  The capacity the number needs. This is so the number never has
+ *             to be expanded while signals are locked.
+ */
+static void
+bc_program_reuseNum(BcProgram* p, BcNum* n, size_t req)
+{
+	BC_SIG_ASSERT_LOCKED;
+
+	if (!p->num_pool.len || ((BcNum*) bc_vec_top(&p->num_pool))->cap < req)
+	{
+		bc_num_init(n, req);
+	}
+	else
+	{
+		// NOLINTNEXTLINE
+		memcpy(n, bc_vec_top(&p->num_pool), sizeof(BcNum));
+		bc_vec_pop(&p->num_pool);
+	}
+}
+
+/**
+ * Puts the number of a function parameter or auto that is about to be popped
+ * into the pool, if it is worth keeping. If it is, it is cleared, so popping it
+ * does nothing.
+ * @param p  The program.
+ * @param n  The number.
+ */
+static void
+bc_program_recycleNum(BcProgram* p, BcNum* n)
+{
+	BC_SIG_ASSERT_LOCKED;
+
+	// Numbers with the default capacity are already cached by bc_num_free(),
+	// and bigger numbers are not kept to keep the memory held by the pool
+	// bounded.
+	if (n->cap <= BC_NUM_DEF_SIZE || n->cap > BC_PROG_POOL_NUM_CAP ||
+	    p->num_pool.len >= BC_PROG_POOL_MAX)
+	{
+		return;
+	}
+
+	bc_vec_push(&p->num_pool, n);
+	bc_num_clear(n);
+}
+
+/**
+ * Initializes an array for a function auto, reusing one from the pool if
+ * possible.
+ * @param p  The program.
+ * @param a  The array to initialize.
+ */
+static void
+bc_program_reuseArray(BcProgram* p, BcVec* a)
+{
+	BC_SIG_ASSERT_LOCKED;
+
+	if (!p->arr_pool.len) bc_array_init(a, true);
+	else
+	{
+		// NOLINTNEXTLINE
+		memcpy(a, bc_vec_top(&p->arr_pool), sizeof(BcVec));
+		bc_vec_pop(&p->arr_pool);
+
+		// Arrays in the pool are empty, but arrays always need one item.
+		assert(!a->len);
+		bc_array_expand(a, 1);
+	}
+}
+
+/**
+ * Puts the array of a function parameter or auto that is about to be popped
+ * into the pool, if it is worth keeping. If it is, it is emptied and cleared,
+ * so popping it does nothing.
+ * @param p  The program.
+ * @param a  The array.
+ */
+static void
+bc_program_recycleArray(BcProgram* p, BcVec* a)
+{
+	BC_SIG_ASSERT_LOCKED;
+
+	// References and copy-on-write arrays are not real arrays, and arrays that
+	// grew are not kept to keep the memory held by the pool bounded.
+	if (a->size != sizeof(BcNum) || a->cap > BC_VEC_START_CAP ||
+	    p->arr_pool.len >= BC_PROG_POOL_MAX)
+	{
+		return;
+	}
+
+	bc_vec_popAll(a);
+	bc_vec_push(&p->arr_pool, a);
+	bc_vec_clear(a);
+}
+
+#endif // BC_ENABLED
+
 /**
  * Returns a pointer to the BcNum corresponding to the result. There is one
  * case, however, where this returns a pointer to a BcVec: if the type of the
@@ -369,6 +614,16 @@ bc_program_num(BcProgram* p, BcResult* r)
 				if (v->len <= idx)
 				{
 					BC_SIG_LOCK;
+
+#if BC_ENABLED
+					// Expanding is a write, so the array must not be shared.
+					if (BC_IS_BC)
+					{
+						v = bc_program_arrWrite(p, r->d.loc.loc,
+						                        r->d.loc.stack_idx);
+					}
+#endif // BC_ENABLED
+
 					bc_array_expand(v, bc_vm_growSize(idx, 1));
 					BC_SIG_UNLOCK;
 				}
@@ -561,6 +816,26 @@ bc_program_assignPrep(BcProgram* p, BcResult** l, BcNum** ln, BcResult** r,
 	// This is the min non-allowable result type. dc allows strings.
 	min = BC_RESULT_TEMP - ((unsigned int) (BC_IS_BC));
 
+#if BC_ENABLED
+	// If we are assigning to an array element, make sure that the array is not
+	// shared before getting a pointer to the element.
+	if (BC_IS_BC && p->arr_cows.len)
+	{
+		BcResult* left;
+
+		assert(BC_PROG_STACK(&p->results, 2));
+
+		left = bc_vec_item_rev(&p->results, 1);
+
+		if (left->t == BC_RESULT_ARRAY_ELEM)
+		{
+			BC_SIG_LOCK;
+			bc_program_arrWrite(p, left->d.loc.loc, left->d.loc.stack_idx);
+			BC_SIG_UNLOCK;
+		}
+	}
+#endif // BC_ENABLED
+
 	// Prepare the operands.
 	bc_program_binPrep(p, l, ln, r, rn, 0);
 
@@ -1259,6 +1534,22 @@ bc_program_copyToVar(BcProgram* p, size_t idx, BcType t)
 			// NOLINTNEXTLINE
 			memcpy(&r.d.n, n, sizeof(BcNum));
 		}
+		// Temporaries do not need to be copied; they can be moved. We set the
+		// type of the result to BC_RESULT_ZERO to prevent it from being freed.
+		else if (ptr->t == BC_RESULT_TEMP || ptr->t >= BC_RESULT_IBASE)
+		{
+			// NOLINTNEXTLINE
+			memcpy(&r.d.n, n, sizeof(BcNum));
+			ptr->t = BC_RESULT_ZERO;
+		}
+#if BC_ENABLED
+		// In bc, this is a function argument, so it can reuse a number.
+		else if (BC_IS_BC)
+		{
+			bc_program_reuseNum(p, &r.d.n, n->len);
+			bc_num_copy(&r.d.n, n);
+		}
+#endif // BC_ENABLED
 		else bc_num_createCopy(&r.d.n, n);
 	}
 	else
@@ -1273,6 +1564,15 @@ bc_program_copyToVar(BcProgram* p, size_t idx, BcType t)
 		if (BC_IS_BC)
 		{
 			bool ref, ref_size;
+			BcLoc loc;
+
+			// A reference can be used to write to the array, so if we are
+			// making a reference to a copy-on-write array, it needs to get its
+			// own copy first.
+			if (t == BC_TYPE_REF && BC_PROG_ARR_IS_COW(v))
+			{
+				v = bc_program_arrWrite(p, ptr->d.loc.loc, ptr->d.loc.stack_idx);
+			}
 
 			// True if we are using a reference.
 			ref = (v->size == sizeof(BcNum) && t == BC_TYPE_REF);
@@ -1316,17 +1616,42 @@ bc_program_copyToVar(BcProgram* p, size_t idx, BcType t)
 				BC_SIG_UNLOCK;
 				return;
 			}
-			// If we get here, we have a reference, but we need an array, so
-			// dereference the array.
-			else if (ref_size && t != BC_TYPE_REF)
+
+			// If we get here, the array is passed by value. Instead of doing a
+			// deep copy now, push a copy-on-write array that reads from the
+			// real array. It only gets its own copy if it or the real array is
+			// written to while it exists.
+			bc_vec_init(rv, sizeof(uchar), BC_DTOR_NONE);
+			bc_vec_pushByte(rv, BC_PROG_ARR_COW);
+
+			// If we already have a reference or a copy-on-write array, copy
+			// its indices, which point to the real array.
+			if (ref_size)
+			{
+				size_t start = BC_PROG_ARR_IS_COW(v);
+				bc_vec_npush(rv, v->len - start, v->v + start);
+			}
+			else
 			{
-				v = bc_program_dereference(p, v);
+				bc_vec_pushIndex(rv, ptr->d.loc.loc);
+				bc_vec_pushIndex(rv, ptr->d.loc.stack_idx);
 			}
+
+			// Push the copy-on-write array and record where it is.
+			bc_vec_push(vec, &r.d);
+
+			loc.loc = idx;
+			loc.stack_idx = vec->len - 1;
+			bc_vec_push(&p->arr_cows, &loc);
+
+			bc_vec_pop(&p->results);
+
+			BC_SIG_UNLOCK;
+			return;
 		}
 #endif // BC_ENABLED
 
-		// If we get here, we need to copy the array because in bc, all
-		// arguments are passed by value. Yes, this is expensive.
+		// If we get here, we need to copy the array. bc never gets here.
 		bc_array_init(rv, true);
 		bc_array_copy(rv, v);
 	}
@@ -1761,1049 +2086,2466 @@ exit:
 }
 
 /**
- * Executes a function call for bc.
- * @param p     The program.
- * @param code  The bytecode vector to pull the number of arguments and the
- *              function index out of.
- * @param bgn   An in/out parameter; the start of the indices in the bytecode
- *              vector, and will be updated to point after the indices on
- *              return.
+ * Pops the item of a function parameter or auto off of its stack. The item does
+ * not need to be on top of the stack.
+ * @param p    The program.
+ * @param a    The parameter or auto.
+ * @param v    The stack of the parameter or auto.
+ * @param idx  The index of the item in the stack.
  */
 static void
-bc_program_call(BcProgram* p, const char* restrict code, size_t* restrict bgn)
+bc_program_dropAuto(BcProgram* p, const BcAuto* a, BcVec* v, size_t idx)
 {
-	BcInstPtr ip;
-	size_t i, nargs;
-	BcFunc* f;
-	BcVec* v;
-	BcAuto* a;
-	BcResult* arg;
+	BC_SIG_ASSERT_LOCKED;
 
-	// Pull the number of arguments out of the bytecode vector.
-	nargs = bc_program_index(code, bgn);
+	// Copy-on-write arrays need to be forgotten when they go away. Real
+	// numbers and arrays can be reused by later calls.
+	if (a->type == BC_TYPE_VAR) bc_program_recycleNum(p, bc_vec_item(v, idx));
+	else
+	{
+		BcVec* arr = bc_vec_item(v, idx);
 
-	// Set up instruction pointer.
-	ip.idx = 0;
-	ip.func = bc_program_index(code, bgn);
-	f = bc_vec_item(&p->fns, ip.func);
+		if (BC_PROG_ARR_IS_COW(arr))
+		{
+			bc_program_arrCowRemove(p, bc_program_arrCowFind(p, a->idx, idx));
+		}
+		else bc_program_recycleArray(p, arr);
+	}
 
-	// Error checking.
-	if (BC_ERR(!f->code.len)) bc_verr(BC_ERR_EXEC_UNDEF_FUNC, f->name);
-	if (BC_ERR(nargs != f->nparams))
+	if (idx == v->len - 1) bc_vec_pop(v);
+	else bc_vec_npopAt(v, 1, idx);
+}
+
+/**
+ * Returns true if a function has a parameter or auto that uses the same stack
+ * as another parameter or auto.
+ * @param f  The function.
+ * @param a  The parameter or auto to look for.
+ * @return   True if @a f has a parameter or auto on the same stack as @a a.
+ */
+static bool
+bc_program_hasAuto(const BcFunc* f, const BcAuto* a)
+{
+	size_t i;
+	bool var = (a->type == BC_TYPE_VAR);
+
+	for (i = 0; i < f->autos.len; ++i)
 	{
-		bc_verr(BC_ERR_EXEC_PARAMS, f->nparams, nargs);
+		BcAuto* a2 = bc_vec_item(&f->autos, i);
+		if (a2->idx == a->idx && (a2->type == BC_TYPE_VAR) == var) return true;
 	}
 
-	// Set the length of the results stack. We discount the argument, of course.
-	ip.len = p->results.len - nargs;
+	return false;
+}
 
-	assert(BC_PROG_STACK(&p->results, nargs));
+/**
+ * Turns a call that was just set up into a tail call by removing the frame of
+ * the caller, which is about to return whatever the callee returns. This can
+ * fail if the callee can see a parameter or auto of the caller, or if it has a
+ * reference to an array of the caller, in which case the call has to be a
+ * normal call.
+ * @param p       The program.
+ * @param caller  The function making the call.
+ * @param f       The function being called. Its parameters and autos must
+ *                already be pushed.
+ * @return        True if the frame of the caller was removed, false otherwise.
+ */
+static bool
+bc_program_tailCall(BcProgram* p, const BcFunc* caller, const BcFunc* f)
+{
+	size_t i, j;
 
-	// Prepare the globals' stacks.
-	if (BC_G) bc_program_prepGlobals(p);
+	BC_SIG_ASSERT_LOCKED;
 
-	// Push the arguments onto the stacks of their respective parameters.
-	for (i = 0; i < nargs; ++i)
+	// bc is dynamically scoped, so the callee, and anything that it calls, can
+	// read the caller's parameters and autos unless the callee has its own of
+	// the same name. Those must not go away before the callee returns.
+	for (i = 0; i < caller->autos.len; ++i)
 	{
-		arg = bc_vec_top(&p->results);
-		if (BC_ERR(arg->t == BC_RESULT_VOID)) bc_err(BC_ERR_EXEC_VOID_VAL);
-
-		// Get the corresponding parameter.
-		a = bc_vec_item(&f->autos, nargs - 1 - i);
-
-		// Actually push the value onto the parameter's stack.
-		bc_program_copyToVar(p, a->idx, a->type);
+		if (!bc_program_hasAuto(f, bc_vec_item(&caller->autos, i)))
+		{
+			return false;
+		}
 	}
 
-	BC_SIG_LOCK;
-
-	// Push zeroes onto the stacks of the auto variables.
-	for (; i < f->autos.len; ++i)
+	// Array parameters of the callee point to real arrays, and those arrays
+	// must not go away with the caller's frame. References make the call a
+	// normal call, but copy-on-write arrays can just get their copies now.
+	for (i = 0; i < f->nparams; ++i)
 	{
-		// Get the auto and its stack.
-		a = bc_vec_item(&f->autos, i);
+		BcAuto* a = bc_vec_item(&f->autos, i);
+		BcVec* v;
+		BcVec* arr;
+		size_t loc, stack_idx, k;
+		bool cow;
+
+		if (a->type == BC_TYPE_VAR) continue;
+
 		v = bc_program_vec(p, a->idx, a->type);
+		arr = bc_vec_top(v);
 
-		// If a variable, just push a 0; otherwise, push an array.
-		if (a->type == BC_TYPE_VAR)
-		{
-			BcNum* n = bc_vec_pushEmpty(v);
-			bc_num_init(n, BC_NUM_DEF_SIZE);
-		}
-		else
+		if (arr->size != sizeof(uchar)) continue;
+
+		cow = BC_PROG_ARR_IS_COW(arr);
+		k = cow;
+		loc = bc_program_index(arr->v, &k);
+		stack_idx = bc_program_index(arr->v, &k);
+
+		for (j = 0; j < caller->autos.len; ++j)
 		{
+			BcAuto* a2 = bc_vec_item(&caller->autos, j);
 			BcVec* v2;
 
-			assert(a->type == BC_TYPE_ARRAY);
+			if (a2->type == BC_TYPE_VAR || a2->idx != loc) continue;
 
-			v2 = bc_vec_pushEmpty(v);
-			bc_array_init(v2, true);
-		}
-	}
+			v2 = bc_program_vec(p, a2->idx, a2->type);
 
-	// Push the instruction pointer onto the execution stack.
-	bc_vec_push(&p->stack, &ip);
+			// The caller's item is under the callee's, as checked above.
+			if (stack_idx != v2->len - 2) continue;
 
-	BC_SIG_UNLOCK;
-}
+			if (!cow) return false;
 
-/**
- * Executes a return instruction.
- * @param p     The program.
- * @param inst  The return instruction. bc can return void, and we need to know
- *              if it is.
+			bc_program_arrCopy(p, bc_program_arrCowFind(p, a->idx, v->len - 1));
+
+			break;
+		}
+	}
+
+	// Now pop the caller's parameters and autos, which are all under the
+	// callee's.
+	for (i = 0; i < caller->autos.len; ++i)
+	{
+		BcAuto* a = bc_vec_item(&caller->autos, i);
+		BcVec* v = bc_program_vec(p, a->idx, a->type);
+		size_t idx = v->len - 2;
+
+		bc_program_dropAuto(p, a, v, idx);
+
+		// If the callee's item moved down and it is a copy-on-write array, its
+		// place in the list needs to be updated.
+		if (a->type != BC_TYPE_VAR && BC_PROG_ARR_IS_COW((BcVec*) bc_vec_top(v)))
+		{
+			BcLoc* l = bc_vec_item(&p->arr_cows,
+			                       bc_program_arrCowFind(p, a->idx, idx + 1));
+			l->stack_idx = idx;
+		}
+	}
+
+	// The callee gets the caller's globals since the caller's return would
+	// have restored them anyway.
+	if (BC_G) bc_program_popGlobals(p, false);
+
+	return true;
+}
+
+/**
+ * Unlinks a memo from the least-recently-used list of the memoization cache.
+ * @param p  The program.
+ * @param m  The memo to unlink.
  */
 static void
-bc_program_return(BcProgram* p, uchar inst)
+bc_program_memoUnlink(BcProgram* p, BcMemo* m)
 {
-	BcResult* res;
-	BcFunc* f;
-	BcInstPtr* ip;
-	size_t i, nresults;
+	BcMemo* other;
 
-	// Get the instruction pointer.
-	ip = bc_vec_top(&p->stack);
+	if (m->prev != BC_VEC_INVALID_IDX)
+	{
+		other = bc_vec_item(&p->memos, m->prev);
+		other->next = m->next;
+	}
+	else p->memo_head = m->next;
 
-	// Get the difference between the actual number of results and the number of
-	// results the caller expects.
-	nresults = p->results.len - ip->len;
+	if (m->next != BC_VEC_INVALID_IDX)
+	{
+		other = bc_vec_item(&p->memos, m->next);
+		other->prev = m->prev;
+	}
+	else p->memo_tail = m->prev;
+}
 
-	// If this isn't true, there was a missing call somewhere.
-	assert(BC_PROG_STACK(&p->stack, 2));
+/**
+ * Links a memo into the least-recently-used list of the memoization cache as
+ * the most recently used memo.
+ * @param p    The program.
+ * @param m    The memo to link.
+ * @param idx  The index of @a m in the memos vector.
+ */
+static void
+bc_program_memoLink(BcProgram* p, BcMemo* m, size_t idx)
+{
+	m->prev = BC_VEC_INVALID_IDX;
+	m->next = p->memo_head;
 
-	// If this isn't true, the parser screwed by giving us no value when we
-	// expected one, or giving us a value when we expected none.
-	assert(BC_PROG_STACK(&p->results, ip->len + (inst == BC_INST_RET)));
+	if (p->memo_head != BC_VEC_INVALID_IDX)
+	{
+		BcMemo* other = bc_vec_item(&p->memos, p->memo_head);
+		other->prev = idx;
+	}
+	else p->memo_tail = idx;
 
-	// Get the function we are returning from.
-	f = bc_vec_item(&p->fns, ip->func);
+	p->memo_head = idx;
+}
 
-	res = bc_program_prepResult(p);
+/**
+ * Finds the memo for the key at the end of the memo_keys vector and makes it the
+ * most recently used memo.
+ * @param p      The program.
+ * @param start  The start of the key in the memo_keys vector.
+ * @return       The memo, or NULL if there is none.
+ */
+static BcMemo*
+bc_program_memoFind(BcProgram* p, size_t start)
+{
+	const char* key = p->memo_keys.v + start;
+	size_t i, hash, len = p->memo_keys.len - start;
 
-	// If we are returning normally...
-	if (inst == BC_INST_RET)
-	{
-		BcNum* num;
-		BcResult* operand;
+	BC_SIG_ASSERT_LOCKED;
 
-		// Prepare and copy the return value.
-		bc_program_operand(p, &operand, &num, 1);
+	if (p->memo_slots == NULL) return NULL;
 
-		if (BC_PROG_STR(num))
+	hash = bc_vec_hash(key, len);
+
+	for (i = p->memo_slots[hash & (BC_PROG_MEMO_SLOTS - 1)];
+	     i != BC_VEC_INVALID_IDX;)
+	{
+		BcMemo* m = bc_vec_item(&p->memos, i);
+
+		if (m->hash == hash && m->key.len == len && !memcmp(m->key.v, key, len))
 		{
-			// We need to set this because otherwise, it will be a
-			// BC_RESULT_TEMP, and BC_RESULT_TEMP needs an actual number to make
-			// it easier to do type checking.
-			res->t = BC_RESULT_STR;
+			if (i != p->memo_head)
+			{
+				bc_program_memoUnlink(p, m);
+				bc_program_memoLink(p, m, i);
+			}
 
-			// NOLINTNEXTLINE
-			memcpy(&res->d.n, num, sizeof(BcNum));
+			return m;
 		}
-		else
-		{
-			BC_SIG_LOCK;
 
-			bc_num_createCopy(&res->d.n, num);
+		i = m->chain;
+	}
+
+	return NULL;
+}
+
+/**
+ * Adds the result of a call to the memoization cache, evicting the least
+ * recently used memo if the cache is full.
+ * @param p      The program.
+ * @param start  The start of the key of the call in the memo_keys vector. The
+ *               key must be at the end of the vector.
+ * @param n      The result of the call.
+ */
+static void
+bc_program_memoAdd(BcProgram* p, size_t start, const BcNum* n)
+{
+	BcMemo* m;
+	size_t i, idx, hash, len = p->memo_keys.len - start;
+	size_t* slot;
+
+	BC_SIG_ASSERT_LOCKED;
+
+	if (n->len > BC_PROG_MEMO_MAX_LEN) return;
+
+	if (p->memo_slots == NULL)
+	{
+		p->memo_slots = bc_vm_malloc(BC_PROG_MEMO_SLOTS * sizeof(size_t));
+
+		for (i = 0; i < BC_PROG_MEMO_SLOTS; ++i)
+		{
+			p->memo_slots[i] = BC_VEC_INVALID_IDX;
 		}
 	}
-	// Void is easy; set the result.
-	else if (inst == BC_INST_RET_VOID) res->t = BC_RESULT_VOID;
+	// A recursive call with the same key may have beaten this one.
+	else if (bc_program_memoFind(p, start) != NULL) return;
+
+	if (p->memos.len < BC_PROG_MEMO_MAX)
+	{
+		idx = p->memos.len;
+		m = bc_vec_pushEmpty(&p->memos);
+		bc_vec_init(&m->key, sizeof(uchar), BC_DTOR_NONE);
+	}
 	else
 	{
-		BC_SIG_LOCK;
+		// Evict the least recently used memo and reuse it.
+		idx = p->memo_tail;
+		m = bc_vec_item(&p->memos, idx);
 
-		// If we get here, the instruction is for returning a zero, so do that.
-		bc_num_init(&res->d.n, BC_NUM_DEF_SIZE);
-	}
+		bc_program_memoUnlink(p, m);
 
-	BC_SIG_MAYUNLOCK;
+		slot = p->memo_slots + (m->hash & (BC_PROG_MEMO_SLOTS - 1));
 
-	// We need to pop items off of the stacks of arguments and autos as well.
-	for (i = 0; i < f->autos.len; ++i)
-	{
-		BcAuto* a = bc_vec_item(&f->autos, i);
-		BcVec* v = bc_program_vec(p, a->idx, a->type);
+		while (*slot != idx)
+		{
+			BcMemo* other = bc_vec_item(&p->memos, *slot);
+			slot = &other->chain;
+		}
 
-		bc_vec_pop(v);
-	}
+		*slot = m->chain;
 
-	BC_SIG_LOCK;
+		bc_vec_popAll(&m->key);
+		bc_num_free(&m->res);
+	}
 
-	// When we retire, pop all of the unused results.
-	bc_program_retire(p, 1, nresults);
+	bc_vec_npush(&m->key, len, p->memo_keys.v + start);
+	bc_num_createCopy(&m->res, n);
 
-	// Pop the globals, if necessary.
-	if (BC_G) bc_program_popGlobals(p, false);
+	hash = bc_vec_hash(m->key.v, len);
+	slot = p->memo_slots + (hash & (BC_PROG_MEMO_SLOTS - 1));
 
-	// Pop the stack. This is what causes the function to actually "return."
-	bc_vec_pop(&p->stack);
+	m->hash = hash;
+	m->chain = *slot;
+	*slot = idx;
 
-	BC_SIG_UNLOCK;
+	bc_program_memoLink(p, m, idx);
 }
-#endif // BC_ENABLED
 
 /**
- * Executes a builtin function.
- * @param p     The program.
- * @param inst  The builtin to execute.
+ * Empties the memoization cache. This is done when a function is redefined,
+ * since any memoized function could call it.
+ * @param p  The program.
  */
 static void
-bc_program_builtin(BcProgram* p, uchar inst)
+bc_program_memoClear(BcProgram* p)
 {
-	BcResult* opd;
-	BcResult* res;
-	BcNum* num;
-	bool len = (inst == BC_INST_LENGTH);
+	size_t i;
 
-	// Ensure we have a valid builtin.
-#if BC_ENABLE_EXTRA_MATH
-	assert(inst >= BC_INST_LENGTH && inst <= BC_INST_IRAND);
-#else // BC_ENABLE_EXTRA_MATH
-	assert(inst >= BC_INST_LENGTH && inst <= BC_INST_IS_STRING);
-#endif // BC_ENABLE_EXTRA_MATH
+	BC_SIG_ASSERT_LOCKED;
 
-#ifndef BC_PROG_NO_STACK_CHECK
-	// Check stack for dc.
-	if (BC_IS_DC && BC_ERR(!BC_PROG_STACK(&p->results, 1)))
+	for (i = 0; i < p->memos.len; ++i)
 	{
-		bc_err(BC_ERR_EXEC_STACK);
+		BcMemo* m = bc_vec_item(&p->memos, i);
+
+		bc_vec_free(&m->key);
+		bc_num_free(&m->res);
 	}
-#endif // BC_PROG_NO_STACK_CHECK
 
-	assert(BC_PROG_STACK(&p->results, 1));
+	bc_vec_popAll(&p->memos);
 
-	res = bc_program_prepResult(p);
+	if (p->memo_slots != NULL)
+	{
+		for (i = 0; i < BC_PROG_MEMO_SLOTS; ++i)
+		{
+			p->memo_slots[i] = BC_VEC_INVALID_IDX;
+		}
+	}
 
-	bc_program_operand(p, &opd, &num, 1);
+	p->memo_head = p->memo_tail = BC_VEC_INVALID_IDX;
+}
 
-	assert(num != NULL);
+/**
+ * Pushes the key of a call onto the memo_keys vector. The key is the function,
+ * the globals, and the values of the arguments. Calls of void functions, calls
+ * with array or string arguments, and calls with arguments that are too big
+ * cannot be memoized.
+ * @param p      The program.
+ * @param f      The function being called.
+ * @param fidx   The index of @a f.
+ * @param nargs  The number of arguments, which are on the results stack.
+ * @return       True if the key was pushed, false if the call cannot be
+ *               memoized, in which case nothing was pushed.
+ */
+static bool
+bc_program_memoKey(BcProgram* p, const BcFunc* f, size_t fidx, size_t nargs)
+{
+	size_t i, len = 0, start = p->memo_keys.len;
 
-	// We need to ensure that strings and arrays aren't passed to most builtins.
-	// The scale function can take strings in dc.
-	if (!len && (inst != BC_INST_SCALE_FUNC || BC_IS_BC) &&
-	    inst != BC_INST_IS_NUMBER && inst != BC_INST_IS_STRING)
-	{
-		bc_program_type_num(opd, num);
-	}
+	if (f->voidfn) return false;
 
-	// Square root is easy.
-	if (inst == BC_INST_SQRT) bc_num_sqrt(num, &res->d.n, BC_PROG_SCALE(p));
+	bc_vec_npush(&p->memo_keys, sizeof(size_t), (char*) &fidx);
+	bc_vec_npush(&p->memo_keys, sizeof(p->globals), (char*) p->globals);
 
-	// Absolute value is easy.
-	else if (inst == BC_INST_ABS)
+	for (i = 0; i < nargs; ++i)
 	{
-		BC_SIG_LOCK;
+		BcAuto* a = bc_vec_item(&f->autos, i);
+		BcResult* r = bc_vec_item_rev(&p->results, nargs - 1 - i);
+		BcNum* n;
 
-		bc_num_createCopy(&res->d.n, num);
+		if (a->type != BC_TYPE_VAR || r->t == BC_RESULT_ARRAY ||
+		    r->t == BC_RESULT_STR || r->t == BC_RESULT_VOID)
+		{
+			break;
+		}
 
-		BC_SIG_UNLOCK;
+		n = bc_program_num(p, r);
 
-		BC_NUM_NEG_CLR_NP(res->d.n);
-	}
+		len += n->len;
 
-	// Testing for number or string is easy.
-	else if (inst == BC_INST_IS_NUMBER || inst == BC_INST_IS_STRING)
-	{
-		bool cond;
-		bool is_str;
+		if (BC_PROG_STR(n) || len > BC_PROG_MEMO_MAX_LEN) break;
 
-		BC_SIG_LOCK;
+		bc_vec_npush(&p->memo_keys, sizeof(size_t), (char*) &n->rdx);
+		bc_vec_npush(&p->memo_keys, sizeof(size_t), (char*) &n->scale);
+		bc_vec_npush(&p->memo_keys, sizeof(size_t), (char*) &n->len);
+		bc_vec_npush(&p->memo_keys, BC_NUM_SIZE(n->len), (char*) n->num);
+	}
 
-		bc_num_init(&res->d.n, BC_NUM_DEF_SIZE);
+	if (i == nargs) return true;
 
-		BC_SIG_UNLOCK;
+	bc_vec_npop(&p->memo_keys, p->memo_keys.len - start);
 
-		// Test if the number is a string.
-		is_str = BC_PROG_STR(num);
+	return false;
+}
 
-		// This confusing condition simply means that the instruction must be
-		// true if is_str is, or it must be false if is_str is. Otherwise, the
-		// returned value is false (0).
-		cond = ((inst == BC_INST_IS_STRING) == is_str);
-		if (cond) bc_num_one(&res->d.n);
-	}
+/**
+ * Executes a function call for bc.
+ * @param p     The program.
+ * @param code  The bytecode vector to pull the number of arguments and the
+ *              function index out of.
+ * @param bgn   An in/out parameter; the start of the indices in the bytecode
+ *              vector, and will be updated to point after the indices on
+ *              return.
+ */
+static void
+bc_program_call(BcProgram* p, const char* restrict code, size_t* restrict bgn)
+{
+	BcInstPtr ip;
+	BcInstPtr* caller;
+	size_t i, nargs;
+	BcFunc* f;
+	BcVec* v;
+	BcAuto* a;
+	BcResult* arg;
+	bool tail, memo;
+	size_t start;
 
-#if BC_ENABLE_EXTRA_MATH
+	// Pull the number of arguments out of the bytecode vector.
+	nargs = bc_program_index(code, bgn);
 
-	// irand() is easy.
-	else if (inst == BC_INST_IRAND)
+	// Set up instruction pointer.
+	ip.idx = 0;
+	ip.func = bc_program_index(code, bgn);
+	f = bc_vec_item(&p->fns, ip.func);
+
+#if BC_ENABLE_IMAGES
+	// Functions from images are loaded the first time they are called.
+	if (BC_UNLIKELY(f->img != NULL))
 	{
 		BC_SIG_LOCK;
+		bc_func_load(f);
+		BC_SIG_UNLOCK;
+	}
+#endif // BC_ENABLE_IMAGES
 
-		bc_num_init(&res->d.n, num->len - BC_NUM_RDX_VAL(num));
+	caller = bc_vec_top(&p->stack);
 
-		BC_SIG_UNLOCK;
+	// If the caller is a function that returns the result of this call right
+	// away, this can be a tail call. Calls to void functions are not because
+	// the caller's return needs to fail on a void value. The order matters;
+	// only functions are guaranteed to have an instruction after a call.
+	tail = (caller->func > BC_PROG_READ && code[*bgn] == BC_INST_RET &&
+	        !f->voidfn);
 
-		bc_num_irand(num, &res->d.n, &p->rng);
+	// Error checking.
+	if (BC_ERR(!f->code.len)) bc_verr(BC_ERR_EXEC_UNDEF_FUNC, f->name);
+	if (BC_ERR(nargs != f->nparams))
+	{
+		bc_verr(BC_ERR_EXEC_PARAMS, f->nparams, nargs);
 	}
 
-#endif // BC_ENABLE_EXTRA_MATH
+	// With the memoize option, look the call up first. If it is there, the
+	// function does not need to be executed at all.
+	start = p->memo_keys.len;
+	memo = (BC_M && bc_program_memoKey(p, f, ip.func, nargs));
 
-	// Everything else is...not easy.
-	else
+	if (memo)
 	{
-		BcBigDig val = 0;
+		BcMemo* m;
 
-		// Well, scale() is easy, but length() is not.
-		if (len)
+		BC_SIG_LOCK;
+
+		m = bc_program_memoFind(p, start);
+
+		if (m != NULL)
 		{
-			// If we are bc and we have an array...
-			if (opd->t == BC_RESULT_ARRAY)
-			{
-				// Yes, this is one place where we need to cast the number from
-				// bc_program_num() to a vector.
-				BcVec* v = (BcVec*) num;
+			BcResult* res;
 
-				// XXX: If this is changed, you should also change the similar
-				// code in bc_program_asciify().
+			bc_vec_npop(&p->memo_keys, p->memo_keys.len - start);
+			bc_vec_npop(&p->results, nargs);
 
-#if BC_ENABLED
-				// Dereference the array, if necessary.
+			res = bc_program_prepResult(p);
+			bc_num_createCopy(&res->d.n, &m->res);
+
+			BC_SIG_UNLOCK;
+
+			return;
+		}
+
+		BC_SIG_UNLOCK;
+	}
+
+	// Set the length of the results stack. We discount the argument, of course.
+	ip.len = p->results.len - nargs;
+
+	assert(BC_PROG_STACK(&p->results, nargs));
+
+	// Prepare the globals' stacks.
+	if (BC_G) bc_program_prepGlobals(p);
+
+	// Push the arguments onto the stacks of their respective parameters.
+	for (i = 0; i < nargs; ++i)
+	{
+		arg = bc_vec_top(&p->results);
+		if (BC_ERR(arg->t == BC_RESULT_VOID)) bc_err(BC_ERR_EXEC_VOID_VAL);
+
+		// Get the corresponding parameter.
+		a = bc_vec_item(&f->autos, nargs - 1 - i);
+
+		// Actually push the value onto the parameter's stack.
+		bc_program_copyToVar(p, a->idx, a->type);
+	}
+
+	BC_SIG_LOCK;
+
+	// Push zeroes onto the stacks of the auto variables.
+	for (; i < f->autos.len; ++i)
+	{
+		// Get the auto and its stack.
+		a = bc_vec_item(&f->autos, i);
+		v = bc_program_vec(p, a->idx, a->type);
+
+		// If a variable, just push a 0; otherwise, push an array. Both may be
+		// reused from earlier calls.
+		if (a->type == BC_TYPE_VAR)
+		{
+			BcNum* n = bc_vec_pushEmpty(v);
+			bc_program_reuseNum(p, n, BC_NUM_DEF_SIZE);
+			bc_num_zero(n);
+		}
+		else
+		{
+			BcVec* v2;
+
+			assert(a->type == BC_TYPE_ARRAY);
+
+			v2 = bc_vec_pushEmpty(v);
+			bc_program_reuseArray(p, v2);
+		}
+	}
+
+	// For a tail call, the callee takes the caller's place, including what the
+	// caller's caller expects of the results stack. Otherwise, push the
+	// instruction pointer onto the execution stack.
+	if (tail)
+	{
+		tail = bc_program_tailCall(p, bc_vec_item(&p->fns, caller->func), f);
+	}
+
+	if (tail)
+	{
+		ip.len = caller->len;
+		// NOLINTNEXTLINE
+		memcpy(caller, &ip, sizeof(BcInstPtr));
+	}
+	else bc_vec_push(&p->stack, &ip);
+
+	// If the call missed the memoization cache, its result needs to be added
+	// when it returns.
+	if (memo)
+	{
+		BcMemoCall c;
+
+		c.depth = p->stack.len;
+		c.start = start;
+
+		bc_vec_push(&p->memo_calls, &c);
+	}
+
+	BC_SIG_UNLOCK;
+}
+
+/**
+ * Executes a return instruction.
+ * @param p     The program.
+ * @param inst  The return instruction. bc can return void, and we need to know
+ *              if it is.
+ */
+static void
+bc_program_return(BcProgram* p, uchar inst)
+{
+	BcResult* res;
+	BcFunc* f;
+	BcInstPtr* ip;
+	size_t i, nresults;
+
+	// Get the instruction pointer.
+	ip = bc_vec_top(&p->stack);
+
+	// Get the difference between the actual number of results and the number of
+	// results the caller expects.
+	nresults = p->results.len - ip->len;
+
+	// If this isn't true, there was a missing call somewhere.
+	assert(BC_PROG_STACK(&p->stack, 2));
+
+	// If this isn't true, the parser screwed by giving us no value when we
+	// expected one, or giving us a value when we expected none.
+	assert(BC_PROG_STACK(&p->results, ip->len + (inst == BC_INST_RET)));
+
+	// Get the function we are returning from.
+	f = bc_vec_item(&p->fns, ip->func);
+
+	res = bc_program_prepResult(p);
+
+	// If we are returning normally...
+	if (inst == BC_INST_RET)
+	{
+		BcNum* num;
+		BcResult* operand;
+
+		// Prepare and copy the return value.
+		bc_program_operand(p, &operand, &num, 1);
+
+		if (BC_PROG_STR(num))
+		{
+			// We need to set this because otherwise, it will be a
+			// BC_RESULT_TEMP, and BC_RESULT_TEMP needs an actual number to make
+			// it easier to do type checking.
+			res->t = BC_RESULT_STR;
+
+			// NOLINTNEXTLINE
+			memcpy(&res->d.n, num, sizeof(BcNum));
+		}
+		else
+		{
+			BC_SIG_LOCK;
+
+			// Temporaries can be moved instead of copied. We set the type of
+			// the operand to BC_RESULT_ZERO to prevent it from being freed.
+			if (operand->t == BC_RESULT_TEMP)
+			{
+				// NOLINTNEXTLINE
+				memcpy(&res->d.n, num, sizeof(BcNum));
+				operand->t = BC_RESULT_ZERO;
+			}
+			else bc_num_createCopy(&res->d.n, num);
+		}
+	}
+	// Void is easy; set the result.
+	else if (inst == BC_INST_RET_VOID) res->t = BC_RESULT_VOID;
+	else
+	{
+		BC_SIG_LOCK;
+
+		// If we get here, the instruction is for returning a zero, so do that.
+		bc_num_init(&res->d.n, BC_NUM_DEF_SIZE);
+	}
+
+	BC_SIG_MAYUNLOCK;
+
+	BC_SIG_LOCK;
+
+	// Add the result to the memoization cache for the call that is returning,
+	// and for any calls that tail called it. Strings are not memoized.
+	while (p->memo_calls.len)
+	{
+		BcMemoCall* c = bc_vec_top(&p->memo_calls);
+
+		if (c->depth != p->stack.len) break;
+
+		if (res->t == BC_RESULT_TEMP) bc_program_memoAdd(p, c->start, &res->d.n);
+
+		bc_vec_npop(&p->memo_keys, p->memo_keys.len - c->start);
+		bc_vec_pop(&p->memo_calls);
+	}
+
+	// We need to pop items off of the stacks of arguments and autos as well.
+	for (i = 0; i < f->autos.len; ++i)
+	{
+		BcAuto* a = bc_vec_item(&f->autos, i);
+		BcVec* v = bc_program_vec(p, a->idx, a->type);
+
+		bc_program_dropAuto(p, a, v, v->len - 1);
+	}
+
+	// When we retire, pop all of the unused results.
+	bc_program_retire(p, 1, nresults);
+
+	// Pop the globals, if necessary.
+	if (BC_G) bc_program_popGlobals(p, false);
+
+	// Pop the stack. This is what causes the function to actually "return."
+	bc_vec_pop(&p->stack);
+
+	BC_SIG_UNLOCK;
+}
+#endif // BC_ENABLED
+
+/**
+ * Executes a builtin function.
+ * @param p     The program.
+ * @param inst  The builtin to execute.
+ */
+static void
+bc_program_builtin(BcProgram* p, uchar inst)
+{
+	BcResult* opd;
+	BcResult* res;
+	BcNum* num;
+	bool len = (inst == BC_INST_LENGTH);
+
+	// Ensure we have a valid builtin.
+#if BC_ENABLE_EXTRA_MATH
+	assert(inst >= BC_INST_LENGTH && inst <= BC_INST_IRAND);
+#else // BC_ENABLE_EXTRA_MATH
+	assert(inst >= BC_INST_LENGTH && inst <= BC_INST_IS_STRING);
+#endif // BC_ENABLE_EXTRA_MATH
+
+#ifndef BC_PROG_NO_STACK_CHECK
+	// Check stack for dc.
+	if (BC_IS_DC && BC_ERR(!BC_PROG_STACK(&p->results, 1)))
+	{
+		bc_err(BC_ERR_EXEC_STACK);
+	}
+#endif // BC_PROG_NO_STACK_CHECK
+
+	assert(BC_PROG_STACK(&p->results, 1));
+
+	res = bc_program_prepResult(p);
+
+	bc_program_operand(p, &opd, &num, 1);
+
+	assert(num != NULL);
+
+	// We need to ensure that strings and arrays aren't passed to most builtins.
+	// The scale function can take strings in dc.
+	if (!len && (inst != BC_INST_SCALE_FUNC || BC_IS_BC) &&
+	    inst != BC_INST_IS_NUMBER && inst != BC_INST_IS_STRING)
+	{
+		bc_program_type_num(opd, num);
+	}
+
+	// Square root is easy.
+	if (inst == BC_INST_SQRT) bc_num_sqrt(num, &res->d.n, BC_PROG_SCALE(p));
+
+	// Absolute value is easy.
+	else if (inst == BC_INST_ABS)
+	{
+		BC_SIG_LOCK;
+
+		bc_num_createCopy(&res->d.n, num);
+
+		BC_SIG_UNLOCK;
+
+		BC_NUM_NEG_CLR_NP(res->d.n);
+	}
+
+	// Testing for number or string is easy.
+	else if (inst == BC_INST_IS_NUMBER || inst == BC_INST_IS_STRING)
+	{
+		bool cond;
+		bool is_str;
+
+		BC_SIG_LOCK;
+
+		bc_num_init(&res->d.n, BC_NUM_DEF_SIZE);
+
+		BC_SIG_UNLOCK;
+
+		// Test if the number is a string.
+		is_str = BC_PROG_STR(num);
+
+		// This confusing condition simply means that the instruction must be
+		// true if is_str is, or it must be false if is_str is. Otherwise, the
+		// returned value is false (0).
+		cond = ((inst == BC_INST_IS_STRING) == is_str);
+		if (cond) bc_num_one(&res->d.n);
+	}
+
+#if BC_ENABLE_EXTRA_MATH
+
+	// irand() is easy.
+	else if (inst == BC_INST_IRAND)
+	{
+		BC_SIG_LOCK;
+
+		bc_num_init(&res->d.n, num->len - BC_NUM_RDX_VAL(num));
+
+		BC_SIG_UNLOCK;
+
+		bc_num_irand(num, &res->d.n, &p->rng);
+	}
+
+#endif // BC_ENABLE_EXTRA_MATH
+
+	// Everything else is...not easy.
+	else
+	{
+		BcBigDig val = 0;
+
+		// Well, scale() is easy, but length() is not.
+		if (len)
+		{
+			// If we are bc and we have an array...
+			if (opd->t == BC_RESULT_ARRAY)
+			{
+				// Yes, this is one place where we need to cast the number from
+				// bc_program_num() to a vector.
+				BcVec* v = (BcVec*) num;
+
+				// XXX: If this is changed, you should also change the similar
+				// code in bc_program_asciify().
+
+#if BC_ENABLED
+				// Dereference the array, if necessary.
 				if (BC_IS_BC && v->size == sizeof(uchar))
 				{
 					v = bc_program_dereference(p, v);
 				}
 #endif // BC_ENABLED
 
-				assert(v->size == sizeof(BcNum));
+				assert(v->size == sizeof(BcNum));
+
+				val = (BcBigDig) v->len;
+			}
+			else
+			{
+				// If the item is a string...
+				if (!BC_PROG_NUM(opd, num))
+				{
+					char* str;
+
+					// Get the string, then get the length.
+					str = bc_program_string(p, num);
+					val = (BcBigDig) strlen(str);
+				}
+				else
+				{
+					// Calculate the length of the number.
+					val = (BcBigDig) bc_num_len(num);
+				}
+			}
+		}
+		// Like I said; scale() is actually easy. It just also needs the integer
+		// conversion that length() does.
+		else if (BC_IS_BC || BC_PROG_NUM(opd, num))
+		{
+			val = (BcBigDig) bc_num_scale(num);
+		}
+
+		BC_SIG_LOCK;
+
+		// Create the result.
+		bc_num_createFromBigdig(&res->d.n, val);
+
+		BC_SIG_UNLOCK;
+	}
+
+	bc_program_retire(p, 1, 1);
+}
+
+/**
+ * Executes a divmod.
+ * @param p  The program.
+ */
+static void
+bc_program_divmod(BcProgram* p)
+{
+	BcResult* opd1;
+	BcResult* opd2;
+	BcResult* res;
+	BcResult* res2;
+	BcNum* n1;
+	BcNum* n2;
+	size_t req;
+
+	// We grow first to avoid pointer invalidation.
+	bc_vec_grow(&p->results, 2);
+
+	// We don't need to update the pointer because
+	// the capacity is enough due to the line above.
+	res2 = bc_program_prepResult(p);
+	res = bc_program_prepResult(p);
+
+	// Prepare the operands.
+	bc_program_binOpPrep(p, &opd1, &n1, &opd2, &n2, 2);
+
+	req = bc_num_mulReq(n1, n2, BC_PROG_SCALE(p));
+
+	BC_SIG_LOCK;
+
+	// Initialize the results.
+	bc_num_init(&res->d.n, req);
+	bc_num_init(&res2->d.n, req);
+
+	BC_SIG_UNLOCK;
+
+	// Execute.
+	bc_num_divmod(n1, n2, &res2->d.n, &res->d.n, BC_PROG_SCALE(p));
+
+	bc_program_retire(p, 2, 2);
+}
+
+/**
+ * Executes modular exponentiation.
+ * @param p  The program.
+ */
+static void
+bc_program_modexp(BcProgram* p)
+{
+	BcResult* r1;
+	BcResult* r2;
+	BcResult* r3;
+	BcResult* res;
+	BcNum* n1;
+	BcNum* n2;
+	BcNum* n3;
+
+#if DC_ENABLED
+
+	// Check the stack.
+	if (BC_IS_DC && BC_ERR(!BC_PROG_STACK(&p->results, 3)))
+	{
+		bc_err(BC_ERR_EXEC_STACK);
+	}
+
+#endif // DC_ENABLED
+
+	assert(BC_PROG_STACK(&p->results, 3));
+
+	res = bc_program_prepResult(p);
+
+	// Get the first operand and typecheck.
+	bc_program_operand(p, &r1, &n1, 3);
+	bc_program_type_num(r1, n1);
+
+	// Get the last two operands.
+	bc_program_binOpPrep(p, &r2, &n2, &r3, &n3, 1);
+
+	// Make sure that the values have their pointers updated, if necessary.
+	// Only array elements are possible because this is dc.
+	if (r1->t == BC_RESULT_ARRAY_ELEM && (r1->t == r2->t || r1->t == r3->t))
+	{
+		n1 = bc_program_num(p, r1);
+	}
+
+	BC_SIG_LOCK;
+
+	bc_num_init(&res->d.n, n3->len);
+
+	BC_SIG_UNLOCK;
+
+	bc_num_modexp(n1, n2, n3, &res->d.n);
+
+	bc_program_retire(p, 1, 3);
+}
+
+/**
+ * Asciifies a number for dc. This is a helper for bc_program_asciify().
+ * @param p  The program.
+ * @param n  The number to asciify.
+ */
+static uchar
+bc_program_asciifyNum(BcProgram* p, BcNum* n)
+{
+	bc_num_copy(&p->asciify, n);
+
+	// We want to clear the scale and sign for easy mod later.
+	bc_num_truncate(&p->asciify, p->asciify.scale);
+	BC_NUM_NEG_CLR(&p->asciify);
+
+	// This is guaranteed to not have a divide by 0
+	// because strmb is equal to 256.
+	bc_num_mod(&p->asciify, &p->strmb, &p->asciify, 0);
+
+	// This is also guaranteed to not error because num is in the range
+	// [0, UCHAR_MAX], which is definitely in range for a BcBigDig. And
+	// it is not negative.
+	return (uchar) bc_num_bigdig2(&p->asciify);
+}
+
+/**
+ * Executes the "asciify" command in bc and dc.
+ * @param p  The program.
+ */
+static void
+bc_program_asciify(BcProgram* p)
+{
+	BcResult *r, res;
+	BcNum* n;
+	uchar c;
+	size_t idx;
+#if BC_ENABLED
+	// This is in the outer scope because it has to be freed after a jump.
+	char* temp_str;
+#endif // BC_ENABLED
+
+	// Check the stack.
+	if (BC_ERR(!BC_PROG_STACK(&p->results, 1))) bc_err(BC_ERR_EXEC_STACK);
+
+	assert(BC_PROG_STACK(&p->results, 1));
+
+	// Get the top of the results stack.
+	bc_program_operand(p, &r, &n, 0);
+
+	assert(n != NULL);
+	assert(BC_IS_BC || r->t != BC_RESULT_ARRAY);
+
+#if BC_ENABLED
+	// Handle arrays in bc specially.
+	if (r->t == BC_RESULT_ARRAY)
+	{
+		// Yes, this is one place where we need to cast the number from
+		// bc_program_num() to a vector.
+		BcVec* v = (BcVec*) n;
+		size_t i;
+
+		// XXX: If this is changed, you should also change the similar code in
+		// bc_program_builtin().
+
+		// Dereference the array, if necessary.
+		if (v->size == sizeof(uchar))
+		{
+			v = bc_program_dereference(p, v);
+		}
+
+		assert(v->size == sizeof(BcNum));
+
+		// Allocate the string and set the jump for it.
+		BC_SIG_LOCK;
+		temp_str = bc_vm_malloc(v->len + 1);
+		BC_SETJMP_LOCKED(vm, exit);
+		BC_SIG_UNLOCK;
+
+		// Convert the array.
+		for (i = 0; i < v->len; ++i)
+		{
+			BcNum* num = (BcNum*) bc_vec_item(v, i);
+
+			if (BC_PROG_STR(num))
+			{
+				temp_str[i] = (bc_program_string(p, num))[0];
+			}
+			else
+			{
+				temp_str[i] = (char) bc_program_asciifyNum(p, num);
+			}
+		}
+
+		temp_str[v->len] = '\0';
+
+		// Store the string in the slab and map, and free the temp string.
+		BC_SIG_LOCK;
+		idx = bc_program_addString(p, temp_str);
+		free(temp_str);
+		BC_UNSETJMP(vm);
+		BC_SIG_UNLOCK;
+	}
+	else
+#endif // BC_ENABLED
+	{
+		char str[2];
+		char* str2;
+
+		// Asciify.
+		if (BC_PROG_NUM(r, n)) c = bc_program_asciifyNum(p, n);
+		else
+		{
+			// Get the string itself, then the first character.
+			str2 = bc_program_string(p, n);
+			c = (uchar) str2[0];
+		}
+
+		// Fill the resulting string.
+		str[0] = (char) c;
+		str[1] = '\0';
+
+		// Add the string to the data structures.
+		BC_SIG_LOCK;
+		idx = bc_program_addString(p, str);
+		BC_SIG_UNLOCK;
+	}
+
+	// Set the result
+	res.t = BC_RESULT_STR;
+	bc_num_clear(&res.d.n);
+	res.d.n.scale = idx;
+
+	// Pop and push.
+	bc_vec_pop(&p->results);
+	bc_vec_push(&p->results, &res);
+
+	return;
+
+#if BC_ENABLED
+exit:
+	free(temp_str);
+#endif // BC_ENABLED
+}
+
+/**
+ * Streams a number or a string to stdout.
+ * @param p  The program.
+ */
+static void
+bc_program_printStream(BcProgram* p)
+{
+	BcResult* r;
+	BcNum* n;
+
+	// Check the stack.
+	if (BC_ERR(!BC_PROG_STACK(&p->results, 1))) bc_err(BC_ERR_EXEC_STACK);
+
+	assert(BC_PROG_STACK(&p->results, 1));
+
+	// Get the top of the results stack.
+	bc_program_operand(p, &r, &n, 0);
+
+	assert(n != NULL);
+
+	// Stream appropriately.
+	if (BC_PROG_NUM(r, n)) bc_num_stream(n);
+	else bc_program_printChars(bc_program_string(p, n));
+
+	// Pop the operand.
+	bc_vec_pop(&p->results);
+}
+
+#if DC_ENABLED
+
+/**
+ * Gets the length of a register in dc and pushes it onto the results stack.
+ * @param p     The program.
+ * @param code  The bytecode vector to pull the register's index out of.
+ * @param bgn   An in/out parameter; the start of the index in the bytecode
+ *              vector, and will be updated to point after the index on return.
+ */
+static void
+bc_program_regStackLen(BcProgram* p, const char* restrict code,
+                       size_t* restrict bgn)
+{
+	size_t idx = bc_program_index(code, bgn);
+	BcVec* v = bc_program_vec(p, idx, BC_TYPE_VAR);
+
+	bc_program_pushBigdig(p, (BcBigDig) v->len, BC_RESULT_TEMP);
+}
+
+/**
+ * Pushes the length of the results stack onto the results stack.
+ * @param p  The program.
+ */
+static void
+bc_program_stackLen(BcProgram* p)
+{
+	bc_program_pushBigdig(p, (BcBigDig) p->results.len, BC_RESULT_TEMP);
+}
+
+/**
+ * Pops a certain number of elements off the execution stack.
+ * @param p     The program.
+ * @param inst  The instruction to tell us how many. There is one to pop up to
+ *              2, and one to pop the amount equal to the number at the top of
+ *              the results stack.
+ */
+static void
+bc_program_nquit(BcProgram* p, uchar inst)
+{
+	BcResult* opnd;
+	BcNum* num;
+	BcBigDig val;
+	size_t i;
+
+	// Ensure that the tail calls stack is correct.
+	assert(p->stack.len == p->tail_calls.len);
+
+	// Get the number of executions to pop.
+	if (inst == BC_INST_QUIT) val = 2;
+	else
+	{
+		bc_program_prep(p, &opnd, &num, 0);
+		val = bc_num_bigdig(num);
+
+		bc_vec_pop(&p->results);
+	}
+
+	// Loop over the tail call stack and adjust the quit value appropriately.
+	for (i = 0; val && i < p->tail_calls.len; ++i)
+	{
+		// Get the number of tail calls for this one.
+		size_t calls = *((size_t*) bc_vec_item_rev(&p->tail_calls, i)) + 1;
+
+		// Adjust the value.
+		if (calls >= val) val = 0;
+		else val -= (BcBigDig) calls;
+	}
+
+	// If we don't have enough executions, just quit.
+	if (i == p->stack.len)
+	{
+		vm->status = BC_STATUS_QUIT;
+		BC_JMP;
+	}
+	else
+	{
+		// We can always pop the last item we reached on the tail call stack
+		// because these are for tail calls. That means that any executions that
+		// we would not have quit in that position on the stack would have quit
+		// anyway.
+		BC_SIG_LOCK;
+		bc_vec_npop(&p->stack, i);
+		bc_vec_npop(&p->tail_calls, i);
+		BC_SIG_UNLOCK;
+	}
+}
+
+/**
+ * Pushes the depth of the execution stack onto the stack.
+ * @param p  The program.
+ */
+static void
+bc_program_execStackLen(BcProgram* p)
+{
+	size_t i, amt, len = p->tail_calls.len;
+
+	amt = len;
+
+	for (i = 0; i < len; ++i)
+	{
+		amt += *((size_t*) bc_vec_item(&p->tail_calls, i));
+	}
+
+	bc_program_pushBigdig(p, (BcBigDig) amt, BC_RESULT_TEMP);
+}
+
+/**
+ *
+ * @param p     The program.
+ * @param code  The bytecode vector to pull the register's index out of.
+ * @param bgn   An in/out parameter; the start of the index in the bytecode
+ *              vector, and will be updated to point after the index on return.
+ * @param cond  True if the execution is conditional, false otherwise.
+ * @param len   The number of bytes in the bytecode vector.
+ */
+static void
+bc_program_execStr(BcProgram* p, const char* restrict code,
+                   size_t* restrict bgn, bool cond, size_t len)
+{
+	BcResult* r;
+	char* str;
+	BcFunc* f;
+	BcInstPtr ip;
+	size_t fidx;
+	BcNum* n;
+
+	assert(p->stack.len == p->tail_calls.len);
 
-				val = (BcBigDig) v->len;
-			}
-			else
-			{
-				// If the item is a string...
-				if (!BC_PROG_NUM(opd, num))
-				{
-					char* str;
+	// Check the stack.
+	if (BC_ERR(!BC_PROG_STACK(&p->results, 1))) bc_err(BC_ERR_EXEC_STACK);
 
-					// Get the string, then get the length.
-					str = bc_program_string(p, num);
-					val = (BcBigDig) strlen(str);
-				}
-				else
-				{
-					// Calculate the length of the number.
-					val = (BcBigDig) bc_num_len(num);
-				}
-			}
+	assert(BC_PROG_STACK(&p->results, 1));
+
+	// Get the operand.
+	bc_program_operand(p, &r, &n, 0);
+
+	// If execution is conditional...
+	if (cond)
+	{
+		bool exec;
+		size_t then_idx;
+		// These are volatile to quiet warnings on GCC about clobbering with
+		// longjmp().
+		volatile size_t else_idx;
+		volatile size_t idx;
+
+		// Get the index of the "then" var and "else" var.
+		then_idx = bc_program_index(code, bgn);
+		else_idx = bc_program_index(code, bgn);
+
+		// Figure out if we should execute.
+		exec = (r->d.n.len != 0);
+
+		idx = exec ? then_idx : else_idx;
+
+		BC_SIG_LOCK;
+		BC_SETJMP_LOCKED(vm, exit);
+
+		// If we are supposed to execute, execute. If else_idx == SIZE_MAX, that
+		// means there was no else clause, so if execute is false and else does
+		// not exist, we don't execute. The goto skips all of the setup for the
+		// execution.
+		if (exec || (else_idx != SIZE_MAX))
+		{
+			n = bc_vec_top(bc_program_vec(p, idx, BC_TYPE_VAR));
 		}
-		// Like I said; scale() is actually easy. It just also needs the integer
-		// conversion that length() does.
-		else if (BC_IS_BC || BC_PROG_NUM(opd, num))
+		else goto exit;
+
+		if (BC_ERR(!BC_PROG_STR(n))) bc_err(BC_ERR_EXEC_TYPE);
+
+		BC_UNSETJMP(vm);
+		BC_SIG_UNLOCK;
+	}
+	else
+	{
+		// In non-conditional situations, only the top of stack can be executed,
+		// and in those cases, variables are not allowed to be "on the stack";
+		// they are only put on the stack to be assigned to.
+		assert(r->t != BC_RESULT_VAR);
+
+		if (r->t != BC_RESULT_STR) return;
+	}
+
+	assert(BC_PROG_STR(n));
+
+	// Get the string.
+	str = bc_program_string(p, n);
+
+	// Get the function index and function.
+	BC_SIG_LOCK;
+	fidx = bc_program_insertFunc(p, str);
+	BC_SIG_UNLOCK;
+	f = bc_vec_item(&p->fns, fidx);
+
+	// If the function has not been parsed yet...
+	if (!f->code.len)
+	{
+		BC_SIG_LOCK;
+
+		if (!BC_PARSE_IS_INITED(&vm->read_prs, p))
 		{
-			val = (BcBigDig) bc_num_scale(num);
+			bc_parse_init(&vm->read_prs, p, fidx);
+
+			// Initialize this too because bc_vm_shutdown() expects them to be
+			// initialized togther.
+			bc_vec_init(&vm->read_buf, sizeof(char), BC_DTOR_NONE);
 		}
+		// This needs to be updated because the parser could have been used
+		// somewhere else
+		else bc_parse_updateFunc(&vm->read_prs, fidx);
+
+		bc_lex_file(&vm->read_prs.l, vm->file);
+
+		BC_SETJMP_LOCKED(vm, err);
+
+		BC_SIG_UNLOCK;
+
+		// Parse. Only one expression is needed, so stdin isn't used.
+		bc_parse_text(&vm->read_prs, str, BC_MODE_FILE);
+
+		BC_SIG_LOCK;
+		vm->expr(&vm->read_prs, BC_PARSE_NOCALL);
+
+		BC_UNSETJMP(vm);
+
+		// We can just assert this here because
+		// dc should parse everything until EOF.
+		assert(vm->read_prs.l.t == BC_LEX_EOF);
+
+		BC_SIG_UNLOCK;
+	}
+
+	// Set the instruction pointer.
+	ip.idx = 0;
+	ip.len = p->results.len;
+	ip.func = fidx;
+
+	BC_SIG_LOCK;
+
+	// Pop the operand.
+	bc_vec_pop(&p->results);
+
+	// Tail call processing. This condition means that there is more on the
+	// execution stack, and we are at the end of the bytecode vector, and the
+	// last instruction is just a BC_INST_POP_EXEC, which would return.
+	if (p->stack.len > 1 && *bgn == len - 1 && code[*bgn] == BC_INST_POP_EXEC)
+	{
+		size_t* call_ptr = bc_vec_top(&p->tail_calls);
+
+		// Add one to the tail call.
+		*call_ptr += 1;
+
+		// Pop the execution stack before pushing the new instruction pointer
+		// on.
+		bc_vec_pop(&p->stack);
+	}
+	// If not a tail call, just push a new one.
+	else bc_vec_push(&p->tail_calls, &ip.idx);
+
+	// Push the new function onto the execution stack and return.
+	bc_vec_push(&p->stack, &ip);
+
+	BC_SIG_UNLOCK;
+
+	return;
+
+err:
+	BC_SIG_MAYLOCK;
+
+	f = bc_vec_item(&p->fns, fidx);
+
+	// Make sure to erase the bytecode vector so dc knows it is not parsed.
+	bc_vec_popAll(&f->code);
+
+exit:
+	bc_vec_pop(&p->results);
+	BC_LONGJMP_CONT(vm);
+}
+
+/**
+ * Prints every item on the results stack, one per line.
+ * @param p  The program.
+ */
+static void
+bc_program_printStack(BcProgram* p)
+{
+	size_t idx;
+
+	for (idx = 0; idx < p->results.len; ++idx)
+	{
+		bc_program_print(p, BC_INST_PRINT, idx);
+	}
+}
+#endif // DC_ENABLED
+
+/**
+ * Pushes the value of a global onto the results stack.
+ * @param p     The program.
+ * @param inst  Which global to push, as an instruction.
+ */
+static void
+bc_program_pushGlobal(BcProgram* p, uchar inst)
+{
+	BcResultType t;
+
+	// Make sure the instruction is valid.
+	assert(inst >= BC_INST_IBASE && inst <= BC_INST_SCALE);
+
+	// Push the global.
+	t = inst - BC_INST_IBASE + BC_RESULT_IBASE;
+	bc_program_pushBigdig(p, p->globals[inst - BC_INST_IBASE], t);
+}
+
+/**
+ * Pushes the value of a global setting onto the stack.
+ * @param p     The program.
+ * @param inst  Which global setting to push, as an instruction.
+ */
+static void
+bc_program_globalSetting(BcProgram* p, uchar inst)
+{
+	BcBigDig val;
+
+	// Make sure the instruction is valid.
+#if DC_ENABLED
+	assert((inst >= BC_INST_LINE_LENGTH && inst <= BC_INST_LEADING_ZERO) ||
+	       (BC_IS_DC && inst == BC_INST_EXTENDED_REGISTERS));
+#else // DC_ENABLED
+	assert(inst >= BC_INST_LINE_LENGTH && inst <= BC_INST_LEADING_ZERO);
+#endif // DC_ENABLED
+
+	if (inst == BC_INST_LINE_LENGTH)
+	{
+		val = (BcBigDig) vm->line_len;
+	}
+#if BC_ENABLED
+	else if (inst == BC_INST_GLOBAL_STACKS)
+	{
+		val = (BC_G != 0);
+	}
+#endif // BC_ENABLED
+#if DC_ENABLED
+	else if (inst == BC_INST_EXTENDED_REGISTERS)
+	{
+		val = (DC_X != 0);
+	}
+#endif // DC_ENABLED
+	else val = (BC_Z != 0);
+
+	// Push the global.
+	bc_program_pushBigdig(p, val, BC_RESULT_TEMP);
+}
+
+#if BC_ENABLE_EXTRA_MATH
+
+/**
+ * Pushes the value of seed on the stack.
+ * @param p  The program.
+ */
+static void
+bc_program_pushSeed(BcProgram* p)
+{
+	BcResult* res;
 
-		BC_SIG_LOCK;
+	res = bc_program_prepResult(p);
+	res->t = BC_RESULT_SEED;
 
-		// Create the result.
-		bc_num_createFromBigdig(&res->d.n, val);
+	BC_SIG_LOCK;
 
-		BC_SIG_UNLOCK;
-	}
+	// We need 2*BC_RAND_NUM_SIZE because of the size of the state.
+	bc_num_init(&res->d.n, 2 * BC_RAND_NUM_SIZE);
 
-	bc_program_retire(p, 1, 1);
+	BC_SIG_UNLOCK;
+
+	bc_num_createFromRNG(&res->d.n, &p->rng);
 }
 
+#endif // BC_ENABLE_EXTRA_MATH
+
 /**
- * Executes a divmod.
- * @param p  The program.
+ * Adds a function to the fns array. The function's ID must have already been
+ * inserted into the map.
+ * @param p       The program.
+ * @param id_ptr  The ID of the function as inserted into the map.
  */
 static void
-bc_program_divmod(BcProgram* p)
+bc_program_addFunc(BcProgram* p, BcId* id_ptr)
 {
-	BcResult* opd1;
-	BcResult* opd2;
-	BcResult* res;
-	BcResult* res2;
-	BcNum* n1;
-	BcNum* n2;
-	size_t req;
+	BcFunc* f;
 
-	// We grow first to avoid pointer invalidation.
-	bc_vec_grow(&p->results, 2);
+	BC_SIG_ASSERT_LOCKED;
 
-	// We don't need to update the pointer because
-	// the capacity is enough due to the line above.
-	res2 = bc_program_prepResult(p);
-	res = bc_program_prepResult(p);
+	// Push and init.
+	f = bc_vec_pushEmpty(&p->fns);
+	bc_func_init(f, id_ptr->name);
+}
 
-	// Prepare the operands.
-	bc_program_binOpPrep(p, &opd1, &n1, &opd2, &n2, 2);
+size_t
+bc_program_insertFunc(BcProgram* p, const char* name)
+{
+	BcId* id_ptr;
+	bool new;
+	size_t idx;
 
-	req = bc_num_mulReq(n1, n2, BC_PROG_SCALE(p));
+	BC_SIG_ASSERT_LOCKED;
 
-	BC_SIG_LOCK;
+	assert(p != NULL && name != NULL);
 
-	// Initialize the results.
-	bc_num_init(&res->d.n, req);
-	bc_num_init(&res2->d.n, req);
+	// Insert into the map and get the resulting ID.
+	new = bc_map_insert(&p->fn_map, name, p->fns.len, &idx);
+	id_ptr = bc_map_item(&p->fn_map, idx);
+	idx = id_ptr->idx;
 
-	BC_SIG_UNLOCK;
+	// If the function is new...
+	if (new)
+	{
+		// Add the function to the fns array.
+		bc_program_addFunc(p, id_ptr);
+	}
+#if BC_ENABLED
+	// bc has to reset the function because it's about to be redefined.
+	else if (BC_IS_BC)
+	{
+		BcFunc* func = bc_vec_item(&p->fns, idx);
+		bc_func_reset(func);
 
-	// Execute.
-	bc_num_divmod(n1, n2, &res2->d.n, &res->d.n, BC_PROG_SCALE(p));
+		// Memoized results may depend on the old definition.
+		bc_program_memoClear(p);
+	}
+#endif // BC_ENABLED
 
-	bc_program_retire(p, 2, 2);
+	return idx;
 }
 
+#if BC_ENABLE_IMAGES
+
 /**
- * Executes modular exponentiation.
- * @param p  The program.
+ * Loads a program image into the program, leaving it as if what made the image
+ * had been parsed. The names have to be new because the bytecode uses the
+ * indices that they had when the image was made.
+ * @param p    The program.
+ * @param img  The image to load.
+ * @return     True if the image was loaded, false if it has a name twice.
  */
-static void
-bc_program_modexp(BcProgram* p)
+static bool
+bc_program_imgLoad(BcProgram* p, const BcImage* img)
 {
-	BcResult* r1;
-	BcResult* r2;
-	BcResult* r3;
-	BcResult* res;
-	BcNum* n1;
-	BcNum* n2;
-	BcNum* n3;
+	size_t i, idx;
 
-#if DC_ENABLED
+	BC_SIG_ASSERT_LOCKED;
 
-	// Check the stack.
-	if (BC_IS_DC && BC_ERR(!BC_PROG_STACK(&p->results, 3)))
+	assert(p != NULL && img != NULL);
+
+	// Everything is inserted in the order the parser inserted it, so the
+	// indices match the ones in the bytecode. Names go first because the
+	// bytecode of a function can refer to later ones.
+	for (i = 0; i < img->vars_len; ++i)
 	{
-		bc_err(BC_ERR_EXEC_STACK);
+		idx = bc_program_search(p, img->vars[i], true);
+		if (idx != p->vars.len - 1) return false;
 	}
 
-#endif // DC_ENABLED
+	for (i = 0; i < img->arrs_len; ++i)
+	{
+		idx = bc_program_search(p, img->arrs[i], false);
+		if (idx != p->arrs.len - 1) return false;
+	}
 
-	assert(BC_PROG_STACK(&p->results, 3));
+	for (i = 0; i < img->strs_len; ++i)
+	{
+		idx = bc_program_addString(p, img->strs[i]);
+		if (idx != p->strs.len - 1) return false;
+	}
 
-	res = bc_program_prepResult(p);
+	for (i = 0; i < img->consts_len; ++i)
+	{
+		BcConst* c;
+		BcId* id;
 
-	// Get the first operand and typecheck.
-	bc_program_operand(p, &r1, &n1, 3);
-	bc_program_type_num(r1, n1);
+		// This is what bc_parse_addNum() does for a new constant.
+		if (!bc_map_insert(&p->const_map, img->consts[i], p->consts.len, &idx))
+		{
+			return false;
+		}
 
-	// Get the last two operands.
-	bc_program_binOpPrep(p, &r2, &n2, &r3, &n3, 1);
+		id = bc_map_item(&p->const_map, idx);
+		c = bc_vec_pushEmpty(&p->consts);
 
-	// Make sure that the values have their pointers updated, if necessary.
-	// Only array elements are possible because this is dc.
-	if (r1->t == BC_RESULT_ARRAY_ELEM && (r1->t == r2->t || r1->t == r3->t))
+		c->val = id->name;
+		c->base = BC_NUM_BIGDIG_MAX;
+		bc_num_clear(&c->num);
+	}
+
+	// The functions are only stubs until they are called, so a short run pays
+	// only for the functions it uses.
+	for (i = 0; i < img->fns_len; ++i)
 	{
-		n1 = bc_program_num(p, r1);
+		BcFunc* f;
+		BcId* id;
+
+		if (!bc_map_insert(&p->fn_map, img->fns[i].name, p->fns.len, &idx))
+		{
+			return false;
+		}
+
+		id = bc_map_item(&p->fn_map, idx);
+		f = bc_vec_pushEmpty(&p->fns);
+
+		bc_func_stub(f, id->name, img->fns + i);
 	}
 
-	BC_SIG_LOCK;
+	// The main function gets the library's top-level code.
+	bc_func_append(bc_vec_item(&p->fns, BC_PROG_MAIN), &img->main);
 
-	bc_num_init(&res->d.n, n3->len);
+	return true;
+}
 
-	BC_SIG_UNLOCK;
+void
+bc_program_loadImage(BcProgram* p, const BcImage* img)
+{
+	bool loaded = bc_program_imgLoad(p, img);
 
-	bc_num_modexp(n1, n2, n3, &res->d.n);
+	// The built-in libraries were made by the parser, so they have every name
+	// once.
+	assert(loaded);
 
-	bc_program_retire(p, 1, 3);
+	BC_UNUSED(loaded);
 }
 
 /**
- * Asciifies a number for dc. This is a helper for bc_program_asciify().
- * @param p  The program.
- * @param n  The number to asciify.
+ * Pads the contents of an image file to a multiple of the size of a size_t.
+ * @param buf  The contents of the image file.
  */
-static uchar
-bc_program_asciifyNum(BcProgram* p, BcNum* n)
+static void
+bc_program_imgPad(BcVec* buf)
 {
-	bc_num_copy(&p->asciify, n);
+	while (buf->len % sizeof(size_t))
+	{
+		bc_vec_pushByte(buf, 0);
+	}
+}
 
-	// We want to clear the scale and sign for easy mod later.
-	bc_num_truncate(&p->asciify, p->asciify.scale);
-	BC_NUM_NEG_CLR(&p->asciify);
+/**
+ * Appends data to the contents of an image file and pads it.
+ * @param buf   The contents of the image file.
+ * @param data  The data to append.
+ * @param len   The length of the data, in bytes.
+ * @return      The offset of the data.
+ */
+static size_t
+bc_program_imgPush(BcVec* buf, const void* data, size_t len)
+{
+	size_t off = buf->len;
 
-	// This is guaranteed to not have a divide by 0
-	// because strmb is equal to 256.
-	bc_num_mod(&p->asciify, &p->strmb, &p->asciify, 0);
+	if (len) bc_vec_npush(buf, len, data);
+	bc_program_imgPad(buf);
 
-	// This is also guaranteed to not error because num is in the range
-	// [0, UCHAR_MAX], which is definitely in range for a BcBigDig. And
-	// it is not negative.
-	return (uchar) bc_num_bigdig2(&p->asciify);
+	return off;
 }
 
 /**
- * Executes the "asciify" command in bc and dc.
- * @param p  The program.
+ * Appends a number, which may be a string, to the contents of an image file.
+ * @param buf  The contents of the image file.
+ * @param n    The number to append.
  */
 static void
-bc_program_asciify(BcProgram* p)
+bc_program_imgNum(BcVec* buf, const BcNum* n)
 {
-	BcResult *r, res;
-	BcNum* n;
-	uchar c;
-	size_t idx;
-#if BC_ENABLED
-	// This is in the outer scope because it has to be freed after a jump.
-	char* temp_str;
-#endif // BC_ENABLED
+	BcImageNum num;
 
-	// Check the stack.
-	if (BC_ERR(!BC_PROG_STACK(&p->results, 1))) bc_err(BC_ERR_EXEC_STACK);
+	num.rdx = n->rdx;
+	num.scale = n->scale;
+	num.len = BC_PROG_STR(n) ? BC_IMAGE_STR : n->len;
 
-	assert(BC_PROG_STACK(&p->results, 1));
+	bc_program_imgPush(buf, &num, sizeof(BcImageNum));
 
-	// Get the top of the results stack.
-	bc_program_operand(p, &r, &n, 0);
+	if (num.len != BC_IMAGE_STR)
+	{
+		bc_program_imgPush(buf, n->num, BC_NUM_SIZE(n->len));
+	}
+}
 
-	assert(n != NULL);
-	assert(BC_IS_BC || r->t != BC_RESULT_ARRAY);
+/**
+ * Appends the names in a map to the contents of an image file, in the order of
+ * their indices.
+ * @param buf  The contents of the image file.
+ * @param map  The map.
+ */
+static void
+bc_program_imgNames(BcVec* buf, const BcMap* map)
+{
+	size_t i;
 
-#if BC_ENABLED
-	// Handle arrays in bc specially.
-	if (r->t == BC_RESULT_ARRAY)
+	for (i = 0; i < bc_map_len(map); ++i)
 	{
-		// Yes, this is one place where we need to cast the number from
-		// bc_program_num() to a vector.
-		BcVec* v = (BcVec*) n;
-		size_t i;
+		const char* name = bc_map_item(map, i)->name;
+		bc_vec_npush(buf, strlen(name) + 1, name);
+	}
+}
 
-		// XXX: If this is changed, you should also change the similar code in
-		// bc_program_builtin().
+void
+bc_program_saveImage(BcProgram* p, BcVec* buf, size_t flags)
+{
+	BcImageHeader h;
+	BcImageVal val;
+	size_t i, j;
 
-		// Dereference the array, if necessary.
-		if (v->size == sizeof(uchar))
+	BC_SIG_ASSERT_LOCKED;
+
+	assert(p != NULL && buf != NULL);
+	assert(buf->size == sizeof(char) && !buf->len);
+	assert(strlen(BC_VERSION) < sizeof(h.bc_version));
+
+	// NOLINTNEXTLINE
+	memset(&h, 0, sizeof(BcImageHeader));
+
+	// NOLINTNEXTLINE
+	memcpy(h.magic, BC_IMAGE_MAGIC, sizeof(h.magic));
+	// NOLINTNEXTLINE
+	memcpy(h.bc_version, BC_VERSION, strlen(BC_VERSION));
+
+	h.version = BC_IMAGE_VERSION;
+	h.build = BC_IMAGE_BUILD;
+	h.flags = flags;
+
+	h.globals[BC_PROG_GLOBALS_IBASE] = (size_t) BC_PROG_IBASE(p);
+	h.globals[BC_PROG_GLOBALS_OBASE] = (size_t) BC_PROG_OBASE(p);
+	h.globals[BC_PROG_GLOBALS_SCALE] = (size_t) BC_PROG_SCALE(p);
+
+	// The main and read functions are not saved.
+	h.fns_len = p->fns.len - BC_PROG_READ - 1;
+
+	// The header and the records are filled in last, when the offsets are
+	// known.
+	bc_program_imgPush(buf, &h, sizeof(BcImageHeader));
+
+	h.fns = buf->len;
+
+	for (i = 0; i < h.fns_len; ++i)
+	{
+		BcImageRecord r;
+
+		// NOLINTNEXTLINE
+		memset(&r, 0, sizeof(BcImageRecord));
+
+		bc_program_imgPush(buf, &r, sizeof(BcImageRecord));
+	}
+
+	for (i = 0; i < h.fns_len; ++i)
+	{
+		BcFunc* f = bc_vec_item(&p->fns, i + BC_PROG_READ + 1);
+		BcImageFunc img;
+		BcImageRecord r;
+
+		// Functions that were never called are still stubs.
+		if (f->img != NULL) img = *f->img;
+		else
 		{
-			v = bc_program_dereference(p, v);
+			img.code = (const uchar*) f->code.v;
+			img.code_len = f->code.len;
+			img.labels = (const size_t*) f->labels.v;
+			img.labels_len = f->labels.len;
+			img.autos = (const BcAuto*) f->autos.v;
+			img.autos_len = f->autos.len;
+			img.nparams = f->nparams;
+			img.voidfn = f->voidfn;
 		}
 
-		assert(v->size == sizeof(BcNum));
+		r.name = bc_program_imgPush(buf, f->name, strlen(f->name) + 1);
+		r.code = bc_program_imgPush(buf, img.code, img.code_len);
+		r.code_len = img.code_len;
+		r.labels = bc_program_imgPush(buf, img.labels,
+		                              img.labels_len * sizeof(size_t));
+		r.labels_len = img.labels_len;
+		r.autos = buf->len;
+		r.autos_len = img.autos_len;
+		r.nparams = img.nparams;
+		r.voidfn = img.voidfn;
+
+		// The autos are copied one at a time so that their padding is zeroed.
+		for (j = 0; j < img.autos_len; ++j)
+		{
+			BcAuto a;
 
-		// Allocate the string and set the jump for it.
-		BC_SIG_LOCK;
-		temp_str = bc_vm_malloc(v->len + 1);
-		BC_SETJMP_LOCKED(vm, exit);
-		BC_SIG_UNLOCK;
+			// NOLINTNEXTLINE
+			memset(&a, 0, sizeof(BcAuto));
 
-		// Convert the array.
-		for (i = 0; i < v->len; ++i)
-		{
-			BcNum* num = (BcNum*) bc_vec_item(v, i);
+			a.idx = img.autos[j].idx;
+			a.type = img.autos[j].type;
 
-			if (BC_PROG_STR(num))
-			{
-				temp_str[i] = (bc_program_string(p, num))[0];
-			}
-			else
-			{
-				temp_str[i] = (char) bc_program_asciifyNum(p, num);
-			}
+			bc_vec_npush(buf, sizeof(BcAuto), &a);
 		}
 
-		temp_str[v->len] = '\0';
+		bc_program_imgPad(buf);
 
-		// Store the string in the slab and map, and free the temp string.
-		BC_SIG_LOCK;
-		idx = bc_program_addString(p, temp_str);
-		free(temp_str);
-		BC_UNSETJMP(vm);
-		BC_SIG_UNLOCK;
+		// NOLINTNEXTLINE
+		memcpy(buf->v + h.fns + i * sizeof(BcImageRecord), &r,
+		       sizeof(BcImageRecord));
 	}
-	else
-#endif // BC_ENABLED
+
+	// The names are in the order that bc_program_loadImage() inserts them.
+	h.names = buf->len;
+	h.vars_len = bc_map_len(&p->var_map);
+	h.arrs_len = bc_map_len(&p->arr_map);
+	h.strs_len = p->strs.len;
+	h.consts_len = p->consts.len;
+
+	bc_program_imgNames(buf, &p->var_map);
+	bc_program_imgNames(buf, &p->arr_map);
+
+	for (i = 0; i < h.strs_len; ++i)
+	{
+		const char* str = *((char**) bc_vec_item(&p->strs, i));
+		bc_vec_npush(buf, strlen(str) + 1, str);
+	}
+
+	for (i = 0; i < h.consts_len; ++i)
+	{
+		const BcConst* c = bc_vec_item(&p->consts, i);
+		bc_vec_npush(buf, strlen(c->val) + 1, c->val);
+	}
+
+	bc_program_imgPad(buf);
+
+	// Only the global values are saved, and only if they are not zero.
+	h.vals = buf->len;
+
+	val.type = BC_TYPE_VAR;
+	val.len = 1;
+
+	for (val.idx = 0; val.idx < p->vars.len; ++val.idx)
 	{
-		char str[2];
-		char* str2;
+		BcNum* n = bc_vec_item(bc_vec_item(&p->vars, val.idx), 0);
 
-		// Asciify.
-		if (BC_PROG_NUM(r, n)) c = bc_program_asciifyNum(p, n);
-		else
-		{
-			// Get the string itself, then the first character.
-			str2 = bc_program_string(p, n);
-			c = (uchar) str2[0];
-		}
+		if (!BC_PROG_STR(n) && BC_NUM_ZERO(n) && !n->scale) continue;
 
-		// Fill the resulting string.
-		str[0] = (char) c;
-		str[1] = '\0';
+		bc_program_imgPush(buf, &val, sizeof(BcImageVal));
+		bc_program_imgNum(buf, n);
 
-		// Add the string to the data structures.
-		BC_SIG_LOCK;
-		idx = bc_program_addString(p, str);
-		BC_SIG_UNLOCK;
+		h.vals_len += 1;
 	}
 
-	// Set the result
-	res.t = BC_RESULT_STR;
-	bc_num_clear(&res.d.n);
-	res.d.n.scale = idx;
+	val.type = BC_TYPE_ARRAY;
 
-	// Pop and push.
-	bc_vec_pop(&p->results);
-	bc_vec_push(&p->results, &res);
+	for (val.idx = 0; val.idx < p->arrs.len; ++val.idx)
+	{
+		BcVec* a = bc_vec_item(bc_vec_item(&p->arrs, val.idx), 0);
+		BcNum* n;
 
-	return;
+		// Only arrays of functions can be copy-on-write.
+		assert(!BC_PROG_ARR_IS_COW(a));
 
-#if BC_ENABLED
-exit:
-	free(temp_str);
-#endif // BC_ENABLED
-}
+		n = bc_vec_item(a, 0);
 
-/**
- * Streams a number or a string to stdout.
- * @param p  The program.
- */
-static void
-bc_program_printStream(BcProgram* p)
-{
-	BcResult* r;
-	BcNum* n;
+		if (a->len == 1 && !BC_PROG_STR(n) && BC_NUM_ZERO(n) && !n->scale)
+		{
+			continue;
+		}
 
-	// Check the stack.
-	if (BC_ERR(!BC_PROG_STACK(&p->results, 1))) bc_err(BC_ERR_EXEC_STACK);
+		val.len = a->len;
 
-	assert(BC_PROG_STACK(&p->results, 1));
+		bc_program_imgPush(buf, &val, sizeof(BcImageVal));
 
-	// Get the top of the results stack.
-	bc_program_operand(p, &r, &n, 0);
+		for (i = 0; i < a->len; ++i)
+		{
+			bc_program_imgNum(buf, bc_vec_item(a, i));
+		}
 
-	assert(n != NULL);
+		h.vals_len += 1;
+	}
 
-	// Stream appropriately.
-	if (BC_PROG_NUM(r, n)) bc_num_stream(n);
-	else bc_program_printChars(bc_program_string(p, n));
+	h.len = buf->len;
 
-	// Pop the operand.
-	bc_vec_pop(&p->results);
+	// NOLINTNEXTLINE
+	memcpy(buf->v, &h, sizeof(BcImageHeader));
 }
 
-#if DC_ENABLED
-
 /**
- * Gets the length of a register in dc and pushes it onto the results stack.
- * @param p     The program.
- * @param code  The bytecode vector to pull the register's index out of.
- * @param bgn   An in/out parameter; the start of the index in the bytecode
- *              vector, and will be updated to point after the index on return.
+ * Returns true if @a n items of @a size bytes at offset @a off are all inside
+ * an image file of length @a len and aligned to a size_t, false otherwise.
+ * @param len   The length of the image file.
+ * @param off   The offset of the items.
+ * @param n     The number of items.
+ * @param size  The size of each item.
+ * @return      True if the items are in the image file and aligned.
  */
-static void
-bc_program_regStackLen(BcProgram* p, const char* restrict code,
-                       size_t* restrict bgn)
+static bool
+bc_program_imgValid(size_t len, size_t off, size_t n, size_t size)
 {
-	size_t idx = bc_program_index(code, bgn);
-	BcVec* v = bc_program_vec(p, idx, BC_TYPE_VAR);
-
-	bc_program_pushBigdig(p, (BcBigDig) v->len, BC_RESULT_TEMP);
+	return off <= len && !(off % sizeof(size_t)) && n <= (len - off) / size;
 }
 
 /**
- * Pushes the length of the results stack onto the results stack.
- * @param p  The program.
+ * Returns the nul-terminated string at @a *off in an image file and moves
+ * @a *off past it.
+ * @param img  The image file.
+ * @param off  An in/out parameter for the offset of the string.
+ * @return     The string, or NULL if it does not end before the image does.
  */
-static void
-bc_program_stackLen(BcProgram* p)
+static const char*
+bc_program_imgStr(const char* img, size_t* off)
 {
-	bc_program_pushBigdig(p, (BcBigDig) p->results.len, BC_RESULT_TEMP);
+	size_t len = ((const BcImageHeader*) img)->len;
+	const char* str;
+	const char* end;
+
+	if (*off >= len) return NULL;
+
+	str = img + *off;
+	end = memchr(str, '\0', len - *off);
+	if (end == NULL) return NULL;
+
+	*off += (size_t) (end - str) + 1;
+
+	return str;
 }
 
 /**
- * Pops a certain number of elements off the execution stack.
- * @param p     The program.
- * @param inst  The instruction to tell us how many. There is one to pop up to
- *              2, and one to pop the amount equal to the number at the top of
- *              the results stack.
+ * Reads a number from an image file into a number in the program.
+ * @param p    The program.
+ * @param img  The image file.
+ * @param off  An in/out parameter for the offset of the number.
+ * @param n    The number to read into. It must be a valid number.
+ * @return     True if the number was valid, false otherwise.
  */
-static void
-bc_program_nquit(BcProgram* p, uchar inst)
+static bool
+bc_program_imgReadNum(BcProgram* p, const char* img, size_t* off, BcNum* n)
 {
-	BcResult* opnd;
-	BcNum* num;
-	BcBigDig val;
-	size_t i;
+	size_t i, len = ((const BcImageHeader*) img)->len;
+	const BcImageNum* num;
+	BcNum temp;
 
-	// Ensure that the tail calls stack is correct.
-	assert(p->stack.len == p->tail_calls.len);
+	if (!bc_program_imgValid(len, *off, 1, sizeof(BcImageNum))) return false;
 
-	// Get the number of executions to pop.
-	if (inst == BC_INST_QUIT) val = 2;
-	else
+	num = (const BcImageNum*) (img + *off);
+	*off += sizeof(BcImageNum);
+
+	if (num->len == BC_IMAGE_STR)
 	{
-		bc_program_prep(p, &opnd, &num, 0);
-		val = bc_num_bigdig(num);
+		if (num->scale >= p->strs.len) return false;
 
-		bc_vec_pop(&p->results);
+		bc_num_free(n);
+		bc_num_clear(n);
+
+		n->rdx = 0;
+		n->scale = num->scale;
+		n->len = 0;
+
+		return true;
 	}
 
-	// Loop over the tail call stack and adjust the quit value appropriately.
-	for (i = 0; val && i < p->tail_calls.len; ++i)
+	// The number has to be what bc_num_clean() would leave: a zero is not
+	// negative, and the digits are enough for the scale.
+	if (!bc_program_imgValid(len, *off, num->len, sizeof(BcDig)) ||
+	    (num->rdx >> 1) > num->len || (!num->len && num->rdx) ||
+	    (num->len && (num->rdx >> 1) * BC_BASE_DIGS < num->scale))
 	{
-		// Get the number of tail calls for this one.
-		size_t calls = *((size_t*) bc_vec_item_rev(&p->tail_calls, i)) + 1;
-
-		// Adjust the value.
-		if (calls >= val) val = 0;
-		else val -= (BcBigDig) calls;
+		return false;
 	}
 
-	// If we don't have enough executions, just quit.
-	if (i == p->stack.len)
+	// The number is only read from, so it can point into the image.
+	temp.num = (BcDig*) (img + *off);
+	temp.rdx = num->rdx;
+	temp.scale = num->scale;
+	temp.len = num->len;
+	temp.cap = num->len;
+
+	*off += BC_NUM_SIZE(num->len);
+	*off += (sizeof(size_t) - *off % sizeof(size_t)) % sizeof(size_t);
+
+	for (i = 0; i < temp.len; ++i)
 	{
-		vm->status = BC_STATUS_QUIT;
-		BC_JMP;
+		if (temp.num[i] < 0 || temp.num[i] >= BC_BASE_POW) return false;
 	}
-	else
+
+	// The integer part has no leading zeroes.
+	if (temp.len > BC_NUM_RDX_VAL_NP(temp) && !temp.num[temp.len - 1])
 	{
-		// We can always pop the last item we reached on the tail call stack
-		// because these are for tail calls. That means that any executions that
-		// we would not have quit in that position on the stack would have quit
-		// anyway.
-		BC_SIG_LOCK;
-		bc_vec_npop(&p->stack, i);
-		bc_vec_npop(&p->tail_calls, i);
-		BC_SIG_UNLOCK;
+		return false;
 	}
+
+	// The signal lock is held, so the number cannot be expanded in place.
+	bc_num_free(n);
+	bc_num_createCopy(n, &temp);
+
+	return true;
 }
 
 /**
- * Pushes the depth of the execution stack onto the stack.
- * @param p  The program.
+ * Reads an index from the bytecode of a function in an image file, making sure
+ * that it fits in a size_t and ends before the bytecode does.
+ * @param f    The function.
+ * @param i    An in/out parameter for the offset of the index in the bytecode.
+ * @param idx  An out parameter for the index.
+ * @return     True if the index was valid, false otherwise.
  */
-static void
-bc_program_execStackLen(BcProgram* p)
+static bool
+bc_program_imgIndex(const BcImageFunc* f, size_t* i, size_t* idx)
 {
-	size_t i, amt, len = p->tail_calls.len;
+	uchar amt;
 
-	amt = len;
+	if (*i >= f->code_len) return false;
 
-	for (i = 0; i < len; ++i)
-	{
-		amt += *((size_t*) bc_vec_item(&p->tail_calls, i));
-	}
+	amt = f->code[*i];
 
-	bc_program_pushBigdig(p, (BcBigDig) amt, BC_RESULT_TEMP);
+	if (amt > sizeof(size_t) || amt >= f->code_len - *i) return false;
+
+	*idx = bc_program_index((const char*) f->code, i);
+
+	return true;
 }
 
 /**
- *
- * @param p     The program.
- * @param code  The bytecode vector to pull the register's index out of.
- * @param bgn   An in/out parameter; the start of the index in the bytecode
- *              vector, and will be updated to point after the index on return.
- * @param cond  True if the execution is conditional, false otherwise.
- * @param len   The number of bytes in the bytecode vector.
+ * Returns how many results an instruction pops off of the results stack, and
+ * how many it pushes, for the bc instructions that do not have indices and do
+ * not jump or return. This relies on the order of the instructions in BcInst.
+ * @param inst  The instruction.
+ * @param push  An out parameter for the number of results that it pushes.
+ * @return      The number of results that it pops.
  */
-static void
-bc_program_execStr(BcProgram* p, const char* restrict code,
-                   size_t* restrict bgn, bool cond, size_t len)
+static size_t
+bc_program_imgEffect(uchar inst, size_t* push)
 {
-	BcResult* r;
-	char* str;
-	BcFunc* f;
-	BcInstPtr ip;
-	size_t fidx;
-	BcNum* n;
-
-	assert(p->stack.len == p->tail_calls.len);
-
-	// Check the stack.
-	if (BC_ERR(!BC_PROG_STACK(&p->results, 1))) bc_err(BC_ERR_EXEC_STACK);
+	*push = 1;
 
-	assert(BC_PROG_STACK(&p->results, 1));
+	// Increments and decrements, and the unary operators.
+	if (inst < BC_INST_POWER) return 1;
 
-	// Get the operand.
-	bc_program_operand(p, &r, &n, 0);
+	// The binary operators and the assignments that are used as values.
+	if (inst <= BC_INST_ASSIGN) return 2;
 
-	// If execution is conditional...
-	if (cond)
+	if (inst <= BC_INST_ASSIGN_NO_VAL)
 	{
-		bool exec;
-		size_t then_idx;
-		// These are volatile to quiet warnings on GCC about clobbering with
-		// longjmp().
-		volatile size_t else_idx;
-		volatile size_t idx;
+		*push = 0;
+		return 2;
+	}
 
-		// Get the index of the "then" var and "else" var.
-		then_idx = bc_program_index(code, bgn);
-		else_idx = bc_program_index(code, bgn);
+	// The constants, like zero and one, and the globals.
+	if (inst < BC_INST_LENGTH) return 0;
 
-		// Figure out if we should execute.
-		exec = (r->d.n.len != 0);
+	// The builtin functions.
+	if (inst <= BC_INST_ASCIIFY) return 1;
 
-		idx = exec ? then_idx : else_idx;
+	// read(), rand(), and the other values that have no operands.
+	if (inst < BC_INST_PRINT) return 0;
 
-		BC_SIG_LOCK;
-		BC_SETJMP_LOCKED(vm, exit);
+	switch (inst)
+	{
+		case BC_INST_SWAP:
+		case BC_INST_DIVMOD:
+		{
+			*push = 2;
+			return 2;
+		}
 
-		// If we are supposed to execute, execute. If else_idx == SIZE_MAX, that
-		// means there was no else clause, so if execute is false and else does
-		// not exist, we don't execute. The goto skips all of the setup for the
-		// execution.
-		if (exec || (else_idx != SIZE_MAX))
+		case BC_INST_MODEXP:
 		{
-			n = bc_vec_top(bc_program_vec(p, idx, BC_TYPE_VAR));
+			return 3;
 		}
-		else goto exit;
 
-		if (BC_ERR(!BC_PROG_STR(n))) bc_err(BC_ERR_EXEC_TYPE);
+		default:
+		{
+			// The print instructions and pop.
+			*push = 0;
+			return 1;
+		}
+	}
+}
 
-		BC_UNSETJMP(vm);
-		BC_SIG_UNLOCK;
+/**
+ * Walks the bytecode of a function in an image file once, so that running it
+ * cannot go outside of the program or the results stack. The bytecode may only
+ * have bc instructions and must end with a return, its indices must be in the
+ * tables of the image, and its labels must point to instructions. Like in what
+ * the parser makes, the results stack must be empty at every jump and label,
+ * which makes one pass enough to check that nothing pops too much. A string
+ * printed by itself must be pushed by the instruction right before.
+ * @param h      The header of the image file.
+ * @param f      The function.
+ * @param marks  A buffer of at least as many bytes as the bytecode.
+ * @return       True if the bytecode was valid, false otherwise.
+ */
+static bool
+bc_program_imgCode(const BcImageHeader* h, const BcImageFunc* f, uchar* marks)
+{
+	size_t i, idx, pop, push, depth = 0;
+	uchar prev, inst = BC_INST_INVALID;
+	bool valid = true, live = true, jump, end;
+
+	// A function that was called but never defined has no bytecode.
+	if (!f->code_len) return !f->labels_len;
+
+	// This marks where instructions start with 1 and where labels point with 2.
+	// NOLINTNEXTLINE
+	memset(marks, 0, f->code_len);
+
+	for (i = 0; valid && i < f->labels_len; ++i)
+	{
+		idx = f->labels[i];
+		valid = (idx < f->code_len);
+		if (valid) marks[idx] = 2;
 	}
-	else
+
+	for (i = 0; valid && i < f->code_len;)
 	{
-		// In non-conditional situations, only the top of stack can be executed,
-		// and in those cases, variables are not allowed to be "on the stack";
-		// they are only put on the stack to be assigned to.
-		assert(r->t != BC_RESULT_VAR);
+		// Labels are jumped to with an empty results stack, and they make the
+		// code after a jump or a return live again.
+		if (marks[i])
+		{
+			valid = (!live || !depth);
+			live = true;
+		}
 
-		if (r->t != BC_RESULT_STR) return;
-	}
+		marks[i] |= 1;
 
-	assert(BC_PROG_STR(n));
+		prev = inst;
+		inst = f->code[i];
+		i += 1;
 
-	// Get the string.
-	str = bc_program_string(p, n);
+		pop = push = 0;
+		jump = end = false;
+
+		switch (inst)
+		{
+			case BC_INST_NUM:
+			{
+				valid = valid && bc_program_imgIndex(f, &i, &idx) &&
+				        idx < h->consts_len;
+				push = 1;
+				break;
+			}
+
+			case BC_INST_VAR:
+			{
+				valid = valid && bc_program_imgIndex(f, &i, &idx) &&
+				        idx < h->vars_len;
+				push = 1;
+				break;
+			}
+
+			case BC_INST_ARRAY_ELEM:
+			case BC_INST_ARRAY:
+			{
+				valid = valid && bc_program_imgIndex(f, &i, &idx) &&
+				        idx < h->arrs_len;
+				pop = (inst == BC_INST_ARRAY_ELEM);
+				push = 1;
+				break;
+			}
+
+			case BC_INST_STR:
+			{
+				valid = valid && bc_program_imgIndex(f, &i, &idx) &&
+				        idx < h->strs_len;
+				push = 1;
+				break;
+			}
+
+			case BC_INST_PRINT_STR:
+			{
+				// This prints a string without checking that it has one, so
+				// the string has to come from the instruction right before it,
+				// which is the only way that the parser makes it.
+				valid = valid && prev == BC_INST_STR;
+				pop = 1;
+				break;
+			}
+
+			case BC_INST_JUMP:
+			case BC_INST_JUMP_ZERO:
+			{
+				valid = valid && bc_program_imgIndex(f, &i, &idx) &&
+				        idx < f->labels_len;
+				pop = (inst == BC_INST_JUMP_ZERO);
+				jump = true;
+				end = (inst == BC_INST_JUMP);
+				break;
+			}
+
+			case BC_INST_CALL:
+			{
+				// The number of arguments is checked against the function when
+				// the call is made, but main() and read() cannot be called.
+				valid = valid && bc_program_imgIndex(f, &i, &pop) &&
+				        bc_program_imgIndex(f, &i, &idx) &&
+				        idx > BC_PROG_READ && idx - BC_PROG_READ <= h->fns_len;
+				push = 1;
+				break;
+			}
 
-	// Get the function index and function.
-	BC_SIG_LOCK;
-	fidx = bc_program_insertFunc(p, str);
-	BC_SIG_UNLOCK;
-	f = bc_vec_item(&p->fns, fidx);
+			case BC_INST_RET:
+			case BC_INST_RET0:
+			case BC_INST_RET_VOID:
+			case BC_INST_HALT:
+			{
+				// Returns drop everything else that the function left.
+				pop = (inst == BC_INST_RET);
+				end = true;
+				break;
+			}
 
-	// If the function has not been parsed yet...
-	if (!f->code.len)
-	{
-		BC_SIG_LOCK;
+			default:
+			{
+#if DC_ENABLED
+				valid = valid && inst < BC_INST_EXTENDED_REGISTERS;
+#else // DC_ENABLED
+				valid = valid && inst < BC_INST_INVALID;
+#endif // DC_ENABLED
+				pop = bc_program_imgEffect(inst, &push);
+				break;
+			}
+		}
 
-		if (!BC_PARSE_IS_INITED(&vm->read_prs, p))
+		// The parser can leave code after a return that never runs, so the
+		// results stack is only tracked for code that can run.
+		if (valid && live)
 		{
-			bc_parse_init(&vm->read_prs, p, fidx);
-
-			// Initialize this too because bc_vm_shutdown() expects them to be
-			// initialized togther.
-			bc_vec_init(&vm->read_buf, sizeof(char), BC_DTOR_NONE);
+			valid = (pop <= depth);
+			depth = depth - pop + push;
+			valid = valid && (!jump || !depth);
 		}
-		// This needs to be updated because the parser could have been used
-		// somewhere else
-		else bc_parse_updateFunc(&vm->read_prs, fidx);
 
-		bc_lex_file(&vm->read_prs.l, vm->file);
+		if (end)
+		{
+			live = false;
+			depth = 0;
+		}
+	}
 
-		BC_SETJMP_LOCKED(vm, err);
+	// Running off of the end of a function would leave it on the stack.
+	valid = valid && (inst == BC_INST_RET || inst == BC_INST_RET0 ||
+	                  inst == BC_INST_RET_VOID);
 
-		BC_SIG_UNLOCK;
+	// The labels have to point to the start of instructions.
+	for (i = 0; valid && i < f->code_len; ++i)
+	{
+		valid = (marks[i] != 2);
+	}
 
-		// Parse. Only one expression is needed, so stdin isn't used.
-		bc_parse_text(&vm->read_prs, str, BC_MODE_FILE);
+	return valid;
+}
 
-		BC_SIG_LOCK;
-		vm->expr(&vm->read_prs, BC_PARSE_NOCALL);
+bool
+bc_program_readImage(BcProgram* p, const char* img)
+{
+	const BcImageHeader* h = (const BcImageHeader*) img;
+	BcImage li;
+	const char** names;
+	BcImageFunc* fns;
+	uchar* marks;
+	size_t i, j, off, nnames, max = 0;
+	bool valid = true;
 
-		BC_UNSETJMP(vm);
+	BC_SIG_ASSERT_LOCKED;
 
-		// We can just assert this here because
-		// dc should parse everything until EOF.
-		assert(vm->read_prs.l.t == BC_LEX_EOF);
+	assert(p != NULL && img != NULL);
+	assert(p->fns.len == BC_PROG_READ + 1 && p->img_fns == NULL);
 
-		BC_SIG_UNLOCK;
+	// Every name takes at least one byte, which keeps the sum from overflowing.
+	if (h->vars_len > h->len || h->arrs_len > h->len ||
+	    h->strs_len > h->len || h->consts_len > h->len)
+	{
+		return false;
 	}
 
-	// Set the instruction pointer.
-	ip.idx = 0;
-	ip.len = p->results.len;
-	ip.func = fidx;
+	nnames = h->vars_len + h->arrs_len + h->strs_len + h->consts_len;
 
-	BC_SIG_LOCK;
+	if (!bc_program_imgValid(h->len, h->fns, h->fns_len,
+	                         sizeof(BcImageRecord)) ||
+	    !bc_program_imgValid(h->len, h->names, nnames, sizeof(char)))
+	{
+		return false;
+	}
 
-	// Pop the operand.
-	bc_vec_pop(&p->results);
+	// The functions have to live as long as the program because they are
+	// stubs until they are called.
+	fns = bc_vm_malloc(h->fns_len * sizeof(BcImageFunc) + 1);
+	p->img_fns = fns;
 
-	// Tail call processing. This condition means that there is more on the
-	// execution stack, and we are at the end of the bytecode vector, and the
-	// last instruction is just a BC_INST_POP_EXEC, which would return.
-	if (p->stack.len > 1 && *bgn == len - 1 && code[*bgn] == BC_INST_POP_EXEC)
+	for (i = 0; i < h->fns_len; ++i)
 	{
-		size_t* call_ptr = bc_vec_top(&p->tail_calls);
+		const BcImageRecord* r;
 
-		// Add one to the tail call.
-		*call_ptr += 1;
+		r = (const BcImageRecord*) (img + h->fns + i * sizeof(BcImageRecord));
+		off = r->name;
 
-		// Pop the execution stack before pushing the new instruction pointer
-		// on.
-		bc_vec_pop(&p->stack);
-	}
-	// If not a tail call, just push a new one.
-	else bc_vec_push(&p->tail_calls, &ip.idx);
+		fns[i].name = bc_program_imgStr(img, &off);
 
-	// Push the new function onto the execution stack and return.
-	bc_vec_push(&p->stack, &ip);
+		if (fns[i].name == NULL ||
+		    !bc_program_imgValid(h->len, r->code, r->code_len, sizeof(uchar)) ||
+		    !bc_program_imgValid(h->len, r->labels, r->labels_len,
+		                         sizeof(size_t)) ||
+		    !bc_program_imgValid(h->len, r->autos, r->autos_len,
+		                         sizeof(BcAuto)) ||
+		    r->nparams > r->autos_len)
+		{
+			return false;
+		}
 
-	BC_SIG_UNLOCK;
+		fns[i].code = (const uchar*) (img + r->code);
+		fns[i].code_len = r->code_len;
+		fns[i].labels = (const size_t*) (img + r->labels);
+		fns[i].labels_len = r->labels_len;
+		fns[i].autos = (const BcAuto*) (img + r->autos);
+		fns[i].autos_len = r->autos_len;
+		fns[i].nparams = r->nparams;
+		fns[i].voidfn = (r->voidfn != 0);
 
-	return;
+		for (j = 0; j < r->autos_len; ++j)
+		{
+			const BcAuto* a = fns[i].autos + j;
 
-err:
-	BC_SIG_MAYLOCK;
+			// Only parameters can be references.
+			if ((a->type != BC_TYPE_VAR || a->idx >= h->vars_len) &&
+			    (a->type != BC_TYPE_ARRAY || a->idx >= h->arrs_len) &&
+			    (a->type != BC_TYPE_REF || a->idx >= h->arrs_len ||
+			     j >= r->nparams))
+			{
+				return false;
+			}
+		}
 
-	f = bc_vec_item(&p->fns, fidx);
+		if (r->code_len > max) max = r->code_len;
+	}
 
-	// Make sure to erase the bytecode vector so dc knows it is not parsed.
-	bc_vec_popAll(&f->code);
+	// One buffer is enough to walk the bytecode of all of the functions.
+	marks = bc_vm_malloc(max + 1);
 
-exit:
-	bc_vec_pop(&p->results);
-	BC_LONGJMP_CONT(vm);
-}
+	for (i = 0; valid && i < h->fns_len; ++i)
+	{
+		valid = bc_program_imgCode(h, fns + i, marks);
+	}
 
-/**
- * Prints every item on the results stack, one per line.
- * @param p  The program.
- */
-static void
-bc_program_printStack(BcProgram* p)
-{
-	size_t idx;
+	free(marks);
 
-	for (idx = 0; idx < p->results.len; ++idx)
+	if (!valid) return false;
+
+	names = bc_vm_malloc(nnames * sizeof(char*) + 1);
+	off = h->names;
+
+	for (i = 0; i < nnames; ++i)
 	{
-		bc_program_print(p, BC_INST_PRINT, idx);
+		names[i] = bc_program_imgStr(img, &off);
+
+		// Constants are parsed when they are first used, so they have to be
+		// what the lexer would have let through.
+		if (names[i] == NULL ||
+		    (i >= nnames - h->consts_len && !bc_num_strValid(names[i])))
+		{
+			free(names);
+			return false;
+		}
 	}
-}
-#endif // DC_ENABLED
 
-/**
- * Pushes the value of a global onto the results stack.
- * @param p     The program.
- * @param inst  Which global to push, as an instruction.
- */
-static void
-bc_program_pushGlobal(BcProgram* p, uchar inst)
-{
-	BcResultType t;
+	// NOLINTNEXTLINE
+	memset(&li, 0, sizeof(BcImage));
 
-	// Make sure the instruction is valid.
-	assert(inst >= BC_INST_IBASE && inst <= BC_INST_SCALE);
+	li.fns = fns;
+	li.fns_len = h->fns_len;
+	li.vars = names;
+	li.vars_len = h->vars_len;
+	li.arrs = li.vars + li.vars_len;
+	li.arrs_len = h->arrs_len;
+	li.strs = li.arrs + li.arrs_len;
+	li.strs_len = h->strs_len;
+	li.consts = li.strs + li.strs_len;
+	li.consts_len = h->consts_len;
 
-	// Push the global.
-	t = inst - BC_INST_IBASE + BC_RESULT_IBASE;
-	bc_program_pushBigdig(p, p->globals[inst - BC_INST_IBASE], t);
-}
+	valid = bc_program_imgLoad(p, &li);
 
-/**
- * Pushes the value of a global setting onto the stack.
- * @param p     The program.
- * @param inst  Which global setting to push, as an instruction.
- */
-static void
-bc_program_globalSetting(BcProgram* p, uchar inst)
-{
-	BcBigDig val;
+	// The names have been copied into the maps.
+	free(names);
 
-	// Make sure the instruction is valid.
-#if DC_ENABLED
-	assert((inst >= BC_INST_LINE_LENGTH && inst <= BC_INST_LEADING_ZERO) ||
-	       (BC_IS_DC && inst == BC_INST_EXTENDED_REGISTERS));
-#else // DC_ENABLED
-	assert(inst >= BC_INST_LINE_LENGTH && inst <= BC_INST_LEADING_ZERO);
-#endif // DC_ENABLED
+	if (!valid) return false;
 
-	if (inst == BC_INST_LINE_LENGTH)
-	{
-		val = (BcBigDig) vm->line_len;
-	}
-#if BC_ENABLED
-	else if (inst == BC_INST_GLOBAL_STACKS)
-	{
-		val = (BC_G != 0);
-	}
-#endif // BC_ENABLED
-#if DC_ENABLED
-	else if (inst == BC_INST_EXTENDED_REGISTERS)
+	off = h->vals;
+
+	for (i = 0; i < h->vals_len; ++i)
 	{
-		val = (DC_X != 0);
-	}
-#endif // DC_ENABLED
-	else val = (BC_Z != 0);
+		const BcImageVal* val;
 
-	// Push the global.
-	bc_program_pushBigdig(p, val, BC_RESULT_TEMP);
-}
+		if (!bc_program_imgValid(h->len, off, 1, sizeof(BcImageVal)))
+		{
+			return false;
+		}
 
-#if BC_ENABLE_EXTRA_MATH
+		val = (const BcImageVal*) (img + off);
+		off += sizeof(BcImageVal);
 
-/**
- * Pushes the value of seed on the stack.
- * @param p  The program.
- */
-static void
-bc_program_pushSeed(BcProgram* p)
-{
-	BcResult* res;
+		if (val->type == BC_TYPE_VAR && val->idx < p->vars.len && val->len == 1)
+		{
+			BcNum* n = bc_vec_item(bc_vec_item(&p->vars, val->idx), 0);
+			if (!bc_program_imgReadNum(p, img, &off, n)) return false;
+		}
+		else if (val->type == BC_TYPE_ARRAY && val->idx < p->arrs.len &&
+		         val->len && val->len <= h->len)
+		{
+			BcVec* a = bc_vec_item(bc_vec_item(&p->arrs, val->idx), 0);
 
-	res = bc_program_prepResult(p);
-	res->t = BC_RESULT_SEED;
+			bc_array_expand(a, val->len);
 
-	BC_SIG_LOCK;
+			for (j = 0; j < val->len; ++j)
+			{
+				BcNum* n = bc_vec_item(a, j);
+				if (!bc_program_imgReadNum(p, img, &off, n)) return false;
+			}
+		}
+		else return false;
+	}
 
-	// We need 2*BC_RAND_NUM_SIZE because of the size of the state.
-	bc_num_init(&res->d.n, 2 * BC_RAND_NUM_SIZE);
+	return true;
+}
 
-	BC_SIG_UNLOCK;
+#endif // BC_ENABLE_IMAGES
 
-	bc_num_createFromRNG(&res->d.n, &p->rng);
-}
+#if BC_DEBUG
 
-#endif // BC_ENABLE_EXTRA_MATH
+#if BC_ENABLED
 
 /**
- * Adds a function to the fns array. The function's ID must have already been
- * inserted into the map.
- * @param p       The program.
- * @param id_ptr  The ID of the function as inserted into the map.
+ * Frees the pools of numbers and arrays for function parameters and autos.
+ * They have no destructors because items are moved in and out of them.
+ * @param p  The program.
  */
 static void
-bc_program_addFunc(BcProgram* p, BcId* id_ptr)
-{
-	BcFunc* f;
-
-	BC_SIG_ASSERT_LOCKED;
-
-	// Push and init.
-	f = bc_vec_pushEmpty(&p->fns);
-	bc_func_init(f, id_ptr->name);
-}
-
-size_t
-bc_program_insertFunc(BcProgram* p, const char* name)
+bc_program_freePools(BcProgram* p)
 {
-	BcId* id_ptr;
-	bool new;
-	size_t idx;
+	size_t i;
 
 	BC_SIG_ASSERT_LOCKED;
 
-	assert(p != NULL && name != NULL);
-
-	// Insert into the map and get the resulting ID.
-	new = bc_map_insert(&p->fn_map, name, p->fns.len, &idx);
-	id_ptr = (BcId*) bc_vec_item(&p->fn_map, idx);
-	idx = id_ptr->idx;
-
-	// If the function is new...
-	if (new)
+	for (i = 0; i < p->num_pool.len; ++i)
 	{
-		// Add the function to the fns array.
-		bc_program_addFunc(p, id_ptr);
+		bc_num_free(bc_vec_item(&p->num_pool, i));
 	}
-#if BC_ENABLED
-	// bc has to reset the function because it's about to be redefined.
-	else if (BC_IS_BC)
+
+	for (i = 0; i < p->arr_pool.len; ++i)
 	{
-		BcFunc* func = bc_vec_item(&p->fns, idx);
-		bc_func_reset(func);
+		bc_vec_free(bc_vec_item(&p->arr_pool, i));
 	}
-#endif // BC_ENABLED
 
-	return idx;
+	bc_vec_free(&p->num_pool);
+	bc_vec_free(&p->arr_pool);
 }
 
-#if BC_DEBUG
+#endif // BC_ENABLED
+
 void
 bc_program_free(BcProgram* p)
 {
@@ -2824,17 +4566,17 @@ bc_program_free(BcProgram* p)
 #endif // BC_ENABLED
 
 	bc_vec_free(&p->fns);
-	bc_vec_free(&p->fn_map);
+	bc_map_free(&p->fn_map);
 	bc_vec_free(&p->vars);
-	bc_vec_free(&p->var_map);
+	bc_map_free(&p->var_map);
 	bc_vec_free(&p->arrs);
-	bc_vec_free(&p->arr_map);
+	bc_map_free(&p->arr_map);
 	bc_vec_free(&p->results);
 	bc_vec_free(&p->stack);
 	bc_vec_free(&p->consts);
-	bc_vec_free(&p->const_map);
+	bc_map_free(&p->const_map);
 	bc_vec_free(&p->strs);
-	bc_vec_free(&p->str_map);
+	bc_map_free(&p->str_map);
 
 	bc_num_free(&p->asciify);
 
@@ -2849,6 +4591,23 @@ bc_program_free(BcProgram* p)
 #if DC_ENABLED
 	if (BC_IS_DC) bc_vec_free(&p->tail_calls);
 #endif // DC_ENABLED
+
+#if BC_ENABLED
+	if (BC_IS_BC)
+	{
+		bc_vec_free(&p->arr_cows);
+		bc_program_freePools(p);
+		bc_program_memoClear(p);
+		bc_vec_free(&p->memos);
+		bc_vec_free(&p->memo_keys);
+		bc_vec_free(&p->memo_calls);
+		free(p->memo_slots);
+	}
+#endif // BC_ENABLED
+
+#if BC_ENABLE_IMAGES
+	free(p->img_fns);
+#endif // BC_ENABLE_IMAGES
 }
 #endif // BC_DEBUG
 
@@ -2891,6 +4650,25 @@ bc_program_init(BcProgram* p)
 	}
 #endif // DC_ENABLED
 
+#if BC_ENABLED
+	// bc-only setup.
+	if (BC_IS_BC)
+	{
+		bc_vec_init(&p->arr_cows, sizeof(BcLoc), BC_DTOR_NONE);
+		bc_vec_init(&p->num_pool, sizeof(BcNum), BC_DTOR_NONE);
+		bc_vec_init(&p->arr_pool, sizeof(BcVec), BC_DTOR_NONE);
+		bc_vec_init(&p->memos, sizeof(BcMemo), BC_DTOR_NONE);
+		bc_vec_init(&p->memo_keys, sizeof(uchar), BC_DTOR_NONE);
+		bc_vec_init(&p->memo_calls, sizeof(BcMemoCall), BC_DTOR_NONE);
+		p->memo_slots = NULL;
+		p->memo_head = p->memo_tail = BC_VEC_INVALID_IDX;
+	}
+#endif // BC_ENABLED
+
+#if BC_ENABLE_IMAGES
+	p->img_fns = NULL;
+#endif // BC_ENABLE_IMAGES
+
 	bc_num_setup(&p->strmb, p->strmb_num, BC_NUM_BIGDIG_LOG10);
 	bc_num_bigdig2num(&p->strmb, BC_NUM_STREAM_BASE);
 
@@ -2989,6 +4767,13 @@ bc_program_reset(BcProgram* p)
 #if BC_ENABLED
 	// Clear the globals' stacks.
 	if (BC_G) bc_program_popGlobals(p, true);
+
+	// Calls that were waiting to be memoized never will be.
+	if (BC_IS_BC)
+	{
+		bc_vec_popAll(&p->memo_keys);
+		bc_vec_popAll(&p->memo_calls);
+	}
 #endif // BC_ENABLED
 
 	// Clear the bytecode vector of the main function.
@@ -243,6 +243,10 @@ bc_read_line(BcVec* vec, const char* prompt)
 {
 	BcStatus s;
 
+	// When stdin is read in blocks, the line has probably already been read,
+	// and it has already been checked for binary data.
+	if (vm->stdin_blocks) return bc_vm_readNextLine(vec);
+
 #if BC_ENABLE_HISTORY
 	// Get a line from either history or manual reading.
 	if (BC_TTY && !vm->history.badTerm)
@@ -262,15 +266,12 @@ bc_read_line(BcVec* vec, const char* prompt)
 	return s;
 }
 
-char*
-bc_read_file(const char* path)
+int
+bc_read_openFile(const char* path, size_t* size)
 {
 	BcErr e = BC_ERR_FATAL_IO_ERR;
-	size_t size, to_read;
 	struct stat pstat;
 	int fd;
-	char* buf;
-	char* buf2;
 
 	// This has been copied to gen/strgen.c. Make sure to change that if this
 	// changes.
@@ -292,17 +293,42 @@ bc_read_file(const char* path)
 
 	// The reason we call fstat is to eliminate TOCTOU race conditions. This
 	// way, we have an open file, so it's not going anywhere.
-	if (BC_ERR(fstat(fd, &pstat) == -1)) goto malloc_err;
+	if (BC_ERR(fstat(fd, &pstat) == -1)) goto err;
 
 	// Make sure it's not a directory.
 	if (BC_ERR(S_ISDIR(pstat.st_mode)))
 	{
 		e = BC_ERR_FATAL_PATH_DIR;
-		goto malloc_err;
+		goto err;
 	}
 
-	// Get the size of the file and allocate that much.
-	size = (size_t) pstat.st_size;
+	if (size != NULL) *size = (size_t) pstat.st_size;
+
+	return fd;
+
+err:
+	close(fd);
+	bc_verr(e, path);
+	return -1;
+}
+
+char*
+bc_read_file(const char* path)
+{
+	BcErr e = BC_ERR_FATAL_IO_ERR;
+	size_t size = 0, to_read;
+	int fd;
+	char* buf;
+	char* buf2;
+
+	// This has been copied to gen/strgen.c. Make sure to change that if this
+	// changes.
+
+	BC_SIG_ASSERT_LOCKED;
+
+	fd = bc_read_openFile(path, &size);
+
+	// Allocate as much as the size of the file.
 	buf = bc_vm_malloc(size + 1);
 	buf2 = buf;
 	to_read = size;
@@ -333,8 +359,106 @@ bc_read_file(const char* path)
 
 read_err:
 	free(buf);
-malloc_err:
 	close(fd);
 	bc_verr(e, path);
 	return NULL;
 }
+
+/**
+ * Returns the length of the longest prefix of @a buf that is made of whole
+ * lines, not counting lines that end in a backslash because those continue on
+ * the next line. Only newlines at or after @a start are looked at.
+ * @param buf    The buffer to search.
+ * @param start  The index to start looking for newlines at.
+ * @param len    The length of the buffer.
+ * @return       The length of the prefix, or 0 if there are no whole lines.
+ */
+static size_t
+bc_read_lines(const char* buf, size_t start, size_t len)
+{
+	size_t i;
+
+	for (i = len; i > start; --i)
+	{
+		if (buf[i - 1] == '\n' && (i < 2 || buf[i - 2] != '\\')) return i;
+	}
+
+	return 0;
+}
+
+bool
+bc_read_stream(BcVec* vec, BcVec* rem, int* fd, const char* path)
+{
+	size_t len;
+
+	assert(vec != NULL && vec->size == sizeof(char) && vec->len);
+	assert(rem != NULL && rem->size == sizeof(char));
+	assert(fd != NULL && path != NULL);
+
+	BC_SIG_ASSERT_NOT_LOCKED;
+
+	// Read until there is at least one whole line or the end of the file.
+	for (len = bc_read_lines(rem->v, 0, rem->len); !len && *fd >= 0;)
+	{
+		ssize_t r;
+		size_t old = rem->len;
+
+		BC_SIG_LOCK;
+
+		bc_vec_grow(rem, BC_READ_STREAM_SIZE);
+
+		r = read(*fd, rem->v + old, BC_READ_STREAM_SIZE);
+
+		if (BC_ERR(r < 0))
+		{
+			// Let a signal jump out, if it wants to. Otherwise, just try again.
+			if (errno == EINTR)
+			{
+				BC_SIG_UNLOCK;
+				continue;
+			}
+
+			bc_verr(BC_ERR_FATAL_IO_ERR, path);
+		}
+
+		// At the end of the file, just take everything that is left.
+		if (!r)
+		{
+			*fd = -1;
+			len = rem->len;
+		}
+		else
+		{
+			if (BC_ERR(bc_read_binary(rem->v + old, (size_t) r)))
+			{
+				bc_verr(BC_ERR_FATAL_BIN_FILE, path);
+			}
+
+			rem->len += (size_t) r;
+
+			// Only the new data needs to be searched; there were no whole
+			// lines in the old data.
+			len = bc_read_lines(rem->v, old, rem->len);
+		}
+
+		BC_SIG_UNLOCK;
+	}
+
+	if (!len) return false;
+
+	BC_SIG_LOCK;
+
+	// Move the lines onto the end of the string in vec, and move what is left
+	// up to the front of rem.
+	bc_vec_pop(vec);
+	bc_vec_npush(vec, len, rem->v);
+	bc_vec_pushByte(vec, '\0');
+
+	rem->len -= len;
+	// NOLINTNEXTLINE
+	memmove(rem->v, rem->v + len, rem->len);
+
+	BC_SIG_UNLOCK;
+
+	return true;
+}
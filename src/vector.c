@@ -53,6 +53,9 @@ bc_vec_grow(BcVec* restrict v, size_t n)
 	cap = v->cap;
 	len = v->len + n;
 
+	// Callers use this to make sure there is room, and there may already be.
+	if (len <= cap) return;
+
 	// If this is true, we might overflow.
 	if (len > SIZE_MAX / 2) cap = len;
 	else
@@ -402,97 +405,222 @@ bc_vec_free(void* vec)
 
 #if !BC_ENABLE_LIBRARY
 
+size_t
+bc_vec_hash(const char* bytes, size_t len)
+{
+	size_t h, i;
+
+	// This is FNV-1a, which is simple, fast on the short names that bc and dc
+	// have, and good enough for a linear-probed table.
+#if BC_LONG_BIT >= 64
+	h = (size_t) UINT64_C(14695981039346656037);
+#else // BC_LONG_BIT >= 64
+	h = (size_t) UINT32_C(2166136261);
+#endif // BC_LONG_BIT >= 64
+
+	for (i = 0; i < len; ++i)
+	{
+		h ^= (uchar) bytes[i];
+
+#if BC_LONG_BIT >= 64
+		h *= (size_t) UINT64_C(1099511628211);
+#else // BC_LONG_BIT >= 64
+		h *= (size_t) UINT32_C(16777619);
+#endif // BC_LONG_BIT >= 64
+	}
+
+	return h;
+}
+
+/**
+ * Hashes a name for a map.
+ * @param name  The name to hash.
+ * @return      The hash of @a name.
+ */
+static inline size_t
+bc_map_hash(const char* name)
+{
+	return bc_vec_hash(name, strlen(name));
+}
+
+/**
+ * Allocates and empties the hash table of a map.
+ * @param m       The map.
+ * @param nslots  The number of slots. This must be a power of two.
+ */
+static void
+bc_map_alloc(BcMap* restrict m, size_t nslots)
+{
+	size_t i;
+
+	BC_SIG_ASSERT_LOCKED;
+
+	assert(nslots && !(nslots & (nslots - 1)));
+
+	m->slots = bc_vm_malloc(bc_vm_arraySize(nslots, sizeof(BcMapSlot)));
+	m->nslots = nslots;
+
+	for (i = 0; i < nslots; ++i)
+	{
+		m->slots[i].idx = BC_VEC_INVALID_IDX;
+	}
+}
+
 /**
- * Finds a name in a map by binary search. Returns the index where the item
- * *would* be if it doesn't exist. Callers are responsible for checking that the
- * item exists at the index.
- * @param v     The map.
+ * Finds a name in a map. Returns the slot where the item is, or the empty slot
+ * where the item *would* be if it doesn't exist. Callers are responsible for
+ * checking whether the slot is empty.
+ * @param m     The map.
  * @param name  The name to find.
- * @return      The index of the item with @a name, or where the item would be
- *              if it does not exist.
+ * @param hash  The hash of @a name.
+ * @return      The slot of the item with @a name, or the empty slot where it
+ *              would go if it does not exist.
+ */
+static BcMapSlot*
+bc_map_find(const BcMap* restrict m, const char* name, size_t hash)
+{
+	size_t mask = m->nslots - 1;
+	size_t i = hash & mask;
+
+	// Because the table is never more than half full, this is guaranteed to
+	// find either the item or an empty slot.
+	while (m->slots[i].idx != BC_VEC_INVALID_IDX)
+	{
+		BcMapSlot* slot = m->slots + i;
+
+		if (slot->hash == hash &&
+		    !strcmp(name, ((BcId*) bc_vec_item(&m->ids, slot->idx))->name))
+		{
+			return slot;
+		}
+
+		i = (i + 1) & mask;
+	}
+
+	return m->slots + i;
+}
+
+/**
+ * Doubles the size of the hash table of a map and reinserts all of the items.
+ * The names do not need to be rehashed because their hashes are kept in the
+ * slots.
+ * @param m  The map to grow.
  */
-static size_t
-bc_map_find(const BcVec* restrict v, const char* name)
+static void
+bc_map_grow(BcMap* restrict m)
 {
-	size_t low = 0, high = v->len;
+	BcMapSlot* old = m->slots;
+	size_t i, mask, len = m->nslots;
+
+	BC_SIG_ASSERT_LOCKED;
+
+	bc_map_alloc(m, len << 1);
 
-	while (low < high)
+	mask = m->nslots - 1;
+
+	for (i = 0; i < len; ++i)
 	{
-		size_t mid = low + (high - low) / 2;
-		const BcId* id = bc_vec_item(v, mid);
-		int result = strcmp(name, id->name);
+		size_t j;
+
+		if (old[i].idx == BC_VEC_INVALID_IDX) continue;
 
-		if (!result) return mid;
-		else if (result < 0) high = mid;
-		else low = mid + 1;
+		// All names are unique, so there is no need to compare them here.
+		for (j = old[i].hash & mask; m->slots[j].idx != BC_VEC_INVALID_IDX;
+		     j = (j + 1) & mask)
+		{
+			continue;
+		}
+
+		m->slots[j] = old[i];
 	}
 
-	return low;
+	free(old);
+}
+
+void
+bc_map_init(BcMap* restrict m)
+{
+	BC_SIG_ASSERT_LOCKED;
+
+	assert(m != NULL);
+
+	bc_vec_init(&m->ids, sizeof(BcId), BC_DTOR_NONE);
+	bc_map_alloc(m, BC_MAP_START_SLOTS);
+}
+
+void
+bc_map_free(BcMap* restrict m)
+{
+	BC_SIG_ASSERT_LOCKED;
+
+	assert(m != NULL);
+
+	bc_vec_free(&m->ids);
+	free(m->slots);
 }
 
 bool
-bc_map_insert(BcVec* restrict v, const char* name, size_t idx,
+bc_map_insert(BcMap* restrict v, const char* name, size_t idx,
               size_t* restrict i)
 {
-	BcId id;
+	BcId* id;
+	BcMapSlot* slot;
+	size_t hash;
 
 	BC_SIG_ASSERT_LOCKED;
 
 	assert(v != NULL && name != NULL && i != NULL);
 
-	*i = bc_map_find(v, name);
+	hash = bc_map_hash(name);
+	slot = bc_map_find(v, name, hash);
 
-	assert(*i <= v->len);
-
-	if (*i != v->len && !strcmp(name, ((BcId*) bc_vec_item(v, *i))->name))
+	if (slot->idx != BC_VEC_INVALID_IDX)
 	{
+		*i = slot->idx;
 		return false;
 	}
 
-	id.name = bc_slabvec_strdup(&vm->slabs, name);
-	id.idx = idx;
+	// Keep the load factor at or below one half. If the table has to grow, the
+	// empty slot we found is no longer valid.
+	if (BC_UNLIKELY((v->ids.len + 1) * 2 > v->nslots))
+	{
+		bc_map_grow(v);
+		slot = bc_map_find(v, name, hash);
+	}
+
+	*i = v->ids.len;
+
+	id = bc_vec_pushEmpty(&v->ids);
+	id->name = bc_slabvec_strdup(&vm->slabs, name);
+	id->idx = idx;
 
-	bc_vec_pushAt(v, &id, *i);
+	slot->hash = hash;
+	slot->idx = *i;
 
 	return true;
 }
 
 size_t
-bc_map_index(const BcVec* restrict v, const char* name)
+bc_map_index(const BcMap* restrict v, const char* name)
 {
-	size_t i;
-	BcId* id;
-
 	assert(v != NULL && name != NULL);
 
-	i = bc_map_find(v, name);
-
-	// If out of range, return invalid.
-	if (i >= v->len) return BC_VEC_INVALID_IDX;
-
-	id = (BcId*) bc_vec_item(v, i);
-
-	// Make sure the item exists and return appropriately.
-	return strcmp(name, id->name) ? BC_VEC_INVALID_IDX : i;
+	return bc_map_find(v, name, bc_map_hash(name))->idx;
 }
 
 #if DC_ENABLED
 const char*
-bc_map_name(const BcVec* restrict v, size_t idx)
+bc_map_name(const BcMap* restrict v, size_t idx)
 {
-	size_t i, len = v->len;
+	BcId* id;
 
-	for (i = 0; i < len; ++i)
-	{
-		BcId* id = (BcId*) bc_vec_item(v, i);
-		if (id->idx == idx) return id->name;
-	}
+	// IDs are never moved, and every map is filled in lockstep with its partner
+	// array, so the ID for an item is at the same index as the item.
+	id = bc_map_item(v, idx);
 
-	BC_UNREACHABLE
+	assert(id->idx == idx);
 
-#if !BC_CLANG
-	return "";
-#endif // !BC_CLANG
+	return id->name;
 }
 #endif // DC_ENABLED
 
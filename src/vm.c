@@ -45,8 +45,15 @@
 
 #ifndef _WIN32
 
+#include <fcntl.h>
+#include <poll.h>
 #include <unistd.h>
+#include <sys/mman.h>
+#include <sys/select.h>
+#include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/un.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
 #else // _WIN32
@@ -381,6 +388,12 @@ bc_vm_handleError(BcErr e, size_t line, ...)
 	}
 #endif // BC_ENABLED
 
+#if BC_ENABLED
+	// Statements that were parsed ahead have to run before the error, like
+	// they would have if they had run right away.
+	bc_vm_runAhead();
+#endif // BC_ENABLED
+
 	BC_SIG_TRYLOCK(lock);
 
 	// Make sure all of stdout is written first.
@@ -680,6 +693,9 @@ bc_vm_shutdown(void)
 	free(vm->env_args_buffer);
 	bc_vec_free(&vm->files);
 	bc_vec_free(&vm->exprs);
+#if BC_ENABLE_JOBS
+	bc_vec_free(&vm->expr_ends);
+#endif // BC_ENABLE_JOBS
 
 	if (BC_PARSE_IS_INITED(&vm->read_prs, &vm->prog))
 	{
@@ -690,6 +706,10 @@ bc_vm_shutdown(void)
 	bc_parse_free(&vm->prs);
 	bc_program_free(&vm->prog);
 
+#if BC_ENABLE_IMAGES
+	if (vm->image != NULL) munmap(vm->image, vm->image_len);
+#endif // BC_ENABLE_IMAGES
+
 	bc_slabvec_free(&vm->slabs);
 #endif // !BC_ENABLE_LIBRARY
 
@@ -916,6 +936,27 @@ bc_vm_putchar(int c, BcFlushType type)
 #endif // BC_ENABLE_LIBRARY
 }
 
+void
+bc_vm_write(const char* str, size_t len, BcFlushType type)
+{
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+	bc_vec_npush(&vm->out, len, str);
+#else // BC_ENABLE_LIBRARY
+#if BC_ENABLE_LINE_LIB
+	size_t i;
+
+	for (i = 0; i < len; ++i)
+	{
+		bc_file_putchar(&vm->fout, type, (uchar) str[i]);
+	}
+#else // BC_ENABLE_LINE_LIB
+	bc_file_write(&vm->fout, type, str, len);
+#endif // BC_ENABLE_LINE_LIB
+	vm->nchars = (uint16_t) (vm->nchars + len);
+#endif // BC_ENABLE_LIBRARY
+}
+
 #if !BC_ENABLE_LIBRARY
 
 #ifdef __OpenBSD__
@@ -999,7 +1040,7 @@ bc_vm_clean(void)
 #if BC_ENABLED
 	// bc has this extra condition. If it not satisfied, it is in the middle of
 	// a parse.
-	if (good && BC_IS_BC) good = !BC_PARSE_NO_EXEC(&vm->prs);
+	if (BC_IS_BC) good = !BC_PARSE_NO_EXEC(&vm->prs);
 #endif // BC_ENABLED
 
 #if DC_ENABLED
@@ -1041,6 +1082,148 @@ bc_vm_clean(void)
 	}
 }
 
+#if BC_ENABLED
+
+/**
+ * Runs the code of main up to @a end, which is the end of the statements that
+ * were parsed ahead. Any code after that is from a statement that is not done
+ * being parsed, so it is hidden until it is done. bc does not parse ahead when
+ * it is interactive, so if this jumps, bc exits, and nothing has to be put back.
+ * @param end  The end of the code to run.
+ */
+static void
+bc_vm_execAhead(size_t end)
+{
+	BcFunc* f = bc_vec_item(&vm->prog.fns, BC_PROG_MAIN);
+	BcInstPtr* ip;
+	size_t len = f->code.len;
+	char c;
+
+	BC_SIG_ASSERT_NOT_LOCKED;
+
+	if (end == len)
+	{
+		bc_program_exec(&vm->prog);
+		return;
+	}
+
+	// With computed goto, bc_program_exec() puts a marker at the end of the
+	// code, so the byte that is there has to be put back.
+	c = f->code.v[end];
+	f->code.len = end;
+
+	bc_program_exec(&vm->prog);
+
+	f = bc_vec_item(&vm->prog.fns, BC_PROG_MAIN);
+	ip = bc_vec_item(&vm->prog.stack, 0);
+
+	f->code.v[end] = c;
+	f->code.len = len;
+	ip->idx = end;
+}
+
+void
+bc_vm_runAhead(void)
+{
+	sig_atomic_t lock;
+
+	if (!vm->ahead) return;
+
+	// Anything that happens while they run must not run them again.
+	vm->ahead = false;
+
+	lock = vm->sig_lock;
+	if (lock) BC_SIG_UNLOCK;
+
+	bc_vm_execAhead(vm->ahead_end);
+
+	if (lock) BC_SIG_LOCK;
+}
+
+/**
+ * Processes text like bc_vm_process(), but parses up to BC_VM_PARSE_AHEAD
+ * statements before it runs them, which saves going in and out of the
+ * interpreter for every statement of a long script. The statements still run
+ * in order, and nothing that the parser does can get ahead of them: function
+ * definitions, quit, limits, and errors call bc_vm_runAhead() first, and a
+ * statement with read() runs before the next one is parsed because read() takes
+ * the next line of stdin. In stdin mode, so does a statement with a call, since
+ * the function may use read(). ibase changes do not matter because constants
+ * are converted when they run.
+ * @param mode  The mode to process in.
+ */
+static void
+bc_vm_processAhead(BcMode mode)
+{
+	BcFunc* f;
+	size_t n = 0;
+	bool more;
+
+	do
+	{
+		while (vm->prs.l.t != BC_LEX_EOF)
+		{
+			BC_SIG_LOCK;
+
+			vm->ahead = (n != 0);
+			vm->parse(&vm->prs);
+
+			// If the parser had to run the statements, they are done.
+			if (!vm->ahead) n = 0;
+			vm->ahead = false;
+
+			BC_SIG_UNLOCK;
+
+			// Only whole statements can run.
+			if (BC_PARSE_NO_EXEC(&vm->prs)) continue;
+
+			f = bc_vec_item(&vm->prog.fns, BC_PROG_MAIN);
+			vm->ahead_end = f->code.len;
+			n += 1;
+
+			if (n < BC_VM_PARSE_AHEAD && !vm->ahead_stop) continue;
+
+			bc_program_exec(&vm->prog);
+
+			assert(vm->prog.results.len == 0);
+
+			n = 0;
+			vm->ahead_stop = false;
+
+			// In stream mode, bc does not return until the end of the file
+			// (see bc_lex_next()), so it needs to clean up as it goes.
+			if (mode == BC_MODE_STREAM)
+			{
+				BC_SIG_LOCK;
+				bc_vm_clean();
+				BC_SIG_UNLOCK;
+			}
+		}
+
+		// In stdin mode, the lexer stops at the end of every line, so if the
+		// text has more lines, go on to the next one.
+		BC_SIG_LOCK;
+		more = (mode == BC_MODE_STDIN && bc_lex_nextLine(&vm->prs.l));
+		BC_SIG_UNLOCK;
+	}
+	while (more);
+
+	// Run the rest, even if the last statement is not done.
+	if (n)
+	{
+		bc_vm_execAhead(vm->ahead_end);
+
+		if (mode == BC_MODE_STREAM)
+		{
+			BC_SIG_LOCK;
+			bc_vm_clean();
+			BC_SIG_UNLOCK;
+		}
+	}
+}
+
+#endif // BC_ENABLED
+
 /**
  * Process a bunch of text.
  * @param text  The text to process.
@@ -1049,25 +1232,59 @@ bc_vm_clean(void)
 static void
 bc_vm_process(const char* text, BcMode mode)
 {
+	bool more;
+
 	// Set up the parser.
 	bc_parse_text(&vm->prs, text, mode);
 
-	while (vm->prs.l.t != BC_LEX_EOF)
+#if BC_ENABLED
+	// bc parses ahead unless it is interactive, because then every statement
+	// has to run as soon as it is typed.
+	if (BC_IS_BC && BC_VM_PARSE_AHEAD > 1 && !BC_I)
 	{
-		// Parsing requires a signal lock. We also don't parse everything; we
-		// want to execute as soon as possible for *everything*.
-		BC_SIG_LOCK;
-		vm->parse(&vm->prs);
-		BC_SIG_UNLOCK;
+		bc_vm_processAhead(mode);
+		return;
+	}
+#endif // BC_ENABLED
+
+	do
+	{
+		while (vm->prs.l.t != BC_LEX_EOF)
+		{
+			// Parsing requires a signal lock. We also don't parse everything;
+			// we want to execute as soon as possible for *everything*.
+			BC_SIG_LOCK;
+			vm->parse(&vm->prs);
+			BC_SIG_UNLOCK;
+
+			// Execute if possible.
+			if (BC_IS_DC || !BC_PARSE_NO_EXEC(&vm->prs))
+			{
+				bc_program_exec(&vm->prog);
+			}
 
-		// Execute if possible.
-		if (BC_IS_DC || !BC_PARSE_NO_EXEC(&vm->prs)) bc_program_exec(&vm->prog);
+			assert(BC_IS_DC || vm->prog.results.len == 0);
+
+			// In stream mode, bc does not return until the end of the file
+			// (see bc_lex_next()), so it needs to clean up as it goes.
+			if (mode == BC_MODE_STREAM)
+			{
+				BC_SIG_LOCK;
+				bc_vm_clean();
+				BC_SIG_UNLOCK;
+			}
 
-		assert(BC_IS_DC || vm->prog.results.len == 0);
+			// Flush in interactive mode.
+			if (BC_I) bc_file_flush(&vm->fout, bc_flush_save);
+		}
 
-		// Flush in interactive mode.
-		if (BC_I) bc_file_flush(&vm->fout, bc_flush_save);
+		// In stdin mode, the lexer stops at the end of every line, so if the
+		// text has more lines, go on to the next one.
+		BC_SIG_LOCK;
+		more = (mode == BC_MODE_STDIN && bc_lex_nextLine(&vm->prs.l));
+		BC_SIG_UNLOCK;
 	}
+	while (more);
 }
 
 #if BC_ENABLED
@@ -1087,38 +1304,63 @@ bc_vm_endif(void)
 
 #endif // BC_ENABLED
 
+bool
+bc_vm_readFile(bool clear)
+{
+	BC_SIG_ASSERT_NOT_LOCKED;
+
+	// Clear the buffer if desired.
+	if (clear) bc_vec_empty(&vm->buffer);
+
+	return bc_read_stream(&vm->buffer, &vm->file_buf, &vm->file_fd, vm->file);
+}
+
 /**
- * Processes a file.
+ * Processes a file. The file is read and processed a piece at a time, like
+ * stdin, so that processing can start right away and so that memory use does
+ * not depend on the size of the file.
  * @param file  The filename.
  */
 static void
 bc_vm_file(const char* file)
 {
-	char* data = NULL;
+	int fd;
+
 #if BC_ENABLE_LIBRARY
 	BcVm* vm = bcl_getspecific();
 #endif // BC_ENABLE_LIBRARY
 
 	assert(!vm->sig_pop);
 
-	vm->mode = BC_MODE_FILE;
+	vm->mode = BC_MODE_STREAM;
 
 	// Set up the lexer.
 	bc_lex_file(&vm->prs.l, file);
 
 	BC_SIG_LOCK;
 
-	// Read the file.
-	data = bc_read_file(file);
-
-	assert(data != NULL);
+	// Open the file. We use the stdin buffer because the lexer needs to be able
+	// to get more data for comments and strings that go across pieces. See the
+	// comment on the allocation of vm->buffer in bc_vm_stdin() for more
+	// information.
+	fd = bc_read_openFile(file, NULL);
+	vm->file_fd = fd;
+	bc_vec_init(&vm->buffer, sizeof(uchar), BC_DTOR_NONE);
+	bc_vec_init(&vm->file_buf, sizeof(uchar), BC_DTOR_NONE);
 
 	BC_SETJMP_LOCKED(vm, err);
 
 	BC_SIG_UNLOCK;
 
-	// Process it.
-	bc_vm_process(data, BC_MODE_FILE);
+	// Process it, cleaning up after every piece.
+	while (bc_vm_readFile(true))
+	{
+		bc_vm_process(vm->buffer.v, BC_MODE_STREAM);
+
+		BC_SIG_LOCK;
+		bc_vm_clean();
+		BC_SIG_UNLOCK;
+	}
 
 #if BC_ENABLED
 	// Make sure to end any open if statements.
@@ -1130,7 +1372,9 @@ err:
 	BC_SIG_MAYLOCK;
 
 	// Cleanup.
-	free(data);
+	close(fd);
+	bc_vec_free(&vm->file_buf);
+	bc_vec_free(&vm->buffer);
 	bc_vm_clean();
 
 	// bc_program_reset(), called by bc_vm_clean(), resets the status.
@@ -1151,11 +1395,19 @@ bc_vm_readLine(bool clear)
 	// Clear the buffer if desired.
 	if (clear) bc_vec_empty(&vm->buffer);
 
+	if (vm->eof) return false;
+
+	// When stdin is read in blocks, just get the next block of whole lines.
+	if (vm->stdin_blocks)
+	{
+		good = bc_vm_readFile(false);
+		vm->eof = !good;
+		return good;
+	}
+
 	// Empty the line buffer.
 	bc_vec_empty(&vm->line_buf);
 
-	if (vm->eof) return false;
-
 	do
 	{
 		// bc_read_line() must always return either BC_STATUS_SUCCESS or
@@ -1174,8 +1426,69 @@ bc_vm_readLine(bool clear)
 	return good;
 }
 
+BcStatus
+bc_vm_readNextLine(BcVec* vec)
+{
+	BcLex* l = &vm->prs.l;
+	size_t start, end;
+	const char* nl;
+
+	BC_SIG_ASSERT_NOT_LOCKED;
+
+	assert(vm->stdin_blocks && l->buf == vm->buffer.v);
+
+	start = l->i;
+
+	// If the lexer has not gone past the end of the line it is on, the next
+	// line starts after the end of that one.
+	if (!start || l->buf[start - 1] != '\n')
+	{
+		nl = memchr(l->buf + start, '\n', l->len - start);
+		start = nl != NULL ? (size_t) (nl - l->buf) + 1 : l->len;
+	}
+
+	// Get more of stdin until there is a whole line or there is no more.
+	while ((nl = memchr(vm->buffer.v + start, '\n',
+	                    vm->buffer.len - 1 - start)) == NULL &&
+	       bc_vm_readFile(false))
+	{
+		BC_SIG_LOCK;
+
+		// The lexer needs to know that the buffer might have moved.
+		l->buf = vm->buffer.v;
+		l->len = vm->buffer.len - 1;
+
+		BC_SIG_UNLOCK;
+	}
+
+	end = nl != NULL ? (size_t) (nl - vm->buffer.v) + 1 : vm->buffer.len - 1;
+
+	BC_SIG_LOCK;
+
+	bc_vec_string(vec, end - start, vm->buffer.v + start);
+
+	// Take the line out of the lexer's text. If it is where the lexer is, the
+	// lexer can just skip it.
+	if (start == l->i) l->i = end;
+	else
+	{
+		bc_vec_npopAt(&vm->buffer, end - start, start);
+		l->buf = vm->buffer.v;
+		l->len = vm->buffer.len - 1;
+	}
+
+	BC_SIG_UNLOCK;
+
+	// Like bc_read_chars(), a line without a newline means EOF.
+	return nl == NULL ? BC_STATUS_EOF : BC_STATUS_SUCCESS;
+}
+
 /**
- * Processes text from stdin.
+ * Processes text from stdin. If stdin is not interactive, it is read in big
+ * blocks of whole lines instead of a line at a time because that is much faster
+ * for piped input. The lexer still stops at the end of every line (see
+ * bc_lex_next()), so this does not change how stdin is processed, and cleanup
+ * only happens after each block.
  */
 static void
 bc_vm_stdin(void)
@@ -1203,6 +1516,19 @@ bc_vm_stdin(void)
 	BC_SIG_LOCK;
 	bc_vec_init(&vm->buffer, sizeof(uchar), BC_DTOR_NONE);
 	bc_vec_init(&vm->line_buf, sizeof(uchar), BC_DTOR_NONE);
+
+	vm->stdin_blocks = (!BC_I && !BC_TTYIN && !BC_PROMPT);
+
+	if (vm->stdin_blocks)
+	{
+		bc_vec_init(&vm->file_buf, sizeof(uchar), BC_DTOR_NONE);
+		vm->file_fd = STDIN_FILENO;
+
+		// read() in a file could have left some of stdin in the line buffer.
+		bc_vec_npush(&vm->file_buf, vm->buf_len, vm->buf);
+		vm->buf_len = 0;
+	}
+
 	BC_SETJMP_LOCKED(vm, err);
 	BC_SIG_UNLOCK;
 
@@ -1271,6 +1597,7 @@ err:
 	// debug mode because stdin is always the last thing read.
 	bc_vec_free(&vm->line_buf);
 	bc_vec_free(&vm->buffer);
+	if (vm->stdin_blocks) bc_vec_free(&vm->file_buf);
 #endif // BC_DEBUG
 
 	BC_LONGJMP_CONT(vm);
@@ -1360,12 +1687,7 @@ err:
 
 #if BC_ENABLED
 
-/**
- * Loads a math library.
- * @param name  The name of the library.
- * @param text  The text of the source code.
- */
-static void
+void
 bc_vm_load(const char* name, const char* text)
 {
 	bc_lex_file(&vm->prs.l, name);
@@ -1383,90 +1705,1037 @@ bc_vm_load(const char* name, const char* text)
 
 #endif // BC_ENABLED
 
+#if BC_ENABLE_IMAGES
+
 /**
- * Loads the default error messages.
+ * Loads a program image saved with --save-image into the program, which must
+ * not have anything in it yet. If the image has the math library, this sets
+ * the flag for it so that the library is not loaded again.
+ * @param path   The path of the image file.
+ * @param scale  A pointer to return the value of scale in the image.
+ * @param ibase  A pointer to return the value of ibase in the image.
+ * @param obase  A pointer to return the value of obase in the image.
  */
 static void
-bc_vm_defaultMsgs(void)
+bc_vm_loadImage(const char* path, BcBigDig* scale, BcBigDig* ibase,
+                BcBigDig* obase)
 {
-	size_t i;
+	const BcImageHeader* h;
+	size_t len;
+	int fd;
+	bool lib;
 
-	// Load the error categories.
-	for (i = 0; i < BC_ERR_IDX_NELEMS + BC_ENABLED; ++i)
+	BC_SIG_ASSERT_LOCKED;
+
+	fd = bc_read_openFile(path, &len);
+
+	if (BC_ERR(len < sizeof(BcImageHeader)))
 	{
-		vm->err_ids[i] = bc_errs[i];
+		close(fd);
+		bc_verr(BC_ERR_FATAL_ARG, path);
 	}
 
-	// Load the error messages.
-	for (i = 0; i < BC_ERR_NELEMS; ++i)
+	// The image is used in place, so loading only touches the parts that are
+	// needed, and the functions are not copied until they are called.
+	vm->image = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	close(fd);
+
+	if (BC_ERR(vm->image == MAP_FAILED))
 	{
-		vm->err_msgs[i] = bc_err_msgs[i];
+		vm->image = NULL;
+		bc_verr(BC_ERR_FATAL_IO_ERR, path);
+	}
+
+	vm->image_len = len;
+
+	h = (const BcImageHeader*) vm->image;
+
+	// Images from other builds and other versions are rejected, as are images
+	// that were cut short.
+	if (BC_ERR(memcmp(h->magic, BC_IMAGE_MAGIC, sizeof(h->magic)) ||
+	           h->version != BC_IMAGE_VERSION || h->build != BC_IMAGE_BUILD ||
+	           strncmp(h->bc_version, BC_VERSION, sizeof(h->bc_version)) ||
+	           h->len != len))
+	{
+		bc_verr(BC_ERR_FATAL_ARG, path);
 	}
+
+	lib = ((h->flags & BC_IMAGE_FLAG_LIB) != 0);
+
+	// The bytecode in the image uses the indices that it had when it was saved,
+	// so the math library cannot go in front of it.
+	if (BC_ERR(BC_L && !lib)) bc_verr(BC_ERR_FATAL_ARG, path);
+
+	if (BC_ERR(!bc_program_readImage(&vm->prog, vm->image)))
+	{
+		bc_verr(BC_ERR_FATAL_ARG, path);
+	}
+
+	if (lib) vm->flags |= BC_FLAG_L;
+
+	*scale = (BcBigDig) h->globals[BC_PROG_GLOBALS_SCALE];
+	*ibase = (BcBigDig) h->globals[BC_PROG_GLOBALS_IBASE];
+	*obase = (BcBigDig) h->globals[BC_PROG_GLOBALS_OBASE];
 }
 
 /**
- * Loads the error messages for the locale. If NLS is disabled, this just loads
- * the default messages.
+ * Saves the program to an image file for --load-image.
+ * @param path  The path of the image file.
  */
 static void
-bc_vm_gettext(void)
+bc_vm_saveImage(const char* path)
 {
-#if BC_ENABLE_NLS
-	uchar id = 0;
-	int set, msg = 1;
-	size_t i;
+	BcVec buf;
+	char* data;
+	size_t len;
+	int fd;
 
-	// If no locale, load the defaults.
-	if (vm->locale == NULL)
-	{
-		vm->catalog = BC_VM_INVALID_CATALOG;
-		bc_vm_defaultMsgs();
-		return;
-	}
+	BC_SIG_ASSERT_LOCKED;
 
-	vm->catalog = catopen(BC_MAINEXEC, NL_CAT_LOCALE);
+	bc_vec_init(&buf, sizeof(char), BC_DTOR_NONE);
 
-	// If no catalog, load the defaults.
-	if (vm->catalog == BC_VM_INVALID_CATALOG)
-	{
-		bc_vm_defaultMsgs();
-		return;
-	}
+	bc_program_saveImage(&vm->prog, &buf, BC_L ? BC_IMAGE_FLAG_LIB : 0);
 
-	// Load the error categories.
-	for (set = 1; msg <= BC_ERR_IDX_NELEMS + BC_ENABLED; ++msg)
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (BC_ERR(fd < 0))
 	{
-		vm->err_ids[msg - 1] = catgets(vm->catalog, set, msg, bc_errs[msg - 1]);
+		bc_vec_free(&buf);
+		bc_verr(BC_ERR_FATAL_FILE_ERR, path);
 	}
 
-	i = 0;
-	id = bc_err_ids[i];
+	data = buf.v;
+	len = buf.len;
 
-	// Load the error messages. In order to understand this loop, you must know
-	// the order of messages and categories in the enum and in the locale files.
-	for (set = id + 2, msg = 1; i < BC_ERR_NELEMS; ++i, ++msg)
+	while (len)
 	{
-		if (id != bc_err_ids[i])
+		ssize_t w = write(fd, data, len);
+
+		if (BC_ERR(w < 0))
 		{
-			msg = 1;
-			id = bc_err_ids[i];
-			set = id + 2;
+			if (errno == EINTR) continue;
+
+			close(fd);
+			bc_vec_free(&buf);
+			bc_verr(BC_ERR_FATAL_IO_ERR, path);
 		}
 
-		vm->err_msgs[i] = catgets(vm->catalog, set, msg, bc_err_msgs[i]);
+		data += w;
+		len -= (size_t) w;
 	}
-#else // BC_ENABLE_NLS
-	bc_vm_defaultMsgs();
-#endif // BC_ENABLE_NLS
+
+	bc_vec_free(&buf);
+
+	if (BC_ERR(close(fd) < 0)) bc_verr(BC_ERR_FATAL_IO_ERR, path);
 }
 
-/**
- * Starts execution. Really, this is a function of historical accident; it could
- * probably be combined with bc_vm_boot(), but I don't care enough. Really, this
- * function starts when execution of bc or dc source code starts.
- */
-static void
-bc_vm_exec(void)
+#endif // BC_ENABLE_IMAGES
+
+#if BC_ENABLE_SERVER
+
+/// The files that the client sends to the server for a request: stdin, stdout,
+/// and stderr, in that order.
+static const int bc_vm_req_fds[] = { STDIN_FILENO, STDOUT_FILENO,
+	                                 STDERR_FILENO };
+
+/// The number of files in a request.
+#define BC_VM_REQ_NFDS (sizeof(bc_vm_req_fds) / sizeof(int))
+
+/// A buffer for the control message that carries the files of a request. It is
+/// a union to align it properly.
+typedef union BcVmReqCtrl
+{
+	/// The buffer.
+	char buf[CMSG_SPACE(sizeof(bc_vm_req_fds))];
+
+	/// A header for alignment.
+	struct cmsghdr align;
+
+} BcVmReqCtrl;
+
+/**
+ * Sets up a message to send or receive the files of a request. The message has
+ * one byte of data because some systems do not pass control messages without
+ * data.
+ * @param msg   The message to set up.
+ * @param iov   The I/O vector for the byte of data.
+ * @param c     The byte of data.
+ * @param ctrl  The buffer for the control message.
+ */
+static void
+bc_vm_reqMsg(struct msghdr* msg, struct iovec* iov, char* c, BcVmReqCtrl* ctrl)
+{
+	// NOLINTNEXTLINE
+	memset(msg, 0, sizeof(struct msghdr));
+	// NOLINTNEXTLINE
+	memset(ctrl, 0, sizeof(BcVmReqCtrl));
+
+	iov->iov_base = c;
+	iov->iov_len = 1;
+
+	msg->msg_iov = iov;
+	msg->msg_iovlen = 1;
+	msg->msg_control = ctrl->buf;
+	msg->msg_controllen = sizeof(ctrl->buf);
+}
+
+/**
+ * Sends the files of a request on a socket.
+ * @param sock  The socket.
+ * @param fds   The files.
+ * @return      True if the files were sent, false otherwise.
+ */
+static bool
+bc_vm_sendReq(int sock, const int* fds)
+{
+	struct msghdr msg;
+	struct iovec iov;
+	struct cmsghdr* cmsg;
+	BcVmReqCtrl ctrl;
+	ssize_t r;
+	char c = 0;
+
+	bc_vm_reqMsg(&msg, &iov, &c, &ctrl);
+
+	cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(bc_vm_req_fds));
+
+	// NOLINTNEXTLINE
+	memcpy(CMSG_DATA(cmsg), fds, sizeof(bc_vm_req_fds));
+
+	// Signals are locked, so they interrupt this instead of jumping.
+	do
+	{
+		r = sendmsg(sock, &msg, 0);
+	}
+	while (r < 0 && errno == EINTR && !vm->sig);
+
+	return (r == 1);
+}
+
+/**
+ * Receives the files of a request from a socket.
+ * @param sock  The socket.
+ * @param fds   An array to return the files in.
+ * @return      True if exactly the files of a request came, false otherwise.
+ *              Any files that did come when this fails are closed on exit.
+ */
+static bool
+bc_vm_recvReq(int sock, int* fds)
+{
+	struct msghdr msg;
+	struct iovec iov;
+	struct cmsghdr* cmsg;
+	BcVmReqCtrl ctrl;
+	ssize_t r;
+	char c;
+
+	bc_vm_reqMsg(&msg, &iov, &c, &ctrl);
+
+	do
+	{
+		r = recvmsg(sock, &msg, 0);
+	}
+	while (r < 0 && errno == EINTR);
+
+	cmsg = r == 1 ? CMSG_FIRSTHDR(&msg) : NULL;
+
+	if (BC_ERR(cmsg == NULL || (msg.msg_flags & MSG_CTRUNC) ||
+	           cmsg->cmsg_level != SOL_SOCKET ||
+	           cmsg->cmsg_type != SCM_RIGHTS ||
+	           cmsg->cmsg_len != CMSG_LEN(sizeof(bc_vm_req_fds))))
+	{
+		return false;
+	}
+
+	// NOLINTNEXTLINE
+	memcpy(fds, CMSG_DATA(cmsg), sizeof(bc_vm_req_fds));
+
+	return true;
+}
+
+/**
+ * Sets up the address of a Unix domain socket.
+ * @param addr  The address to set up.
+ * @param path  The path of the socket.
+ */
+static void
+bc_vm_sockAddr(struct sockaddr_un* addr, const char* path)
+{
+	size_t len = strlen(path);
+
+	BC_SIG_ASSERT_LOCKED;
+
+	// The path, with its nul byte, has to fit in the address.
+	if (BC_ERR(len >= sizeof(addr->sun_path))) bc_verr(BC_ERR_FATAL_ARG, path);
+
+	// NOLINTNEXTLINE
+	memset(addr, 0, sizeof(struct sockaddr_un));
+
+	addr->sun_family = AF_UNIX;
+
+	// NOLINTNEXTLINE
+	memcpy(addr->sun_path, path, len + 1);
+}
+
+/**
+ * A signal handler for SIGCHLD that does nothing. It exists to interrupt
+ * pselect() in bc_vm_spare().
+ * @param sig  The signal.
+ */
+static void
+bc_vm_sigchld(int sig)
+{
+	BC_UNUSED(sig);
+}
+
+/**
+ * Runs a spare of the server, which takes the next connection. A spare is a
+ * pair of processes, both made before there is a connection, so that a request
+ * does not wait for fork(). The first takes the connection and passes the files
+ * of the client on to the second, which runs the request. Then the first waits
+ * for the second, so that it can send the exit status back to the client no
+ * matter how the request exits, even with exit() on a fatal error. If the
+ * client goes away first, the request is stopped with SIGTERM. This only
+ * returns in the process that runs the request, after it has put the files of
+ * the client in place of its own stdin, stdout, and stderr.
+ * @param fd      The socket of the server.
+ * @param notify  A pipe to tell the server that the spare took a connection.
+ * @param alive   A pipe that has an end of file when the server exits.
+ */
+static void
+bc_vm_spare(int fd, int notify, int alive)
+{
+	struct sigaction sa;
+	sigset_t chld, old;
+	int fds[BC_VM_REQ_NFDS];
+	int sv[2];
+	fd_set rfds;
+	pid_t pid;
+	ssize_t r;
+	size_t i;
+	int conn, status;
+	char c = 0;
+	uchar s;
+
+	BC_SIG_ASSERT_LOCKED;
+
+	if (BC_ERR(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0))
+	{
+		_exit(BC_STATUS_ERROR_FATAL);
+	}
+
+	// The server ignores SIGCHLD, and that would make waitpid() fail, so this
+	// process needs a handler instead. SIGCHLD is blocked except in pselect()
+	// to not miss it if the request is done before pselect() is called.
+	sigemptyset(&chld);
+	sigaddset(&chld, SIGCHLD);
+	sigprocmask(SIG_BLOCK, &chld, &old);
+
+	sigemptyset(&sa.sa_mask);
+	sa.sa_flags = 0;
+	sa.sa_handler = bc_vm_sigchld;
+	sigaction(SIGCHLD, &sa, NULL);
+
+	pid = fork();
+
+	if (BC_ERR(pid < 0)) _exit(BC_STATUS_ERROR_FATAL);
+
+	if (pid == 0)
+	{
+		signal(SIGCHLD, SIG_DFL);
+		sigprocmask(SIG_SETMASK, &old, NULL);
+
+		close(fd);
+		close(notify);
+		close(alive);
+		close(sv[0]);
+
+		// If the first process exits without a connection, this just gets an
+		// end of file and exits too.
+		if (BC_ERR(!bc_vm_recvReq(sv[1], fds))) _exit(BC_STATUS_ERROR_FATAL);
+
+		close(sv[1]);
+
+		for (i = 0; i < BC_VM_REQ_NFDS; ++i)
+		{
+			if (BC_ERR(dup2(fds[i], bc_vm_req_fds[i]) < 0))
+			{
+				_exit(BC_STATUS_ERROR_FATAL);
+			}
+		}
+
+		// The files from the client are in increasing order, so putting one in
+		// place never closes one that comes after it. But one of them can
+		// already be in place if the server was started without one of its
+		// own files.
+		for (i = 0; i < BC_VM_REQ_NFDS; ++i)
+		{
+			if (fds[i] > STDERR_FILENO) close(fds[i]);
+		}
+
+		return;
+	}
+
+	close(sv[1]);
+
+	// Wait for a connection, or for the server to exit.
+	do
+	{
+		FD_ZERO(&rfds);
+		FD_SET(fd, &rfds);
+		FD_SET(alive, &rfds);
+
+		if (select((fd > alive ? fd : alive) + 1, &rfds, NULL, NULL, NULL) < 0)
+		{
+			if (errno == EINTR && !vm->sig) continue;
+			_exit(BC_STATUS_ERROR_FATAL);
+		}
+
+		if (FD_ISSET(alive, &rfds)) _exit(BC_STATUS_SUCCESS);
+
+		conn = accept(fd, NULL, NULL);
+	}
+	while (conn < 0);
+
+	// Tell the server to make the next spare. If the server is gone, it does
+	// not matter.
+	r = write(notify, &c, 1);
+	BC_UNUSED(r);
+
+	close(fd);
+	close(notify);
+	close(alive);
+
+	// Anything but exactly the files of a request is a bad request, and the
+	// client just sees the connection close.
+	if (BC_ERR(!bc_vm_recvReq(conn, fds) || !bc_vm_sendReq(sv[0], fds)))
+	{
+		_exit(BC_STATUS_ERROR_FATAL);
+	}
+
+	close(sv[0]);
+
+	for (i = 0; i < BC_VM_REQ_NFDS; ++i)
+	{
+		close(fds[i]);
+	}
+
+	sigdelset(&old, SIGCHLD);
+
+	// Wait for the request to finish, or for the client to go away. The client
+	// sends nothing else, so anything to read on the connection, including the
+	// end of it, means that.
+	while (waitpid(pid, &status, WNOHANG) != pid)
+	{
+		FD_ZERO(&rfds);
+		FD_SET(conn, &rfds);
+
+		if (pselect(conn + 1, &rfds, NULL, NULL, NULL, &old) > 0)
+		{
+			kill(pid, SIGTERM);
+
+			while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+			{
+				continue;
+			}
+
+			_exit(BC_STATUS_SUCCESS);
+		}
+	}
+
+	s = (uchar) (WIFEXITED(status) ? WEXITSTATUS(status) :
+	                                 BC_STATUS_ERROR_FATAL);
+
+	_exit(write(conn, &s, 1) == 1 ? BC_STATUS_SUCCESS : BC_STATUS_ERROR_FATAL);
+}
+
+/**
+ * Runs the server. This listens on a Unix domain socket and runs every request
+ * in a child process, which starts with a copy of the program as it is when
+ * this is called, with the math library and any files and expressions already
+ * parsed and executed. That is what makes the requests cheap: they do not start
+ * a process, and they do not parse anything but the request itself. And
+ * because each request has its own copy of the program, nothing that it does
+ * can affect the next request. This only returns in the children that run the
+ * requests, which then read stdin like normal.
+ * @param path  The path of the socket.
+ */
+static void
+bc_vm_serve(const char* path)
+{
+	struct sockaddr_un addr;
+	int fd, notify[2], alive[2];
+	pid_t pid = -1;
+	ssize_t r;
+	char c;
+
+	BC_SIG_LOCK;
+
+	bc_vm_sockAddr(&addr, path);
+
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (BC_ERR(fd < 0)) bc_err(BC_ERR_FATAL_IO_ERR);
+
+	if (BC_ERR(bind(fd, (struct sockaddr*) &addr, sizeof(addr)) < 0))
+	{
+		close(fd);
+		bc_verr(BC_ERR_FATAL_FILE_ERR, path);
+	}
+
+	if (BC_ERR(listen(fd, SOMAXCONN) < 0 || pipe(alive) < 0))
+	{
+		close(fd);
+		unlink(path);
+		bc_err(BC_ERR_FATAL_IO_ERR);
+	}
+
+	notify[0] = -1;
+
+	// The server never reads stdin, so it is not interactive, and SIGINT
+	// stops it instead of resetting it.
+	vm->flags &= ~(BC_FLAG_I);
+
+	// The spares are reaped automatically when they are done.
+	signal(SIGCHLD, SIG_IGN);
+
+	// Make sure that the requests do not write anything that the server was
+	// going to write.
+	bc_file_flush(&vm->fout, bc_flush_save);
+
+	BC_SETJMP_LOCKED(vm, err);
+
+	// Keep one spare ready. Each spare gets its own pipe to tell the server
+	// that it took a connection, so that the server gets an end of file if the
+	// spare fails before that.
+	while (pid != 0)
+	{
+		if (notify[0] >= 0) close(notify[0]);
+
+		if (BC_ERR(pipe(notify) < 0)) bc_err(BC_ERR_FATAL_IO_ERR);
+
+		pid = fork();
+
+		if (BC_ERR(pid < 0)) bc_err(BC_ERR_FATAL_IO_ERR);
+
+		if (pid == 0)
+		{
+			close(notify[0]);
+			close(alive[1]);
+
+			bc_vm_spare(fd, notify[1], alive[0]);
+
+			// Only the request gets here.
+			fd = -1;
+		}
+		else
+		{
+			close(notify[1]);
+
+			BC_SIG_UNLOCK;
+
+			do
+			{
+				r = read(notify[0], &c, 1);
+			}
+			while (r < 0 && errno == EINTR);
+
+			if (BC_ERR(r != 1)) bc_err(BC_ERR_FATAL_IO_ERR);
+
+			BC_SIG_LOCK;
+		}
+	}
+
+	// Requests are never interactive, and they never use the terminal.
+	vm->flags &= ~(BC_FLAG_TTYIN | BC_FLAG_TTY | BC_FLAG_P | BC_FLAG_R);
+
+err:
+
+	BC_SIG_MAYLOCK;
+
+	// Only the server has the socket. Closing the pipe tells the spare to exit.
+	if (fd >= 0)
+	{
+		close(fd);
+		unlink(path);
+		close(alive[1]);
+		if (notify[0] >= 0) close(notify[0]);
+	}
+
+	BC_LONGJMP_CONT(vm);
+}
+
+/**
+ * Runs the client. This sends stdin, stdout, and stderr to a server started
+ * with --server and waits for the server to run the request on them.
+ * @param path  The path of the socket of the server.
+ * @return      The exit status of the request.
+ */
+static BcStatus
+bc_vm_client(const char* path)
+{
+	struct sockaddr_un addr;
+	ssize_t r = 0;
+	int fd;
+	uchar s;
+
+	BC_SIG_ASSERT_LOCKED;
+
+	// The server runs the request with its own files and expressions, and it
+	// only reads stdin, so the client cannot have any of its own.
+	if (BC_ERR(vm->files.len || vm->exprs.len)) bc_verr(BC_ERR_FATAL_ARG, path);
+
+	bc_vm_sockAddr(&addr, path);
+
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (BC_ERR(fd < 0)) bc_err(BC_ERR_FATAL_IO_ERR);
+
+	if (BC_ERR(connect(fd, (struct sockaddr*) &addr, sizeof(addr)) < 0))
+	{
+		close(fd);
+		bc_verr(BC_ERR_FATAL_FILE_ERR, path);
+	}
+
+	// Signals are locked, so they interrupt these instead of jumping, and then
+	// the client just goes away, which stops the request.
+	if (BC_NO_ERR(bc_vm_sendReq(fd, bc_vm_req_fds)))
+	{
+		do
+		{
+			r = read(fd, &s, 1);
+		}
+		while (r < 0 && errno == EINTR && !vm->sig);
+	}
+
+	close(fd);
+
+	if (vm->sig) return (BcStatus) vm->status;
+
+	if (BC_ERR(r != 1)) bc_err(BC_ERR_FATAL_IO_ERR);
+
+	return (BcStatus) s;
+}
+
+#endif // BC_ENABLE_SERVER
+
+#if BC_ENABLE_JOBS
+
+/// A job for --jobs, which runs one -e, -f, or file in a child process.
+typedef struct BcVmJob
+{
+	/// The process that runs the job, or 0 once it has been waited for.
+	pid_t pid;
+
+	/// The read ends of the pipes of the stdout and stderr of the job, or -1
+	/// once they are closed.
+	int fds[2];
+
+	/// What the job wrote to stdout and stderr before its output could be
+	/// written.
+	BcVec bufs[2];
+
+	/// The exit status of the job.
+	uchar status;
+
+} BcVmJob;
+
+/**
+ * Writes the buffered output of a job now that it can be written, and frees
+ * the buffers.
+ * @param job  The job.
+ */
+static void
+bc_vm_jobWrite(BcVmJob* job)
+{
+	BC_SIG_ASSERT_LOCKED;
+
+	if (job->bufs[0].len)
+	{
+		bc_file_write(&vm->fout, bc_flush_none, job->bufs[0].v,
+		              job->bufs[0].len);
+	}
+
+	if (job->bufs[1].len)
+	{
+		bc_file_write(&vm->ferr, bc_flush_none, job->bufs[1].v,
+		              job->bufs[1].len);
+	}
+
+	bc_vec_free(&job->bufs[0]);
+	bc_vec_free(&job->bufs[1]);
+	bc_vec_clear(&job->bufs[0]);
+	bc_vec_clear(&job->bufs[1]);
+}
+
+/**
+ * Runs the expressions and files in jobs, with up to vm->jobs of them running
+ * at once. Each -e, each -f, and each file is one job, and each job runs in a
+ * child process that starts with a copy of the program as it is when this is
+ * called, so the jobs cannot see anything that the others do. The output of
+ * each job is written when all jobs before it are done, so the output is in the
+ * same order as it would be without --jobs, and the first job to fail stops
+ * bc with its exit status, like the first input to fail does without --jobs.
+ * @return  True if bc should not read stdin, which is true in the jobs and
+ *          when bc would exit after the expressions without --jobs.
+ */
+static bool
+bc_vm_jobs(void)
+{
+	BcVec jobs, pfds;
+	BcVmJob job;
+	BcVmJob* j;
+	struct pollfd* pfd;
+	size_t nexprs, n, i, k, head = 0, next = 0, running = 0, input = SIZE_MAX;
+	int fds[2][2], status, r;
+	pid_t pid;
+	ssize_t len;
+	bool exprs_exit;
+	char buf[BC_VM_JOBS_BUF_SIZE];
+
+	nexprs = vm->exprs.len ? vm->expr_ends.len : 0;
+	exprs_exit = (nexprs && !vm->no_exprs && vm->exit_exprs && BC_EXPR_EXIT);
+
+	// The files do not run if bc would have exited after the expressions.
+	n = nexprs + (exprs_exit ? 0 : vm->files.len);
+
+	if (!n) return false;
+
+	BC_SIG_LOCK;
+
+	bc_vec_init(&jobs, sizeof(BcVmJob), BC_DTOR_NONE);
+	bc_vec_init(&pfds, sizeof(struct pollfd), BC_DTOR_NONE);
+
+	BC_SETJMP_LOCKED(vm, err);
+
+	while (head < n)
+	{
+		// Start jobs until enough are running.
+		while (next < n && running < vm->jobs)
+		{
+			// Make sure that the job does not write anything that bc was going
+			// to write.
+			bc_file_flush(&vm->fout, bc_flush_none);
+			bc_file_flush(&vm->ferr, bc_flush_none);
+
+			if (BC_ERR(pipe(fds[0]) < 0)) bc_err(BC_ERR_FATAL_IO_ERR);
+
+			if (BC_ERR(pipe(fds[1]) < 0))
+			{
+				close(fds[0][0]);
+				close(fds[0][1]);
+				bc_err(BC_ERR_FATAL_IO_ERR);
+			}
+
+			job.pid = fork();
+
+			if (job.pid == 0)
+			{
+				// The job only needs its own pipes.
+				for (i = head; i < next; ++i)
+				{
+					j = bc_vec_item(&jobs, i);
+					if (j->fds[0] >= 0) close(j->fds[0]);
+					if (j->fds[1] >= 0) close(j->fds[1]);
+					j->fds[0] = j->fds[1] = -1;
+					j->pid = 0;
+				}
+
+				close(fds[0][0]);
+				close(fds[1][0]);
+
+				if (BC_ERR(dup2(fds[0][1], STDOUT_FILENO) < 0 ||
+				           dup2(fds[1][1], STDERR_FILENO) < 0))
+				{
+					_exit(BC_STATUS_ERROR_FATAL);
+				}
+
+				close(fds[0][1]);
+				close(fds[1][1]);
+
+				// Jobs are never interactive, and they never use the terminal.
+				vm->flags &= ~(BC_FLAG_I | BC_FLAG_TTYIN | BC_FLAG_TTY |
+				               BC_FLAG_P | BC_FLAG_R);
+
+				input = next;
+
+				goto err;
+			}
+
+			close(fds[0][1]);
+			close(fds[1][1]);
+
+			if (BC_ERR(job.pid < 0))
+			{
+				close(fds[0][0]);
+				close(fds[1][0]);
+				bc_err(BC_ERR_FATAL_IO_ERR);
+			}
+
+			job.fds[0] = fds[0][0];
+			job.fds[1] = fds[1][0];
+			job.status = BC_STATUS_SUCCESS;
+
+			// The first job writes its output right away.
+			if (next == head)
+			{
+				bc_vec_clear(&job.bufs[0]);
+				bc_vec_clear(&job.bufs[1]);
+			}
+			else
+			{
+				bc_vec_init(&job.bufs[0], sizeof(uchar), BC_DTOR_NONE);
+				bc_vec_init(&job.bufs[1], sizeof(uchar), BC_DTOR_NONE);
+			}
+
+			bc_vec_push(&jobs, &job);
+
+			next += 1;
+			running += 1;
+		}
+
+		bc_vec_popAll(&pfds);
+
+		for (i = head; i < next; ++i)
+		{
+			j = bc_vec_item(&jobs, i);
+
+			for (k = 0; k < 2; ++k)
+			{
+				if (j->fds[k] < 0) continue;
+
+				pfd = bc_vec_pushEmpty(&pfds);
+				pfd->fd = j->fds[k];
+				pfd->events = POLLIN;
+				pfd->revents = 0;
+			}
+		}
+
+		if (pfds.len)
+		{
+			BC_SIG_UNLOCK;
+
+			r = poll((struct pollfd*) pfds.v, (nfds_t) pfds.len, -1);
+
+			BC_SIG_LOCK;
+
+			if (BC_ERR(r < 0 && errno != EINTR)) bc_err(BC_ERR_FATAL_IO_ERR);
+		}
+
+		// Read what the jobs wrote. The pollfds are in the same order as the
+		// pipes that are still open.
+		for (i = head, pfd = (struct pollfd*) pfds.v; i < next; ++i)
+		{
+			j = bc_vec_item(&jobs, i);
+
+			for (k = 0; k < 2; ++k)
+			{
+				if (j->fds[k] < 0) continue;
+
+				if (pfd->revents)
+				{
+					len = read(j->fds[k], buf, sizeof(buf));
+
+					if (len > 0)
+					{
+						if (i == head)
+						{
+							bc_file_write(k ? &vm->ferr : &vm->fout,
+							              bc_flush_none, buf, (size_t) len);
+						}
+						else bc_vec_npush(&j->bufs[k], (size_t) len, buf);
+					}
+					else if (len == 0 || errno != EINTR)
+					{
+						close(j->fds[k]);
+						j->fds[k] = -1;
+					}
+				}
+
+				pfd += 1;
+			}
+
+			// Wait for the job once it is done writing.
+			if (j->pid > 0 && j->fds[0] < 0 && j->fds[1] < 0)
+			{
+				do
+				{
+					pid = waitpid(j->pid, &status, 0);
+				}
+				while (pid < 0 && errno == EINTR);
+
+				j->status = (uchar) (pid > 0 && WIFEXITED(status) ?
+				                         WEXITSTATUS(status) :
+				                         BC_STATUS_ERROR_FATAL);
+				j->pid = 0;
+				running -= 1;
+			}
+		}
+
+		// Finish the jobs at the head that are done, in order, and write the
+		// output of the next one that was waiting.
+		while (head < next)
+		{
+			j = bc_vec_item(&jobs, head);
+
+			if (j->pid > 0) break;
+
+			bc_file_flush(&vm->fout, bc_flush_none);
+			bc_file_flush(&vm->ferr, bc_flush_none);
+
+			if (BC_ERR(j->status != BC_STATUS_SUCCESS))
+			{
+				vm->status = (sig_atomic_t) j->status;
+				goto err;
+			}
+
+			head += 1;
+
+			if (head < next) bc_vm_jobWrite(bc_vec_item(&jobs, head));
+		}
+	}
+
+err:
+
+	BC_SIG_MAYLOCK;
+
+	// Stop the jobs that are still running. Their output is never written. The
+	// jobs before the head are already done, and their buffers are freed.
+	for (i = 0; i < jobs.len; ++i)
+	{
+		j = bc_vec_item(&jobs, i);
+
+		if (j->fds[0] >= 0) close(j->fds[0]);
+		if (j->fds[1] >= 0) close(j->fds[1]);
+
+		if (j->pid > 0)
+		{
+			kill(j->pid, SIGTERM);
+			waitpid(j->pid, &status, 0);
+		}
+
+		bc_vec_free(&j->bufs[0]);
+		bc_vec_free(&j->bufs[1]);
+	}
+
+	bc_vec_free(&jobs);
+	bc_vec_free(&pfds);
+
+	BC_LONGJMP_CONT(vm);
+
+	if (input == SIZE_MAX) return exprs_exit;
+
+	// Only the jobs get here, and they run their own input.
+	if (input < nexprs)
+	{
+		size_t start = input ? *((size_t*) bc_vec_item(&vm->expr_ends,
+		                                                input - 1)) :
+		                       0;
+		size_t end = *((size_t*) bc_vec_item(&vm->expr_ends, input));
+
+		// NOLINTNEXTLINE
+		memmove(vm->exprs.v, vm->exprs.v + start, end - start);
+		vm->exprs.v[end - start] = '\0';
+		vm->exprs.len = end - start + 1;
+
+		bc_vm_exprs();
+	}
+	else
+	{
+		char* path = *((char**) bc_vec_item(&vm->files, input - nexprs));
+		if (strcmp(path, "")) bc_vm_file(path);
+	}
+
+	return true;
+}
+
+#endif // BC_ENABLE_JOBS
+
+/**
+ * Loads the default error messages.
+ */
+static void
+bc_vm_defaultMsgs(void)
+{
+	size_t i;
+
+	// Load the error categories.
+	for (i = 0; i < BC_ERR_IDX_NELEMS + BC_ENABLED; ++i)
+	{
+		vm->err_ids[i] = bc_errs[i];
+	}
+
+	// Load the error messages.
+	for (i = 0; i < BC_ERR_NELEMS; ++i)
+	{
+		vm->err_msgs[i] = bc_err_msgs[i];
+	}
+}
+
+/**
+ * Loads the error messages for the locale. If NLS is disabled, this just loads
+ * the default messages.
+ */
+static void
+bc_vm_gettext(void)
+{
+#if BC_ENABLE_NLS
+	uchar id = 0;
+	int set, msg = 1;
+	size_t i;
+
+	// If no locale, load the defaults.
+	if (vm->locale == NULL)
+	{
+		vm->catalog = BC_VM_INVALID_CATALOG;
+		bc_vm_defaultMsgs();
+		return;
+	}
+
+	vm->catalog = catopen(BC_MAINEXEC, NL_CAT_LOCALE);
+
+	// If no catalog, load the defaults.
+	if (vm->catalog == BC_VM_INVALID_CATALOG)
+	{
+		bc_vm_defaultMsgs();
+		return;
+	}
+
+	// Load the error categories.
+	for (set = 1; msg <= BC_ERR_IDX_NELEMS + BC_ENABLED; ++msg)
+	{
+		vm->err_ids[msg - 1] = catgets(vm->catalog, set, msg, bc_errs[msg - 1]);
+	}
+
+	i = 0;
+	id = bc_err_ids[i];
+
+	// Load the error messages. In order to understand this loop, you must know
+	// the order of messages and categories in the enum and in the locale files.
+	for (set = id + 2, msg = 1; i < BC_ERR_NELEMS; ++i, ++msg)
+	{
+		if (id != bc_err_ids[i])
+		{
+			msg = 1;
+			id = bc_err_ids[i];
+			set = id + 2;
+		}
+
+		vm->err_msgs[i] = catgets(vm->catalog, set, msg, bc_err_msgs[i]);
+	}
+#else // BC_ENABLE_NLS
+	bc_vm_defaultMsgs();
+#endif // BC_ENABLE_NLS
+}
+
+/**
+ * Starts execution. Really, this is a function of historical accident; it could
+ * probably be combined with bc_vm_boot(), but I don't care enough. Really, this
+ * function starts when execution of bc or dc source code starts.
+ */
+static void
+bc_vm_exec(void)
 {
 	size_t i;
 #if DC_ENABLED
@@ -1474,9 +2743,24 @@ bc_vm_exec(void)
 #endif // DC_ENABLED
 
 #if BC_ENABLED
-	// Load the math libraries.
-	if (BC_IS_BC && (vm->flags & BC_FLAG_L))
+	// Load the math libraries, unless they came in a program image.
+	if (BC_IS_BC && (vm->flags & BC_FLAG_L) && !BC_VM_HAS_IMAGE)
 	{
+#if BC_ENABLE_LIB_IMAGE
+
+		// The libraries were parsed at build time, so just load the results.
+		BC_SIG_LOCK;
+
+		bc_program_loadImage(&vm->prog, &bc_lib_img);
+
+#if BC_ENABLE_EXTRA_MATH
+		if (!BC_IS_POSIX) bc_program_loadImage(&vm->prog, &bc_lib2_img);
+#endif // BC_ENABLE_EXTRA_MATH
+
+		BC_SIG_UNLOCK;
+
+#else // BC_ENABLE_LIB_IMAGE
+
 		// Can't allow redefinitions in the builtin library.
 		vm->no_redefine = true;
 
@@ -1489,23 +2773,36 @@ bc_vm_exec(void)
 		// Make sure to clear this.
 		vm->no_redefine = false;
 
+#endif // BC_ENABLE_LIB_IMAGE
+
 		// Execute to ensure that all is hunky dory. Without this, scale can be
 		// set improperly.
 		bc_program_exec(&vm->prog);
 	}
 #endif // BC_ENABLED
 
+#if BC_ENABLE_JOBS
+	// With --jobs, the expressions and files run in jobs instead. The server
+	// does not use them because it keeps what its files and expressions did.
+	if (BC_VM_HAS_JOBS && !BC_VM_IS_SERVER && bc_vm_jobs()) return;
+#endif // BC_ENABLE_JOBS
+
 	// If there are expressions to execute...
-	if (vm->exprs.len)
+	if (vm->exprs.len && (!BC_VM_HAS_JOBS || BC_VM_IS_SERVER))
 	{
 		// Process the expressions.
 		bc_vm_exprs();
 
-		// Sometimes, executing expressions means we need to quit.
-		if (!vm->no_exprs && vm->exit_exprs && BC_EXPR_EXIT) return;
+		// Sometimes, executing expressions means we need to quit. The server
+		// does not because it has to serve requests.
+		if (!vm->no_exprs && vm->exit_exprs && BC_EXPR_EXIT &&
+		    !BC_VM_IS_SERVER)
+		{
+			return;
+		}
 	}
 
-	// Process files.
+	// Process files, unless they already ran in jobs.
 	for (i = 0; i < vm->files.len; ++i)
 	{
 		char* path = *((char**) bc_vec_item(&vm->files, i));
@@ -1513,9 +2810,14 @@ bc_vm_exec(void)
 #if DC_ENABLED
 		has_file = true;
 #endif // DC_ENABLED
-		bc_vm_file(path);
+		if (!BC_VM_HAS_JOBS || BC_VM_IS_SERVER) bc_vm_file(path);
 	}
 
+#if BC_ENABLE_SERVER
+	// The server only returns in the requests, which run stdin.
+	if (BC_VM_IS_SERVER) bc_vm_serve(vm->server);
+#endif // BC_ENABLE_SERVER
+
 #if BC_ENABLE_EXTRA_MATH
 	// These are needed for the pseudo-random number generator.
 	bc_unveil("/dev/urandom", "r");
@@ -1563,6 +2865,11 @@ bc_vm_boot(int argc, char* argv[])
 	BcBigDig env_ibase = BC_NUM_BIGDIG_MAX;
 	BcBigDig obase = BC_NUM_BIGDIG_MAX;
 	BcBigDig env_obase = BC_NUM_BIGDIG_MAX;
+#if BC_ENABLE_IMAGES
+	BcBigDig img_scale = BC_NUM_BIGDIG_MAX;
+	BcBigDig img_ibase = BC_NUM_BIGDIG_MAX;
+	BcBigDig img_obase = BC_NUM_BIGDIG_MAX;
+#endif // BC_ENABLE_IMAGES
 
 	// We need to know which of stdin, stdout, and stderr are tty's.
 	ttyin = isatty(STDIN_FILENO);
@@ -1619,6 +2926,9 @@ bc_vm_boot(int argc, char* argv[])
 	// *not* allocated.
 	bc_vec_clear(&vm->files);
 	bc_vec_clear(&vm->exprs);
+#if BC_ENABLE_JOBS
+	bc_vec_clear(&vm->expr_ends);
+#endif // BC_ENABLE_JOBS
 
 #if !BC_ENABLE_LIBRARY
 
@@ -1674,6 +2984,20 @@ bc_vm_boot(int argc, char* argv[])
 	bc_vm_envArgs(env_args, &env_scale, &env_ibase, &env_obase);
 	bc_args(argc, argv, true, &scale, &ibase, &obase);
 
+#if BC_ENABLE_SERVER
+	// The client does nothing but send the request to the server.
+	if (vm->client != NULL) return bc_vm_atexit(bc_vm_client(vm->client));
+#endif // BC_ENABLE_SERVER
+
+#if BC_ENABLE_IMAGES
+	// The image has to be the first thing in the program because its bytecode
+	// uses the indices that it had when it was saved.
+	if (vm->load_image != NULL)
+	{
+		bc_vm_loadImage(vm->load_image, &img_scale, &img_ibase, &img_obase);
+	}
+#endif // BC_ENABLE_IMAGES
+
 	// This section is here because we don't want the math library to stomp on
 	// the user's given value for scale. And we don't want ibase affecting how
 	// the scale is interpreted. Also, it's sectioned off just for this comment.
@@ -1681,12 +3005,20 @@ bc_vm_boot(int argc, char* argv[])
 		BC_SIG_UNLOCK;
 
 		scale = scale == BC_NUM_BIGDIG_MAX ? env_scale : scale;
+		obase = obase == BC_NUM_BIGDIG_MAX ? env_obase : obase;
+		ibase = ibase == BC_NUM_BIGDIG_MAX ? env_ibase : ibase;
+#if BC_ENABLE_IMAGES
+		// The values in a program image are used when the options and the
+		// environment do not set them. An image with the math library has its
+		// scale, so the default below is only for the library alone.
+		scale = scale == BC_NUM_BIGDIG_MAX ? img_scale : scale;
+		obase = obase == BC_NUM_BIGDIG_MAX ? img_obase : obase;
+		ibase = ibase == BC_NUM_BIGDIG_MAX ? img_ibase : ibase;
+#endif // BC_ENABLE_IMAGES
 #if BC_ENABLED
 		// Assign the library value only if it is used and no value was set.
 		scale = scale == BC_NUM_BIGDIG_MAX && BC_L ? 20 : scale;
 #endif // BC_ENABLED
-		obase = obase == BC_NUM_BIGDIG_MAX ? env_obase : obase;
-		ibase = ibase == BC_NUM_BIGDIG_MAX ? env_ibase : ibase;
 
 		if (scale != BC_NUM_BIGDIG_MAX)
 		{
@@ -1738,6 +3070,12 @@ bc_vm_boot(int argc, char* argv[])
 
 	BC_SIG_LOCK;
 
+#if BC_ENABLE_IMAGES
+	// Quitting and fatal errors do not get here, so only a program that
+	// reached the end of its input is saved.
+	if (vm->save_image != NULL) bc_vm_saveImage(vm->save_image);
+#endif // BC_ENABLE_IMAGES
+
 	// Exit.
 	return bc_vm_atexit((BcStatus) vm->status);
 }
@@ -36,6 +36,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <time.h>
 
 #include <bcl.h>
 
@@ -53,11 +54,23 @@ int
 main(void)
 {
 	BclError e;
-	BclContext ctxt;
+	BclContext ctxt, actxt;
 	size_t scale;
 	BclNumber n, n2, n3, n4, n5, n6, n7;
+	BclNumber xs[3], ys[3], ds[3];
+	size_t i;
 	char* res;
 	BclBigDig b = 0;
+	BclExpr expr;
+	BclJob jobs[4];
+	BclNumber args[4];
+	char buf[64];
+	size_t len;
+	unsigned char bytes[32];
+	double dbl;
+	clock_t start;
+	const char* strs[] = { "0", "-7", ".5", "-0.0012300", "1000000000",
+		                   "123456789012.000000001" };
 
 	e = bcl_start();
 	err(e);
@@ -173,6 +186,359 @@ main(void)
 	if (strcmp(res, ".00000152374405414")) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
 	free(res);
 
+	// Ensure that the in-place functions work, both when the destination is a
+	// different number and when it is also an operand.
+	n3 = bcl_parse("-25452.9108273");
+	err(bcl_err(n3));
+	n5 = bcl_num_create();
+	err(bcl_err(n5));
+	n6 = bcl_num_create();
+	err(bcl_err(n6));
+
+	e = bcl_add_into(n5, n3, n4);
+	err(e);
+
+	res = bcl_string_keep(n5);
+	if (strcmp(res, "8937433449.3782074")) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	free(res);
+
+	e = bcl_add_into(n5, n5, n3);
+	err(e);
+	e = bcl_add_into(n5, n3, n5);
+	err(e);
+
+	res = bcl_string_keep(n5);
+	if (strcmp(res, "8937382543.5565528")) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	free(res);
+
+	e = bcl_div_into(n6, n5, n3);
+	err(e);
+
+	res = bcl_string(n6);
+	if (strcmp(res, "-351134.0060159482")) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	free(res);
+
+	e = bcl_mul_into(n5, n5, n5);
+	err(e);
+
+	res = bcl_string_keep(n5);
+	if (strcmp(res, "79876806729869397407.2652918191"))
+	{
+		err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	}
+	free(res);
+
+	// Errors must be returned.
+	n6 = bcl_num_create();
+	err(bcl_err(n6));
+
+	e = bcl_div_into(n5, n5, n6);
+	if (e != BCL_ERROR_MATH_DIVIDE_BY_ZERO) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+	bcl_num_free(n6);
+	bcl_num_free(n5);
+	bcl_num_free(n3);
+
+	// Ensure that the batch functions work, including when the destinations are
+	// also operands.
+	xs[0] = bcl_parse("1.5");
+	xs[1] = bcl_parse("2.25");
+	xs[2] = bcl_parse("-3");
+	ys[0] = bcl_parse("2");
+	ys[1] = bcl_parse("4");
+	ys[2] = bcl_parse(".5");
+
+	for (i = 0; i < 3; ++i)
+	{
+		err(bcl_err(xs[i]));
+		err(bcl_err(ys[i]));
+		ds[i] = bcl_num_create();
+		err(bcl_err(ds[i]));
+	}
+
+	e = bcl_add_n(ds, xs, ys, 3);
+	err(e);
+	e = bcl_add_n(ds, ds, xs, 3);
+	err(e);
+
+	res = bcl_string_keep(ds[2]);
+	if (strcmp(res, "-5.5")) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	free(res);
+
+	n5 = bcl_parse("-1.25");
+	err(bcl_err(n5));
+
+	e = bcl_mul_scalar_n(ds, ds, n5, 3);
+	err(e);
+
+	res = bcl_string_keep(ds[1]);
+	if (strcmp(res, "-10.6250")) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	free(res);
+
+	n6 = bcl_sum(xs, 3);
+	err(bcl_err(n6));
+
+	res = bcl_string(n6);
+	if (strcmp(res, ".75")) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	free(res);
+
+	n6 = bcl_dot(xs, ys, 3);
+	err(bcl_err(n6));
+
+	res = bcl_string(n6);
+	if (strcmp(res, "10.50")) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	free(res);
+
+	// Errors in any element must be returned.
+	bcl_num_free(ys[2]);
+	ys[2] = bcl_parse("x");
+	if (bcl_err(ys[2]) != BCL_ERROR_PARSE_INVALID_STR)
+	{
+		err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	}
+
+	e = bcl_add_n(ds, xs, ys, 3);
+	if (e != BCL_ERROR_PARSE_INVALID_STR) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+	n6 = bcl_dot(xs, ys, 3);
+	if (bcl_err(n6) != BCL_ERROR_PARSE_INVALID_STR)
+	{
+		err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	}
+
+	for (i = 0; i < 3; ++i)
+	{
+		bcl_num_free(xs[i]);
+		bcl_num_free(ds[i]);
+	}
+
+	bcl_num_free(ys[0]);
+	bcl_num_free(ys[1]);
+	bcl_num_free(n5);
+
+	// Ensure that compiled expressions work, and that they can be evaluated
+	// more than once, including into one of their arguments.
+	expr = bcl_expr_compile("(a*b + c) / d ^ 2 - -a");
+	if (expr == NULL) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	if (bcl_expr_nargs(expr) != 4) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+	args[0] = bcl_parse("3");
+	args[1] = bcl_parse("4.5");
+	args[2] = bcl_parse("-1");
+	args[3] = bcl_parse("2");
+
+	for (i = 0; i < 4; ++i)
+	{
+		err(bcl_err(args[i]));
+	}
+
+	n6 = bcl_expr_eval(expr, args);
+	err(bcl_err(n6));
+
+	res = bcl_string(n6);
+	if (strcmp(res, "6.1250000000")) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	free(res);
+
+	e = bcl_expr_eval_into(args[0], expr, args);
+	err(e);
+
+	res = bcl_string_keep(args[0]);
+	if (strcmp(res, "6.1250000000")) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	free(res);
+
+	// Math errors must be returned.
+	bcl_zero(args[3]);
+
+	e = bcl_expr_eval_into(args[1], expr, args);
+	if (e != BCL_ERROR_MATH_DIVIDE_BY_ZERO) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+	bcl_expr_free(expr);
+
+	for (i = 0; i < 4; ++i)
+	{
+		bcl_num_free(args[i]);
+	}
+
+	// Invalid expressions must not compile.
+	if (bcl_expr_compile("(a * 2") != NULL) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	if (bcl_expr_compile("a b") != NULL) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	if (bcl_expr_compile("") != NULL) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+	// Ensure that parsing with a length does not look past the length.
+	n6 = bcl_parse_n("12.5xyz", 4);
+	err(bcl_err(n6));
+
+	n7 = bcl_parse_n("12.5xyz", 5);
+	if (bcl_err(n7) != BCL_ERROR_PARSE_INVALID_STR)
+	{
+		err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	}
+
+	// Ensure that writing into a buffer matches bcl_string(), in decimal and
+	// in another base, and that the length is exact.
+	for (i = 0; i < sizeof(strs) / sizeof(strs[0]); ++i)
+	{
+		n7 = bcl_parse(strs[i]);
+		err(bcl_err(n7));
+
+		for (scale = 10; scale <= 16; scale += 6)
+		{
+			bcl_ctxt_setObase(ctxt, scale);
+
+			res = bcl_string_keep(n7);
+			if (res == NULL) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+			len = bcl_string_len(n7);
+			if (len != strlen(res)) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+			len = 0;
+			e = bcl_string_into(n7, buf, sizeof(buf), &len);
+			err(e);
+
+			if (len != strlen(res) || strcmp(res, buf))
+			{
+				err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+			}
+
+			free(res);
+		}
+
+		bcl_num_free(n7);
+	}
+
+	bcl_ctxt_setObase(ctxt, 10);
+
+	// A buffer that is too small must be reported, along with the size.
+	e = bcl_string_into(n6, buf, 4, &len);
+	if (e != BCL_ERROR_MATH_OVERFLOW || len != 4 || buf[0])
+	{
+		err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	}
+
+	e = bcl_string_into(n6, buf, 5, NULL);
+	err(e);
+
+	if (strcmp(buf, "12.5")) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+	bcl_num_free(n6);
+
+	// Ensure that importing and exporting bytes works, both ways around and
+	// with negative numbers.
+	memset(bytes, 0xff, sizeof(bytes));
+
+	n6 = bcl_import_bytes(bytes, sizeof(bytes), true, false);
+	err(bcl_err(n6));
+
+	res = bcl_string(n6);
+	if (strcmp(res, "115792089237316195423570985008687907853269984665640564039"
+	                "457584007913129639935"))
+	{
+		err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	}
+	free(res);
+
+	n6 = bcl_import_bytes(bytes, sizeof(bytes), false, true);
+	err(bcl_err(n6));
+
+	res = bcl_string_keep(n6);
+	if (strcmp(res, "-1")) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	free(res);
+
+	n7 = bcl_parse("-4660");
+	err(bcl_err(n7));
+
+	e = bcl_export_bytes_keep(n7, bytes, 3, false, true);
+	err(e);
+
+	if (bytes[0] != 0xcc || bytes[1] != 0xed || bytes[2] != 0xff)
+	{
+		err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	}
+
+	e = bcl_export_bytes_keep(n7, bytes, 3, true, false);
+	if (e != BCL_ERROR_MATH_NEGATIVE) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+	e = bcl_export_bytes(n7, bytes, 1, true, true);
+	if (e != BCL_ERROR_MATH_OVERFLOW) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+	// A negative number needs at least one byte for its sign.
+	e = bcl_export_bytes_keep(n6, bytes, 0, true, true);
+	if (e != BCL_ERROR_MATH_OVERFLOW) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+	e = bcl_export_bytes(bcl_parse("0"), bytes, 0, true, true);
+	err(e);
+
+	e = bcl_export_bytes(n6, bytes, 1, true, true);
+	err(e);
+
+	if (bytes[0] != 0xff) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+	// Ensure that doubles convert exactly, up to the scale.
+	bcl_ctxt_setScale(ctxt, 10);
+
+	n6 = bcl_from_double(-2.5);
+	err(bcl_err(n6));
+
+	res = bcl_string_keep(n6);
+	if (strcmp(res, "-2.5")) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	free(res);
+
+	e = bcl_to_double(n6, &dbl);
+	err(e);
+
+	if (dbl != -2.5) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+	n6 = bcl_parse("0.1");
+	err(bcl_err(n6));
+
+	e = bcl_to_double(n6, &dbl);
+	err(e);
+
+	if (dbl != 0.1) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+	n6 = bcl_from_double(1.0 / 0.0);
+	if (bcl_err(n6) != BCL_ERROR_MATH_OVERFLOW) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+	// Ensure that the fixed-scale mode gives the same results, whether the
+	// numbers fit in 128 bits or not.
+	bcl_ctxt_setScale(ctxt, 8);
+	bcl_ctxt_setFixed(ctxt, true);
+
+	if (!bcl_ctxt_fixed(ctxt)) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+	n6 = bcl_parse("-1234567.12345678");
+	err(bcl_err(n6));
+
+	n7 = bcl_parse("1.03125");
+	err(bcl_err(n7));
+
+	res = bcl_string(bcl_mul_keep(n6, n7));
+	if (strcmp(res, "-1273147.34606480")) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	free(res);
+
+	res = bcl_string(bcl_div_keep(n6, n7));
+	if (strcmp(res, "-1197155.99850354")) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	free(res);
+
+	n7 = bcl_parse("123456789012345678901.5");
+	err(bcl_err(n7));
+
+	res = bcl_string(bcl_mul_keep(n7, n7));
+	if (strcmp(res, "15241578753238836750560890354538942246702.25"))
+	{
+		err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	}
+	free(res);
+
+	n7 = bcl_div(n6, bcl_num_create());
+	if (bcl_err(n7) != BCL_ERROR_MATH_DIVIDE_BY_ZERO)
+	{
+		err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	}
+
+	bcl_ctxt_setFixed(ctxt, false);
+	bcl_ctxt_setScale(ctxt, 10);
+
 	// Ensure that sqrt works. This is also a special case. The reason is
 	// because it is a one-argument function. Since all binary operators go
 	// through the same code (basically), we can test add and be done. However,
@@ -360,6 +726,157 @@ main(void)
 
 	bcl_gc();
 
+	// Ensure that a context with an arena works, even after it is reset, and
+	// that a compiled expression outlives the reset. The first chunk is tiny so
+	// that more are needed.
+	actxt = bcl_ctxt_create_arena(64);
+	if (actxt == NULL) err(BCL_ERROR_FATAL_ALLOC_ERR);
+
+	e = bcl_pushContext(actxt);
+	err(e);
+
+	expr = bcl_expr_compile("x * x + 1.5");
+	if (expr == NULL) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+	for (i = 0; i < 3; ++i)
+	{
+		n = bcl_parse("12345678901234567890");
+		err(bcl_err(n));
+
+		n2 = bcl_expr_eval(expr, &n);
+		err(bcl_err(n2));
+
+		res = bcl_string(bcl_mul(n2, bcl_dup(n)));
+		if (strcmp(res, "18816763723536577724902657494246770222172197432127"
+		                "48920835.0"))
+		{
+			err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+		}
+
+		free(res);
+
+		// A job's result has to end up in the arena too.
+		args[0] = n;
+		args[1] = n;
+		jobs[0] = bcl_submit(BCL_JOB_MUL, args);
+		if (jobs[0] == NULL) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+		res = bcl_string(bcl_job_wait(jobs[0]));
+		if (strcmp(res, "152415787532388367501905199875019052100"))
+		{
+			err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+		}
+
+		free(res);
+
+		bcl_ctxt_freeNums(actxt);
+	}
+
+	bcl_expr_free(expr);
+
+	bcl_popContext();
+
+	bcl_ctxt_free(actxt);
+
+	// Ensure that jobs work, that they do not consume their operands, and that
+	// errors come back through the result.
+	bcl_ctxt_setScale(ctxt, 20);
+
+	args[0] = bcl_parse("2");
+	err(bcl_err(args[0]));
+	args[1] = bcl_parse("200");
+	err(bcl_err(args[1]));
+	args[2] = bcl_parse("497");
+	err(bcl_err(args[2]));
+	args[3] = bcl_parse("-1");
+	err(bcl_err(args[3]));
+
+	jobs[0] = bcl_submit(BCL_JOB_POW, args);
+	jobs[1] = bcl_submit(BCL_JOB_SQRT, args);
+	jobs[2] = bcl_submit(BCL_JOB_MODEXP, args);
+	jobs[3] = bcl_submit(BCL_JOB_SQRT, args + 3);
+
+	for (i = 0; i < 4; ++i)
+	{
+		if (jobs[i] == NULL) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	}
+
+	while (!bcl_job_poll(jobs[3]))
+	{
+		continue;
+	}
+
+	n = bcl_job_wait(jobs[3]);
+	if (bcl_err(n) != BCL_ERROR_MATH_NEGATIVE) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+	res = bcl_string(bcl_job_wait(jobs[0]));
+	if (strcmp(res, "16069380442589902755419620923411626025222029937827928353013"
+	                "76"))
+	{
+		err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+	}
+
+	free(res);
+
+	res = bcl_string(bcl_job_wait(jobs[1]));
+	if (strcmp(res, "1.41421356237309504880")) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+	free(res);
+
+	res = bcl_string(bcl_job_wait(jobs[2]));
+	if (strcmp(res, "116")) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+	free(res);
+
+	for (i = 0; i < 4; ++i)
+	{
+		bcl_num_free(args[i]);
+	}
+
+	// Ensure that a call that goes past the deadline is interrupted, that the
+	// context still works afterward, and that a cancellation that comes when
+	// there is no call does not affect the next one.
+	bcl_ctxt_setDeadline(ctxt, 1000000);
+	if (bcl_ctxt_deadline(ctxt) != 1000000) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+	n = bcl_pow(bcl_parse("7"), bcl_parse("2000000"));
+	if (bcl_err(n) != BCL_ERROR_SIGNAL) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+	bcl_ctxt_setDeadline(ctxt, 0);
+
+	bcl_cancel(bcl_thread());
+
+	res = bcl_string(bcl_pow(bcl_parse("7"), bcl_parse("20")));
+	if (strcmp(res, "79792266297612001")) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+	free(res);
+
+	// Ensure that a deadline stops a call soon after it passes, even when the
+	// number is big enough that every step of the loops in printing and square
+	// roots takes a long time. The bound is ten times the deadline.
+	n = bcl_pow(bcl_parse("7"), bcl_parse("300000"));
+	err(bcl_err(n));
+
+	bcl_ctxt_setObase(ctxt, 7);
+	bcl_ctxt_setDeadline(ctxt, 5000000);
+
+	start = clock();
+
+	res = bcl_string_keep(n);
+	if (res != NULL) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+	if (clock() - start > CLOCKS_PER_SEC / 20) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+	start = clock();
+
+	n2 = bcl_sqrt(n);
+	if (bcl_err(n2) != BCL_ERROR_SIGNAL) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+	if (clock() - start > CLOCKS_PER_SEC / 20) err(BCL_ERROR_FATAL_UNKNOWN_ERR);
+
+	bcl_ctxt_setDeadline(ctxt, 0);
+	bcl_ctxt_setObase(ctxt, 10);
+
 	// We need to pop both contexts and free them.
 	bcl_popContext();
 
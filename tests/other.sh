@@ -245,6 +245,135 @@ if [ "$d" = "bc" ]; then
 		"$multiline_expr_out" "$d"
 
 	printf 'pass\n'
+	printf 'Running memoize test...'
+
+	memoize_out="$outputdir/bc_outputs/memoize_results.txt"
+
+	# The memoize script test has to give the same results with memoization.
+	printf 'halt\n' 2> /dev/null | "$exe" "$@" -lgqCM "$testdir/bc/scripts/memoize.bc" > "$memoize_out"
+	err="$?"
+
+	checktest "$d" "$err" "memoize" "$testdir/bc/scripts/memoize.txt" "$memoize_out"
+
+	printf 'halt\n' 2> /dev/null | "$exe" "$@" -lqC --memoize "$testdir/bc/scripts/memoize.bc" > "$memoize_out"
+	err="$?"
+
+	checktest "$d" "$err" "memoize" "$testdir/bc/scripts/memoize.txt" "$memoize_out"
+
+	printf 'pass\n'
+	printf 'Running image test...'
+
+	image="$outputdir/bc_outputs/image.img"
+	image_res="$outputdir/bc_outputs/image_results.txt"
+	image_out="$outputdir/bc_outputs/image_outputs.txt"
+	image_bad="$outputdir/bc_outputs/image_bad.img"
+
+	image_defs='define f(x) { auto y; y = x * 2; return y + k }
+define void g(a[]) { print a[3], "\n" }
+k = 5; a[3] = -7.25; s = "str"; scale = 7; obase = 16'
+	image_exprs='f(3); g(a[]); s; scale; obase = 10; s(1); define f(x) { return x }; f(3)'
+
+	# Everything in an image, including the math library, has to be just as it
+	# was when the image was saved.
+	printf '%s\n%s\n' "$image_defs" "$image_exprs" | "$exe" "$@" -lqC > "$image_res"
+
+	printf '%s\n' "$image_defs" | "$exe" "$@" -lqC --save-image "$image"
+	err="$?"
+
+	checktest_retcode "$d" "$err" "image"
+
+	printf '%s\n' "$image_exprs" | "$exe" "$@" -qC --load-image "$image" > "$image_out"
+	err="$?"
+
+	checktest "$d" "$err" "image" "$image_res" "$image_out"
+
+	printf '%s\n' "$image_exprs" | "$exe" "$@" -lqC --load-image="$image" > "$image_out"
+	err="$?"
+
+	checktest "$d" "$err" "image" "$image_res" "$image_out"
+
+	# The math library cannot be loaded in front of an image without it.
+	printf '%s\n' "$image_defs" | "$exe" "$@" -qC --save-image "$image"
+
+	"$exe" "$@" -lqC --load-image "$image" < /dev/null 2> "$image_out"
+	err="$?"
+
+	checkerrtest "$d" "$err" "image without the math library" "$image_out" "$d"
+
+	"$exe" "$@" -qC --load-image "$testdir/bc/scripts/memoize.bc" < /dev/null 2> "$image_out"
+	err="$?"
+
+	checkerrtest "$d" "$err" "invalid image" "$image_out" "$d"
+
+	# The bytecode uses the indices of the names, so an image that has a name
+	# twice is corrupted, even though its header is fine.
+	printf 'define qx() { return 1 }\ndefine qy() { return 2 }\n' | "$exe" "$@" -qC --save-image "$image"
+	LC_ALL=C tr 'y' 'x' < "$image" > "$image_bad"
+
+	"$exe" "$@" -qC --load-image "$image_bad" < /dev/null 2> "$image_out"
+	err="$?"
+
+	checkerrtest "$d" "$err" "corrupted image" "$image_out" "$d"
+
+	rm -f "$image" "$image_bad"
+
+	printf 'pass\n'
+
+	printf 'Running server test...'
+
+	sock="$outputdir/bc_outputs/server.sock"
+	server_lib="$outputdir/bc_outputs/server_lib.bc"
+	server_res="$outputdir/bc_outputs/server_results.txt"
+	server_out="$outputdir/bc_outputs/server_outputs.txt"
+
+	server_exprs='f(3); k = 1; define f(x) { return x }; f(3); s(1)'
+
+	printf 'define f(x) { return x * 2 + k }\nk = 5\n' > "$server_lib"
+
+	# Every request has to see just what a normal run sees, and nothing that
+	# the requests before it did.
+	printf '%s\n' "$server_exprs" | "$exe" "$@" -lqC "$server_lib" > "$server_res"
+
+	rm -f "$sock"
+
+	"$exe" "$@" -lqC --server="$sock" "$server_lib" < /dev/null &
+	server="$!"
+
+	while [ ! -S "$sock" ]; do
+		sleep 0.1 2> /dev/null || sleep 1
+	done
+
+	for i in 1 2; do
+
+		printf '%s\n' "$server_exprs" | "$exe" "$@" --client="$sock" > "$server_out"
+		err="$?"
+
+		checktest "$d" "$err" "server" "$server_res" "$server_out"
+
+	done
+
+	# The client exits with the status of the request.
+	printf '1 / 0\n' | "$exe" "$@" --client="$sock" 2> "$server_out"
+	err="$?"
+
+	checkerrtest "$d" "$err" "server error" "$server_out" "$d"
+
+	printf '1\n' | "$exe" "$@" --client="$sock" "$server_lib" 2> "$server_out"
+	err="$?"
+
+	checkerrtest "$d" "$err" "client with a file" "$server_out" "$d"
+
+	# The server removes its socket when it is stopped.
+	kill "$server"
+	wait "$server"
+
+	if [ -e "$sock" ]; then
+		err_exit "$d server did not remove its socket" 1
+	fi
+
+	rm -f "$server_lib"
+
+	printf 'pass\n'
 
 else
 
@@ -577,8 +706,116 @@ checkerrtest "$d" "$err" "binary stdin" "$out2" "$d"
 
 printf 'pass\n'
 
+printf 'Running %s stdin comment test...' "$d"
+
+# A comment can end stdin without a newline after it.
+if [ "$d" = "bc" ]; then
+	comment_in='2 + 2 # sum'
+else
+	comment_in='2 2 + p # sum'
+fi
+
+printf '4\n' > "$out1"
+
+printf '%s' "$comment_in" | "$exe" "$@" > "$out2"
+
+checktest "$d" "$?" "stdin comment" "$out1" "$out2"
+
+if [ "$d" = "bc" ]; then
+
+	printf 'x = 4 /* set */' | "$exe" "$@" > "$out2"
+
+	checktest "$d" "$?" "stdin block comment" /dev/null "$out2"
+
+	# A block comment longer than a piece of a streamed file must not make
+	# later line numbers wrong.
+	awk 'BEGIN {
+		for (i = 0; i < 30000; ++i) print "/*"
+		print "*/"
+		for (i = 0; i < 30000; ++i) print "x = 1"
+		print "1 + * 2"
+	}' > "$out1"
+
+	"$exe" "$@" "$out1" > /dev/null 2> "$out2"
+
+	grep ":60002$" "$out2" > /dev/null
+
+	checktest_retcode "$d" "$?" "long block comment line number"
+fi
+
+printf 'pass\n'
+
+printf 'Running %s jobs test...' "$d"
+
+unset BC_ENV_ARGS
+unset "$line_var"
+
+if [ "$d" = "bc" ]; then
+	jobs_opts="-lq"
+else
+	jobs_opts=""
+fi
+
+cat "$testdir/$d/add_results.txt" "$testdir/$d/divide_results.txt" \
+	"$testdir/$d/multiply_results.txt" "$testdir/$d/subtract_results.txt" \
+	> "$out1"
+
+# The output has to be in the order of the files, whichever job is done first.
+printf '%s\n' "$halt" 2> /dev/null | "$exe" "$@" $jobs_opts --jobs=3 \
+	"$testdir/$d/add.txt" "$testdir/$d/divide.txt" \
+	"$testdir/$d/multiply.txt" "$testdir/$d/subtract.txt" > "$out2"
+
+checktest "$d" "$?" "jobs" "$out1" "$out2"
+
+printf '%s\n' "$halt" 2> /dev/null | "$exe" "$@" $jobs_opts --jobs=2 \
+	"$testdir/$d/add.txt" "$bin" "$testdir/$d/multiply.txt" > /dev/null \
+	2> "$out2"
+err="$?"
+
+checkerrtest "$d" "$err" "jobs error" "$out2" "$d"
+
+"$exe" "$@" --jobs=0 -e "$halt" > /dev/null 2> "$out2"
+err="$?"
+
+checkerrtest "$d" "$err" "jobs zero" "$out2" "$d"
+
+printf 'pass\n'
+
 if [ "$d" = "bc" ]; then
 
+	printf 'Running %s parse ahead test...' "$d"
+
+	# bc parses statements ahead of running them, so these make sure that what
+	# comes before a redefinition or an error still runs first.
+	printf '1\n2\n3\n' > "$out1"
+
+	printf 'define f() { return 1; }\nf()\nx = 2\nx\ndefine f() { return 3; }\nf()\n' \
+		| "$exe" "$@" -q > "$out2"
+
+	checktest "$d" "$?" "parse ahead redefine" "$out1" "$out2"
+
+	printf '1\n2\n' > "$out1"
+
+	printf '1\n2\n3 +\n4\n' | "$exe" "$@" -q 2> "$out2" > "$out1.ahead"
+	err="$?"
+
+	checkerrtest "$d" "$err" "parse ahead error" "$out2" "$d"
+
+	checktest "$d" "0" "parse ahead error output" "$out1" "$out1.ahead"
+
+	rm -f "$out1.ahead"
+
+	# A function that calls read() takes the next line of stdin, so a statement
+	# that calls a function has to run before the next line is parsed.
+	printf '5\n' > "$out1"
+
+	printf 'define f() { return read(); }\nx = f()\n5\nx\n' \
+		| "$exe" "$@" -q > "$out2"
+
+	checktest "$d" "$?" "parse ahead read in function" "$out1" "$out2"
+
+	printf 'pass\n'
+
 	printf 'Running %s limits tests...' "$d"
 	printf 'limits\n' 2> /dev/null | "$exe" "$@" /dev/null > "$out2" 2>&1
 